@@ -0,0 +1,232 @@
+/* Compare list and hybrid bitmaps on the set operations of dataflow.
+   Copyright (C) 2016 Free Software Foundation, Inc.
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 3, or (at your option) any
+later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; see the file COPYING3.  If not see
+<http://www.gnu.org/licenses/>.  */
+
+/* The liveness problems of df and the register allocator keep one set
+   of registers per basic block and iterate
+
+     out = IOR of the in sets of the successors
+     in = use | (out & ~def)
+
+   to a fixed point.  This program runs that iteration on a synthetic
+   CFG, a chain of blocks with some back edges, with the bitmaps on a
+   plain obstack and on a hybrid one (see bitmap.h), for several
+   densities of the sets.  Build it in the gcc directory of a build tree,
+   with the objects of the compiler proper (add -DCROSS_DIRECTORY_STRUCTURE
+   for a cross compiler):
+
+     g++ -O2 -DIN_GCC -DHAVE_CONFIG_H -I. -I$srcdir/gcc -I$srcdir/include \
+	 -I$srcdir/libcpp/include -I$srcdir/libdecnumber \
+	 -I$srcdir/libdecnumber/bid -I../libdecnumber \
+	 $srcdir/contrib/bitmap-bench.cc bitmap.o ggc-none.o hash-table.o \
+	 memory-block.o ../libiberty/libiberty.a -o bitmap-bench
+
+     ./bitmap-bench [-n REPEAT] [BLOCKS [REGS]]
+
+   BLOCKS (default 2000) is the number of blocks and REGS (default 20000)
+   the number of registers.  For each density the best of REPEAT
+   (default 5) runs is printed for either kind of bitmap, with the
+   number of iterations and the result, which must agree.  */
+
+#include "config.h"
+#include "system.h"
+#include "coretypes.h"
+#include "bitmap.h"
+
+/* The rest of the compiler is not linked in; bitmap.c only needs
+   this.  */
+
+void
+fancy_abort (const char *file, int line, const char *function)
+{
+  fprintf (stderr, "internal error in %s, at %s:%d\n", function, file, line);
+  abort ();
+}
+
+/* A basic block of the synthetic CFG.  */
+
+struct bench_block
+{
+  bitmap use, def, in, out;
+  int succ[2];
+};
+
+/* Return a pseudo-random number; the sequence is the same in every
+   run.  */
+
+static unsigned int
+bench_random (unsigned long *state)
+{
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return (unsigned int) *state;
+}
+
+/* Return the processor time used so far in seconds.  */
+
+static double
+cpu_time (void)
+{
+  return (double) clock () / CLOCKS_PER_SEC;
+}
+
+/* Set up the N_BLOCKS blocks of BLOCKS with bitmaps on OBSTACK.  Each
+   block uses and defines registers out of REGS of them, in a window
+   that covers DENSITY percent of the registers around a position that
+   moves along the chain, as the live ranges of a function do.  */
+
+static void
+bench_init (bench_block *blocks, int n_blocks, unsigned int regs,
+	    unsigned int density, bitmap_obstack *obstack)
+{
+  unsigned long state = 88172645463325252ul;
+  unsigned int window = MAX (regs * density / 100, 1u);
+  int i;
+
+  for (i = 0; i < n_blocks; i++)
+    {
+      bench_block *bb = &blocks[i];
+      unsigned int center = (unsigned long) regs * i / n_blocks;
+      unsigned int lo = center > window / 2 ? center - window / 2 : 0;
+      unsigned int k;
+
+      bb->use = BITMAP_ALLOC (obstack);
+      bb->def = BITMAP_ALLOC (obstack);
+      bb->in = BITMAP_ALLOC (obstack);
+      bb->out = BITMAP_ALLOC (obstack);
+      for (k = 0; k < window / 8 + 1; k++)
+	{
+	  bitmap_set_bit (bb->use, (lo + bench_random (&state) % window)
+			  % regs);
+	  bitmap_set_bit (bb->def, (lo + bench_random (&state) % window)
+			  % regs);
+	}
+      bb->succ[0] = i + 1 < n_blocks ? i + 1 : -1;
+      bb->succ[1] = (bench_random (&state) % 8 == 0
+		     ? (int) (bench_random (&state) % (i + 1)) : -1);
+    }
+}
+
+/* Iterate the liveness equations over the N_BLOCKS blocks of BLOCKS to
+   a fixed point, going backwards.  Return the number of passes.  */
+
+static int
+bench_solve (bench_block *blocks, int n_blocks)
+{
+  bool changed = true;
+  int passes = 0;
+  int i, j;
+
+  while (changed)
+    {
+      changed = false;
+      passes++;
+      for (i = n_blocks - 1; i >= 0; i--)
+	{
+	  bench_block *bb = &blocks[i];
+
+	  for (j = 0; j < 2; j++)
+	    if (bb->succ[j] >= 0)
+	      bitmap_ior_into (bb->out, blocks[bb->succ[j]].in);
+	  if (bitmap_ior_and_compl (bb->in, bb->use, bb->out, bb->def))
+	    changed = true;
+	}
+    }
+  return passes;
+}
+
+/* Run the benchmark REPEAT times on N_BLOCKS blocks and REGS registers
+   at DENSITY, on a hybrid obstack if HYBRID.  Print the best time, and
+   return the number of live registers summed over all blocks.  */
+
+static unsigned long
+run (bool hybrid, int n_blocks, unsigned int regs, unsigned int density,
+     int repeat)
+{
+  bench_block *blocks = XNEWVEC (bench_block, n_blocks);
+  double best = 0;
+  unsigned long live = 0;
+  int passes = 0, dense = 0;
+  int r, i;
+
+  for (r = 0; r < repeat; r++)
+    {
+      bitmap_obstack obstack;
+      double start;
+
+      bitmap_obstack_initialize (&obstack);
+      bitmap_obstack_set_hybrid (&obstack, hybrid);
+      bench_init (blocks, n_blocks, regs, density, &obstack);
+
+      start = cpu_time ();
+      passes = bench_solve (blocks, n_blocks);
+      start = cpu_time () - start;
+      if (r == 0 || start < best)
+	best = start;
+
+      live = dense = 0;
+      for (i = 0; i < n_blocks; i++)
+	{
+	  live += bitmap_count_bits (blocks[i].in);
+	  dense += bitmap_dense_p (blocks[i].in);
+	}
+      bitmap_obstack_release (&obstack);
+    }
+
+  printf ("%7u%% %-8s %8d %8d %12lu %10.3f\n", density,
+	  hybrid ? "hybrid" : "list", passes, dense, live, best * 1e3);
+  XDELETEVEC (blocks);
+  return live;
+}
+
+int
+main (int argc, char **argv)
+{
+  static const unsigned int densities[] = { 1, 5, 20, 50, 100 };
+  int repeat = 5, n_blocks = 2000;
+  unsigned int regs = 20000;
+  size_t i;
+
+  if (argc > 2 && strcmp (argv[1], "-n") == 0)
+    {
+      repeat = atoi (argv[2]);
+      argc -= 2;
+      argv += 2;
+    }
+  if (argc > 1)
+    n_blocks = atoi (argv[1]);
+  if (argc > 2)
+    regs = atoi (argv[2]);
+  if (argc > 3 || repeat < 1 || n_blocks < 1 || regs < 1)
+    {
+      fprintf (stderr, "usage: bitmap-bench [-n REPEAT] [BLOCKS [REGS]]\n");
+      return 1;
+    }
+
+  printf ("%d blocks, %u registers\n", n_blocks, regs);
+  printf ("%8s %-8s %8s %8s %12s %10s\n", "density", "bitmaps", "passes",
+	  "dense", "live", "ms");
+  for (i = 0; i < ARRAY_SIZE (densities); i++)
+    if (run (false, n_blocks, regs, densities[i], repeat)
+	!= run (true, n_blocks, regs, densities[i], repeat))
+      {
+	fprintf (stderr, "the results differ\n");
+	return 1;
+      }
+
+  return 0;
+}
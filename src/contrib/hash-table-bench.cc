@@ -0,0 +1,217 @@
+/* Compare the storage policies of hash_table on the lookups of an LTO link.
+   Copyright (C) 2016 Free Software Foundation, Inc.
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 3, or (at your option) any
+later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; see the file COPYING3.  If not see
+<http://www.gnu.org/licenses/>.  */
+
+/* The biggest table of an LTO link is the one lto1 unifies the tree
+   SCCs of all the object files in.  lto1 -fscc-hash-trace=FILE writes
+   one line per lookup in it, with the hash, the number of trees and the
+   number of entry trees of the SCC, which is all the table compares.
+   The option can be given at link time:
+
+     gcc -flto -O2 *.o -fscc-hash-trace=scc.trace
+
+   This program replays such traces against a hash_table with each
+   storage policy.  Build it in the gcc directory of a build tree, with
+   the objects the generator programs use:
+
+     g++ -O2 -DGENERATOR_FILE -I. -I$srcdir/gcc -I$srcdir/include \
+	 -I$srcdir/libcpp/include $srcdir/contrib/hash-table-bench.cc \
+	 build/hash-table.o build/ggc-none.o build/vec.o build/errors.o \
+	 ../build-$build/libiberty/libiberty.a -o hash-table-bench
+
+     ./hash-table-bench [-n REPEAT] TRACE...
+
+   The SCCs are inserted in trace order, as lto1 does, and then looked
+   up again.  For each policy the best of REPEAT (default 5) runs of
+   either phase is printed, with the collision ratio of the inserts.  */
+
+#include "bconfig.h"
+#include "system.h"
+#include "coretypes.h"
+#include "hash-table.h"
+
+/* What the tree SCC hash table of lto1 knows about an SCC.  */
+
+struct scc_key
+{
+  hashval_t hash;
+  unsigned len;
+  unsigned entry_len;
+};
+
+/* The descriptor of the table, as tree_scc_hasher in lto/lto.c.  */
+
+struct scc_key_hasher : nofree_ptr_hash <scc_key>
+{
+  static inline hashval_t hash (const scc_key *);
+  static inline bool equal (const scc_key *, const scc_key *);
+};
+
+inline hashval_t
+scc_key_hasher::hash (const scc_key *key)
+{
+  return key->hash;
+}
+
+inline bool
+scc_key_hasher::equal (const scc_key *key1, const scc_key *key2)
+{
+  return (key1->hash == key2->hash
+	  && key1->len == key2->len
+	  && key1->entry_len == key2->entry_len);
+}
+
+/* Return the processor time used so far in seconds.  */
+
+static double
+cpu_time (void)
+{
+  return (double) clock () / CLOCKS_PER_SEC;
+}
+
+/* The results of replaying the trace.  */
+
+struct replay_result
+{
+  double insert_time, lookup_time;
+  size_t elements, size;
+  double collisions;
+};
+
+/* Replay the N lookups of KEYS against a table with storage policy
+   Storage, into RESULT.  Each key is stored separately, as the SCCs of
+   lto1 are, so that comparing them touches memory the table does not
+   own.  */
+
+template <hash_table_storage Storage>
+static void
+replay (scc_key **keys, size_t n, replay_result *result)
+{
+  typedef hash_table <scc_key_hasher, xcallocator, Storage> table_type;
+  table_type *table = new table_type (4096);
+  double start;
+  size_t i;
+
+  start = cpu_time ();
+  for (i = 0; i < n; i++)
+    {
+      scc_key **slot = table->find_slot_with_hash (keys[i], keys[i]->hash,
+						   INSERT);
+      if (*slot == NULL)
+	*slot = keys[i];
+    }
+  result->insert_time = cpu_time () - start;
+  result->collisions = table->collisions ();
+  result->elements = table->elements ();
+  result->size = table->size ();
+
+  delete table;
+  table = new table_type (4096);
+  for (i = 0; i < n; i++)
+    {
+      scc_key **slot = table->find_slot_with_hash (keys[i], keys[i]->hash,
+						   INSERT);
+      if (*slot == NULL)
+	*slot = keys[i];
+    }
+
+  start = cpu_time ();
+  for (i = 0; i < n; i++)
+    if (table->find_with_hash (keys[i], keys[i]->hash) == NULL)
+      abort ();
+  result->lookup_time = cpu_time () - start;
+
+  delete table;
+}
+
+/* Replay the trace with storage policy Storage REPEAT times and print
+   the best times under NAME.  */
+
+template <hash_table_storage Storage>
+static void
+run (const char *name, scc_key **keys, size_t n, int repeat)
+{
+  replay_result best, result;
+
+  for (int i = 0; i < repeat; i++)
+    {
+      replay <Storage> (keys, n, &result);
+      if (i == 0)
+	best = result;
+      best.insert_time = MIN (best.insert_time, result.insert_time);
+      best.lookup_time = MIN (best.lookup_time, result.lookup_time);
+    }
+
+  printf ("%-14s %10lu %10lu %10.3f %10.3f %10.3f\n", name,
+	  (unsigned long) best.elements, (unsigned long) best.size,
+	  best.collisions, best.insert_time * 1e3, best.lookup_time * 1e3);
+}
+
+int
+main (int argc, char **argv)
+{
+  size_t n = 0, room = 1024;
+  scc_key **keys;
+  int repeat = 5;
+  int i;
+
+  if (argc > 2 && strcmp (argv[1], "-n") == 0)
+    {
+      repeat = atoi (argv[2]);
+      argc -= 2;
+      argv += 2;
+    }
+  if (argc < 2 || repeat < 1)
+    {
+      fprintf (stderr, "usage: hash-table-bench [-n REPEAT] TRACE...\n");
+      return 1;
+    }
+
+  keys = XNEWVEC (scc_key *, room);
+  for (i = 1; i < argc; i++)
+    {
+      FILE *f = fopen (argv[i], "r");
+      unsigned hash, len, entry_len;
+
+      if (f == NULL)
+	{
+	  perror (argv[i]);
+	  return 1;
+	}
+      while (fscanf (f, "%x %u %u", &hash, &len, &entry_len) == 3)
+	{
+	  if (n == room)
+	    {
+	      room *= 2;
+	      keys = XRESIZEVEC (scc_key *, keys, room);
+	    }
+	  keys[n] = XNEW (scc_key);
+	  keys[n]->hash = hash;
+	  keys[n]->len = len;
+	  keys[n]->entry_len = entry_len;
+	  n++;
+	}
+      fclose (f);
+    }
+
+  printf ("%lu lookups\n", (unsigned long) n);
+  printf ("%-14s %10s %10s %10s %10s %10s\n", "storage", "elements",
+	  "size", "collisions", "insert ms", "lookup ms");
+  run <HASH_TABLE_PROBE_KEYS> ("probe-keys", keys, n, repeat);
+  run <HASH_TABLE_CONTROL_BYTES> ("control-bytes", keys, n, repeat);
+
+  return 0;
+}
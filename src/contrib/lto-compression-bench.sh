@@ -0,0 +1,90 @@
+#!/bin/sh
+
+# Compare the LTO IL compression algorithms on a set of sources.
+# Copyright (C) 2016  Free Software Foundation, Inc.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, see the file COPYING3.  If not,
+# see <http://www.gnu.org/licenses/>.
+
+# The compiler and the flags used for every compilation and link.
+: ${CC:=gcc}
+: ${CFLAGS:=-O2}
+: ${LDFLAGS:=}
+# Algorithms to compare and number of WPA runs for each.
+: ${ALGORITHMS:=zlib lz}
+: ${RUNS:=3}
+
+usage() {
+    cat <<EOF
+lto-compression-bench.sh source...
+
+    Compiles every SOURCE with -flto once per algorithm in ALGORITHMS
+    (default "zlib lz"), using -flto-compression-algorithm=, and links
+    the objects RUNS times (default 3).  For each algorithm, prints the
+    total size of the LTO objects and the best WPA time spent in the
+    "lto stream inflate" phase of -ftime-report, together with the total
+    WPA time.
+
+    CC, CFLAGS and LDFLAGS select the compiler and the flags, for example
+    CC=arm-none-eabi-gcc LDFLAGS=--specs=nosys.specs.
+EOF
+    exit 1
+}
+
+test $# -eq 0 && usage
+
+tmp=$(mktemp -d ${TMPDIR:-/tmp}/lto-bench.XXXXXX) || exit 1
+trap 'rm -rf "$tmp"' EXIT
+
+# Print the user time recorded for phase $1 in -ftime-report output $2.
+phase_time() {
+    sed -n "s/^ *$1 *: *\([0-9.]*\).*/\1/p" "$2" | head -n 1
+}
+
+printf "%-10s %12s %12s %12s\n" algorithm "object bytes" "inflate (s)" "WPA (s)"
+for alg in $ALGORITHMS; do
+    objs=
+    i=0
+    for src in "$@"; do
+	obj=$tmp/$alg-$i.o
+	$CC $CFLAGS -flto -flto-compression-algorithm=$alg -c "$src" -o "$obj" \
+	    || exit 1
+	objs="$objs $obj"
+	i=$((i + 1))
+    done
+    size=$(cat $objs | wc -c)
+
+    best_inflate=
+    best_wpa=
+    run=0
+    while test $run -lt $RUNS; do
+	log=$tmp/$alg-$run.log
+	$CC $CFLAGS $LDFLAGS -flto -flto-partition=one -ftime-report $objs \
+	    -o $tmp/a.out > "$log" 2>&1 || { cat "$log"; exit 1; }
+	inflate=$(phase_time "lto stream inflate" "$log")
+	wpa=$(phase_time "phase opt and generate" "$log")
+	: ${inflate:=0} ${wpa:=0}
+	if test -z "$best_inflate" \
+	   || awk "BEGIN { exit !($inflate < $best_inflate) }"; then
+	    best_inflate=$inflate
+	fi
+	if test -z "$best_wpa" \
+	   || awk "BEGIN { exit !($wpa < $best_wpa) }"; then
+	    best_wpa=$wpa
+	fi
+	run=$((run + 1))
+    done
+
+    printf "%-10s %12s %12s %12s\n" $alg $size $best_inflate $best_wpa
+done
@@ -0,0 +1,212 @@
+/* Measure the speed of the libcpp line scanners on x86.
+   Copyright (C) 2016 Free Software Foundation, Inc.
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 3, or (at your option) any
+later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; see the file COPYING3.  If not see
+<http://www.gnu.org/licenses/>.  */
+
+/* This includes libcpp/lex.c to get at its search_line_* functions, so
+   it has to be built against a configured libcpp.  From the libcpp
+   directory of a build tree:
+
+     g++ -O2 -I. -I$srcdir/libcpp -I$srcdir/libcpp/include \
+	 -I$srcdir/include $srcdir/contrib/search-line-bench.c \
+	 libcpp.a ../libiberty/libiberty.a -o search-line-bench
+
+   Then run it on a set of headers, for example the device headers of
+   a CMSIS pack:
+
+     ./search-line-bench [-n REPEAT] FILE...
+
+   The files are read into one buffer, which is scanned the way
+   _cpp_clean_line does, by each scanner the CPU supports.  For each the
+   best of REPEAT (default 20) runs is printed, in bytes per TSC tick;
+   the TSC counts at a fixed rate, usually the nominal clock rate of the
+   CPU.  */
+
+#include "../libcpp/lex.c"
+
+#if !(defined(__i386__) || defined(__x86_64__))
+#error "search-line-bench only knows about the x86 scanners"
+#endif
+
+/* The rest of libcpp is linked in for lex.c; these are what a client
+   of libcpp has to provide.  */
+
+void
+fancy_abort (const char *file, int line, const char *function)
+{
+  fprintf (stderr, "internal error in %s, at %s:%d\n", function, file, line);
+  abort ();
+}
+
+expanded_location
+linemap_client_expand_location_to_spelling_point (source_location)
+{
+  abort ();
+}
+
+struct scanner
+{
+  const char *name;
+  search_line_fast_type fn;
+  const char *feature;
+};
+
+static const struct scanner scanners[] = {
+  { "acc_char", search_line_acc_char, NULL },
+  { "mmx", search_line_mmx, "sse" },
+  { "sse2", search_line_sse2, "sse2" },
+#ifdef HAVE_SSE4
+  { "sse4.2", search_line_sse42, "sse4.2" },
+#endif
+#if defined(HAVE_AVX2) && GCC_VERSION >= 4009
+  { "avx2", search_line_avx2, "avx2" },
+#endif
+#if defined(HAVE_AVX512BW) && GCC_VERSION >= 5000
+  { "avx512bw", search_line_avx512bw, "avx512bw" },
+#endif
+};
+
+/* Return true if the CPU has FEATURE, as named for -m options.  */
+
+static bool
+cpu_has (const char *feature)
+{
+  if (feature == NULL)
+    return true;
+#define FEATURE(NAME) \
+  if (strcmp (feature, NAME) == 0) \
+    return __builtin_cpu_supports (NAME);
+  FEATURE ("sse")
+  FEATURE ("sse2")
+  FEATURE ("sse4.2")
+  FEATURE ("avx2")
+#if GCC_VERSION >= 5000
+  FEATURE ("avx512bw")
+#endif
+#undef FEATURE
+  return false;
+}
+
+/* Scan the LEN bytes at BUF, which end with a newline, with FN.
+   Return the number of stops, so the loop is not optimized away.  */
+
+static size_t
+scan (search_line_fast_type fn, const uchar *buf, size_t len)
+{
+  const uchar *s = buf, *end = buf + len;
+  size_t stops = 0;
+
+  while (s < end)
+    {
+      s = fn (s, end) + 1;
+      stops++;
+    }
+  return stops;
+}
+
+int
+main (int argc, char **argv)
+{
+  uchar *buf;
+  size_t len = 0, room = 1 << 20, expected_stops = 0;
+  int repeat = 20;
+  int i;
+  size_t j;
+
+  if (argc > 2 && strcmp (argv[1], "-n") == 0)
+    {
+      repeat = atoi (argv[2]);
+      argc -= 2;
+      argv += 2;
+    }
+  if (argc < 2 || repeat < 1)
+    {
+      fprintf (stderr, "usage: search-line-bench [-n REPEAT] FILE...\n");
+      return 1;
+    }
+
+  buf = XNEWVEC (uchar, room);
+  for (i = 1; i < argc; i++)
+    {
+      FILE *f = fopen (argv[i], "rb");
+      size_t n;
+
+      if (f == NULL)
+	{
+	  perror (argv[i]);
+	  return 1;
+	}
+      do
+	{
+	  if (room - len < 4096)
+	    {
+	      room *= 2;
+	      buf = XRESIZEVEC (uchar, buf, room);
+	    }
+	  n = fread (buf + len, 1, room - len - 64, f);
+	  len += n;
+	}
+      while (n > 0);
+      fclose (f);
+    }
+  /* The buffer always ends with a newline, and the scanners rely on
+     it.  */
+  buf[len++] = '\n';
+
+  init_vectorized_lexer ();
+  printf ("%llu bytes, dispatch chooses ",
+	  (unsigned long long) len);
+  for (j = 0; j < ARRAY_SIZE (scanners); j++)
+    if (scanners[j].fn == search_line_fast)
+      printf ("%s", scanners[j].name);
+  printf ("\n%-10s %12s %12s\n", "scanner", "bytes/tick", "ticks");
+
+  for (j = 0; j < ARRAY_SIZE (scanners); j++)
+    {
+      unsigned long long best = ~0ull;
+      size_t stops = 0;
+
+      if (!cpu_has (scanners[j].feature))
+	{
+	  printf ("%-10s %12s\n", scanners[j].name, "unsupported");
+	  continue;
+	}
+
+      for (i = 0; i < repeat; i++)
+	{
+	  unsigned long long start = __builtin_ia32_rdtsc ();
+	  stops = scan (scanners[j].fn, buf, len);
+	  unsigned long long ticks = __builtin_ia32_rdtsc () - start;
+	  if (ticks < best)
+	    best = ticks;
+	}
+
+      /* All the scanners must stop at the same places.  */
+      if (expected_stops == 0)
+	expected_stops = stops;
+      else if (stops != expected_stops)
+	{
+	  fprintf (stderr, "%s: %llu stops, expected %llu\n",
+		   scanners[j].name, (unsigned long long) stops,
+		   (unsigned long long) expected_stops);
+	  return 1;
+	}
+
+      printf ("%-10s %12.2f %12llu\n", scanners[j].name,
+	      (double) len / best, best);
+    }
+
+  return 0;
+}
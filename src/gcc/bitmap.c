@@ -56,6 +56,30 @@ static void bitmap_element_link (bitmap, bitmap_element *);
 static bitmap_element *bitmap_elt_insert_after (bitmap, bitmap_element *, unsigned int);
 static void bitmap_elt_clear_from (bitmap, bitmap_element *);
 static bitmap_element *bitmap_find_bit (bitmap, unsigned int);
+static void bitmap_dense_free (bitmap, bitmap_element *, bool);
+
+/* Number of bitmap elements allocated so far.  The set operations on a
+   hybrid bitmap in the list form only consider switching it to the dense
+   form when they have allocated elements for it.  */
+static unsigned long bitmap_elements_allocated;
+
+/* Return true if HEAD is dense or may become dense.  */
+
+static inline bool
+bitmap_hybrid_p (const_bitmap head)
+{
+  return head->dense_len || (head->obstack && head->obstack->hybrid);
+}
+
+/* Return the array of elements of dense bitmap HEAD.  A dense bitmap is
+   never empty, and its elements are indexed by their index from
+   DENSE_BASE on.  */
+
+static inline bitmap_element *
+bitmap_dense_elts (const_bitmap head)
+{
+  return head->first - (head->first->indx - head->dense_base);
+}
 
 
 /* Add ELEM to the appropriate freelist.  */
@@ -158,6 +182,7 @@ bitmap_element_allocate (bitmap head)
 
   if (GATHER_STATISTICS)
     register_overhead (head, sizeof (bitmap_element));
+  bitmap_elements_allocated++;
 
   memset (element->bits, 0, sizeof (element->bits));
 
@@ -217,7 +242,9 @@ bitmap_elt_clear_from (bitmap head, bitmap_element *elt)
 void
 bitmap_clear (bitmap head)
 {
-  if (head->first)
+  if (head->dense_len)
+    bitmap_dense_free (head, bitmap_dense_elts (head), true);
+  else if (head->first)
     bitmap_elt_clear_from (head, head->first);
 }
 
@@ -240,6 +267,7 @@ bitmap_obstack_initialize (bitmap_obstack *bit_obstack)
 
   bit_obstack->elements = NULL;
   bit_obstack->heads = NULL;
+  bit_obstack->hybrid = false;
   obstack_specify_allocation (&bit_obstack->obstack, OBSTACK_CHUNK_SIZE,
 			      __alignof__ (bitmap_element),
 			      obstack_chunk_alloc,
@@ -267,6 +295,15 @@ bitmap_obstack_release (bitmap_obstack *bit_obstack)
   obstack_free (&bit_obstack->obstack, NULL);
 }
 
+/* Let the bitmaps allocated on BIT_OBSTACK switch to the dense form if
+   HYBRID.  This must be set before any bitmap is allocated on it.  */
+
+void
+bitmap_obstack_set_hybrid (bitmap_obstack *bit_obstack, bool hybrid)
+{
+  bit_obstack->hybrid = hybrid;
+}
+
 /* Create a new bitmap on an obstack.  If BIT_OBSTACK is NULL, create
    it on the default bitmap obstack.  */
 
@@ -432,6 +469,769 @@ bitmap_elt_insert_after (bitmap head, bitmap_element *elt, unsigned int indx)
   return node;
 }
 
+/* The dense form of hybrid bitmaps, see bitmap.h.  */
+
+/* A hybrid bitmap in the list form switches to the dense form when it
+   has at least BITMAP_DENSE_MIN_ELTS elements and at least one in
+   BITMAP_DENSE_RATIO of the elements of its range is present.  It
+   switches back when fewer than one in BITMAP_SPARSE_RATIO is.  */
+#define BITMAP_DENSE_MIN_ELTS 8
+#define BITMAP_DENSE_RATIO 2
+#define BITMAP_SPARSE_RATIO 8
+
+/* The set operations the dense form does itself.  Each computes the
+   destination from up to three operands A, B and C.  */
+enum bitmap_op
+{
+  BITMAP_OP_COPY,		/* A  */
+  BITMAP_OP_AND,		/* A & B  */
+  BITMAP_OP_AND_COMPL,		/* A & ~B  */
+  BITMAP_OP_COMPL_AND,		/* ~A & B  */
+  BITMAP_OP_IOR,		/* A | B  */
+  BITMAP_OP_XOR,		/* A ^ B  */
+  BITMAP_OP_IOR_AND,		/* A | (B & C)  */
+  BITMAP_OP_IOR_AND_COMPL	/* A | (B & ~C)  */
+};
+
+/* Put elements of ELTS, the array of dense bitmap HEAD, onto the
+   freelist: all of them if ALL, which leaves HEAD empty, or else the
+   zero ones, which leaves HEAD a list of the others.  */
+
+static void
+bitmap_dense_free (bitmap head, bitmap_element *elts, bool all)
+{
+  bitmap_obstack *bit_obstack = head->obstack;
+  bitmap_element *chain = NULL;
+  unsigned int i, n = 0;
+
+  for (i = head->dense_len; i-- > 0; )
+    if (all || bitmap_element_zerop (&elts[i]))
+      {
+	elts[i].next = chain;
+	chain = &elts[i];
+	n++;
+      }
+  head->dense_base = head->dense_len = 0;
+  if (all)
+    {
+      head->first = head->current = NULL;
+      head->indx = 0;
+    }
+
+  if (GATHER_STATISTICS)
+    register_overhead (head, -sizeof (bitmap_element) * n);
+
+  /* The chain becomes one inner list of the freelist.  */
+  if (chain)
+    {
+      chain->prev = bit_obstack->elements;
+      bit_obstack->elements = chain;
+    }
+}
+
+/* Link the nonzero elements of ELTS, the array of dense bitmap HEAD,
+   into the list of HEAD.  Return their number.  */
+
+static unsigned int
+bitmap_dense_link (bitmap head, bitmap_element *elts)
+{
+  bitmap_element *prev = NULL;
+  unsigned int i, n = 0;
+
+  head->first = NULL;
+  for (i = 0; i < head->dense_len; i++)
+    if (!bitmap_element_zerop (&elts[i]))
+      {
+	elts[i].prev = prev;
+	if (prev)
+	  prev->next = &elts[i];
+	else
+	  head->first = &elts[i];
+	prev = &elts[i];
+	n++;
+      }
+  if (prev)
+    prev->next = NULL;
+  head->current = head->first;
+  head->indx = head->first ? head->first->indx : 0;
+  return n;
+}
+
+/* Link ELT, an element of ELTS, the array of dense bitmap HEAD, into the
+   list of HEAD after it has become nonzero.  */
+
+static void
+bitmap_dense_link_elt (bitmap head, bitmap_element *elts,
+		       bitmap_element *elt)
+{
+  bitmap_element *end = elts + head->dense_len;
+  bitmap_element *before = elt, *after = elt;
+
+  /* Look for the nearest element in the list on either side; there is
+     one, as the bitmap was not empty.  */
+  while (1)
+    {
+      if (before > elts && !bitmap_element_zerop (--before))
+	{
+	  elt->prev = before;
+	  elt->next = before->next;
+	  if (elt->next)
+	    elt->next->prev = elt;
+	  before->next = elt;
+	  break;
+	}
+      if (after + 1 < end && !bitmap_element_zerop (++after))
+	{
+	  elt->next = after;
+	  elt->prev = after->prev;
+	  if (elt->prev)
+	    elt->prev->next = elt;
+	  else
+	    head->first = elt;
+	  after->prev = elt;
+	  break;
+	}
+    }
+  head->current = elt;
+  head->indx = elt->indx;
+}
+
+/* Make HEAD a dense bitmap whose array covers the elements from LO to
+   HI - 1 as well as all elements HEAD already has, and return the array.
+   If the array has to be allocated anew, the list is linked again.  */
+
+static bitmap_element *
+bitmap_dense_make (bitmap head, unsigned int lo, unsigned int hi)
+{
+  bitmap_element *old = NULL, *elts, *elt;
+  unsigned int i;
+
+  if (head->dense_len)
+    {
+      old = bitmap_dense_elts (head);
+      if (head->dense_base <= lo && hi <= head->dense_base + head->dense_len)
+	return old;
+      lo = MIN (lo, head->dense_base);
+      hi = MAX (hi, head->dense_base + head->dense_len);
+    }
+  else if (head->first)
+    {
+      for (elt = head->first; elt->next; elt = elt->next)
+	;
+      lo = MIN (lo, head->first->indx);
+      hi = MAX (hi, elt->indx + 1);
+    }
+
+  elts = XOBNEWVEC (&head->obstack->obstack, bitmap_element, hi - lo);
+  memset (elts, 0, sizeof (bitmap_element) * (hi - lo));
+  for (i = 0; i < hi - lo; i++)
+    elts[i].indx = lo + i;
+  if (GATHER_STATISTICS)
+    register_overhead (head, sizeof (bitmap_element) * (hi - lo));
+
+  for (elt = head->first; elt; elt = elt->next)
+    memcpy (elts[elt->indx - lo].bits, elt->bits, sizeof (elt->bits));
+  if (old)
+    bitmap_dense_free (head, old, true);
+  else if (head->first)
+    bitmap_elt_clear_from (head, head->first);
+
+  head->dense_base = lo;
+  head->dense_len = hi - lo;
+  bitmap_dense_link (head, elts);
+  return elts;
+}
+
+/* Switch hybrid bitmap HEAD, a list, to the dense form if it has become
+   dense enough.  ALLOCATED is the number of elements that had been
+   allocated before the operation that may have grown HEAD.  */
+
+static inline void
+bitmap_maybe_dense (bitmap head, unsigned long allocated)
+{
+  const bitmap_element *elt;
+  unsigned int n = 0;
+
+  if (allocated == bitmap_elements_allocated
+      || !head->obstack || !head->obstack->hybrid)
+    return;
+
+  gcc_checking_assert (!head->dense_len);
+  if (!head->first)
+    return;
+  for (elt = head->first; ; elt = elt->next)
+    {
+      n++;
+      if (!elt->next)
+	break;
+    }
+  if (n >= BITMAP_DENSE_MIN_ELTS
+      && n * BITMAP_DENSE_RATIO >= elt->indx - head->first->indx + 1)
+    bitmap_dense_make (head, head->first->indx, elt->indx + 1);
+}
+
+/* Set BIT in dense bitmap HEAD.  Return true if the bit changed.  */
+
+static bool
+bitmap_dense_set_bit (bitmap head, unsigned int bit)
+{
+  unsigned int indx = bit / BITMAP_ELEMENT_ALL_BITS;
+  unsigned int word_num = bit / BITMAP_WORD_BITS % BITMAP_ELEMENT_WORDS;
+  BITMAP_WORD bit_val = ((BITMAP_WORD) 1) << (bit % BITMAP_WORD_BITS);
+  bitmap_element *elts = bitmap_dense_elts (head);
+  unsigned int base = head->dense_base, len = head->dense_len;
+  bitmap_element *elt;
+
+  if (indx - base >= len)
+    {
+      /* Grow the array by its length towards INDX, or switch back to a
+	 list if INDX is farther away than that.  */
+      if (indx < base ? base - indx > len : indx - base >= 2 * len)
+	{
+	  bitmap_dense_free (head, elts, false);
+	  return bitmap_set_bit (head, bit);
+	}
+      if (indx < base)
+	elts = bitmap_dense_make (head, base > len ? base - len : 0, base);
+      else
+	elts = bitmap_dense_make (head, base, base + 2 * len);
+      base = head->dense_base;
+    }
+
+  elt = &elts[indx - base];
+  if (elt->bits[word_num] & bit_val)
+    return false;
+  if (bitmap_element_zerop (elt))
+    {
+      elt->bits[word_num] = bit_val;
+      bitmap_dense_link_elt (head, elts, elt);
+    }
+  else
+    elt->bits[word_num] |= bit_val;
+  return true;
+}
+
+/* Clear BIT in dense bitmap HEAD.  Return true if the bit changed.  */
+
+static bool
+bitmap_dense_clear_bit (bitmap head, unsigned int bit)
+{
+  unsigned int indx = bit / BITMAP_ELEMENT_ALL_BITS;
+  unsigned int word_num = bit / BITMAP_WORD_BITS % BITMAP_ELEMENT_WORDS;
+  BITMAP_WORD bit_val = ((BITMAP_WORD) 1) << (bit % BITMAP_WORD_BITS);
+  bitmap_element *elts = bitmap_dense_elts (head);
+  bitmap_element *elt;
+
+  if (indx - head->dense_base >= head->dense_len)
+    return false;
+  elt = &elts[indx - head->dense_base];
+  if (!(elt->bits[word_num] & bit_val))
+    return false;
+
+  elt->bits[word_num] &= ~bit_val;
+  if (!elt->bits[word_num] && bitmap_element_zerop (elt))
+    {
+      /* Unlink the element, but leave it in the array.  */
+      if (elt->prev)
+	elt->prev->next = elt->next;
+      else
+	head->first = elt->next;
+      if (elt->next)
+	elt->next->prev = elt->prev;
+      if (head->current == elt)
+	{
+	  head->current = elt->next ? elt->next : elt->prev;
+	  head->indx = head->current ? head->current->indx : 0;
+	}
+      if (!head->first)
+	bitmap_dense_free (head, elts, true);
+    }
+  return true;
+}
+
+/* Where the dense set operations read the elements of an operand
+   from.  */
+
+struct bitmap_dense_reader
+{
+  /* The array and the range of a dense operand.  */
+  const bitmap_element *elts;
+  unsigned int base, len;
+  /* The next element of a list operand.  */
+  const bitmap_element *elt;
+};
+
+/* Initialize R to read MAP, which may be NULL for an empty operand.
+   DST is the bitmap being computed and ELTS its array; MAP may be DST,
+   whose list may be empty at this point.  */
+
+static inline void
+bitmap_dense_reader_init (bitmap_dense_reader *r, const_bitmap map,
+			  const_bitmap dst, const bitmap_element *elts)
+{
+  if (map && map->dense_len)
+    {
+      r->elts = map == dst ? elts : bitmap_dense_elts (map);
+      r->base = map->dense_base;
+      r->len = map->dense_len;
+      r->elt = NULL;
+    }
+  else
+    {
+      r->elts = NULL;
+      r->base = r->len = 0;
+      r->elt = map ? map->first : NULL;
+    }
+}
+
+/* Return the bits of the element with index INDX of the operand R
+   reads.  INDX must not decrease from one call to the next.  */
+
+static inline const BITMAP_WORD *
+bitmap_dense_read (bitmap_dense_reader *r, unsigned int indx)
+{
+  if (r->elts)
+    return (indx - r->base < r->len
+	    ? r->elts[indx - r->base].bits : bitmap_zero_bits.bits);
+
+  while (r->elt && r->elt->indx < indx)
+    r->elt = r->elt->next;
+  return (r->elt && r->elt->indx == indx
+	  ? r->elt->bits : bitmap_zero_bits.bits);
+}
+
+#if GCC_VERSION >= 4009 \
+    && (BITMAP_ELEMENT_WORDS & (BITMAP_ELEMENT_WORDS - 1)) == 0
+/* The bits of an element as one vector, so that the dense set
+   operations handle an element with a single SIMD operation where the
+   host has one.  */
+typedef BITMAP_WORD bitmap_vector
+  __attribute__ ((vector_size (sizeof (BITMAP_WORD) * BITMAP_ELEMENT_WORDS)));
+#define BITMAP_VECTOR_OPS 1
+#endif
+
+/* Set the bits DST of an element to OP of the bits A, B and C of the
+   corresponding elements of the operands.  Accumulate the bits that
+   changed into *CHANGED and return nonzero if the element is.  */
+
+template <bitmap_op OP>
+static inline BITMAP_WORD
+bitmap_dense_elt_op (BITMAP_WORD *dst, const BITMAP_WORD *a,
+		     const BITMAP_WORD *b, const BITMAP_WORD *c,
+		     BITMAP_WORD *changed)
+{
+  BITMAP_WORD ior = 0, diff = 0;
+  unsigned int ix;
+
+#ifdef BITMAP_VECTOR_OPS
+  bitmap_vector va, vb, vc, old, r;
+
+  /* The bits are not necessarily aligned like a vector.  */
+  memcpy (&va, a, sizeof (va));
+  memcpy (&vb, b, sizeof (vb));
+  memcpy (&vc, c, sizeof (vc));
+  memcpy (&old, dst, sizeof (old));
+  switch (OP)
+    {
+    case BITMAP_OP_COPY: r = va; break;
+    case BITMAP_OP_AND: r = va & vb; break;
+    case BITMAP_OP_AND_COMPL: r = va & ~vb; break;
+    case BITMAP_OP_COMPL_AND: r = ~va & vb; break;
+    case BITMAP_OP_IOR: r = va | vb; break;
+    case BITMAP_OP_XOR: r = va ^ vb; break;
+    case BITMAP_OP_IOR_AND: r = va | (vb & vc); break;
+    case BITMAP_OP_IOR_AND_COMPL: r = va | (vb & ~vc); break;
+    default: gcc_unreachable ();
+    }
+  memcpy (dst, &r, sizeof (r));
+  old ^= r;
+  for (ix = 0; ix < BITMAP_ELEMENT_WORDS; ix++)
+    {
+      ior |= r[ix];
+      diff |= old[ix];
+    }
+#else
+  for (ix = 0; ix < BITMAP_ELEMENT_WORDS; ix++)
+    {
+      BITMAP_WORD r;
+
+      switch (OP)
+	{
+	case BITMAP_OP_COPY: r = a[ix]; break;
+	case BITMAP_OP_AND: r = a[ix] & b[ix]; break;
+	case BITMAP_OP_AND_COMPL: r = a[ix] & ~b[ix]; break;
+	case BITMAP_OP_COMPL_AND: r = ~a[ix] & b[ix]; break;
+	case BITMAP_OP_IOR: r = a[ix] | b[ix]; break;
+	case BITMAP_OP_XOR: r = a[ix] ^ b[ix]; break;
+	case BITMAP_OP_IOR_AND: r = a[ix] | (b[ix] & c[ix]); break;
+	case BITMAP_OP_IOR_AND_COMPL: r = a[ix] | (b[ix] & ~c[ix]); break;
+	default: gcc_unreachable ();
+	}
+      diff |= dst[ix] ^ r;
+      dst[ix] = r;
+      ior |= r;
+    }
+#endif
+  *changed |= diff;
+  return ior;
+}
+
+/* The state of a dense set operation on its way through the array of
+   the destination.  */
+
+struct bitmap_dense_state
+{
+  /* The readers of the operands.  */
+  bitmap_dense_reader r[3];
+  /* The last element linked into the list of the destination.  */
+  bitmap_element *prev;
+  /* The bits that changed, and the number of nonzero elements.  */
+  BITMAP_WORD changed;
+  unsigned int n;
+};
+
+/* Link ELT, a nonzero element of DST, after S->prev.  */
+
+static inline void
+bitmap_dense_append (bitmap dst, bitmap_dense_state *s, bitmap_element *elt)
+{
+  elt->prev = s->prev;
+  if (s->prev)
+    s->prev->next = elt;
+  else
+    dst->first = elt;
+  s->prev = elt;
+  s->n++;
+}
+
+/* Compute the elements FROM to TO - 1 of ELTS, the array of dense bitmap
+   DST, as OP of the operands S reads, and link the nonzero ones.  */
+
+template <bitmap_op OP>
+static void
+bitmap_dense_op_range (bitmap dst, bitmap_element *elts, unsigned int from,
+		       unsigned int to, bitmap_dense_state *s)
+{
+  unsigned int i;
+
+  for (i = from; i < to; i++)
+    {
+      bitmap_element *elt = &elts[i];
+
+      if (bitmap_dense_elt_op<OP> (elt->bits,
+				   bitmap_dense_read (&s->r[0], elt->indx),
+				   bitmap_dense_read (&s->r[1], elt->indx),
+				   bitmap_dense_read (&s->r[2], elt->indx),
+				   &s->changed))
+	bitmap_dense_append (dst, s, elt);
+    }
+}
+
+/* Return the number of elements with an index of at least END the list
+   operands S reads have, and set *HI past the last of them.  */
+
+static unsigned int
+bitmap_dense_tail (bitmap_dense_state *s, unsigned int end, unsigned int *hi)
+{
+  const bitmap_element *elt;
+  unsigned int i, n = 0;
+
+  *hi = end;
+  for (i = 0; i < 3; i++)
+    if (!s->r[i].elts)
+      for (elt = s->r[i].elt; elt; elt = elt->next)
+	if (elt->indx >= end)
+	  {
+	    *hi = MAX (*hi, elt->indx + 1);
+	    n++;
+	  }
+  return n;
+}
+
+/* Set *INDX to the smallest index of at least END of an element of the
+   list operands S reads, and return true, or return false if they have
+   none.  */
+
+static bool
+bitmap_dense_next (bitmap_dense_state *s, unsigned int end,
+		   unsigned int *indx)
+{
+  bool found = false;
+  unsigned int i;
+
+  for (i = 0; i < 3; i++)
+    if (!s->r[i].elts)
+      {
+	while (s->r[i].elt && s->r[i].elt->indx < end)
+	  s->r[i].elt = s->r[i].elt->next;
+	if (s->r[i].elt && (!found || s->r[i].elt->indx < *indx))
+	  {
+	    *indx = s->r[i].elt->indx;
+	    found = true;
+	  }
+      }
+  return found;
+}
+
+/* Compute hybrid bitmap DST as OP of A, B and C in the dense form, with
+   an array that covers the elements LO to HI - 1.  If OPEN, the list
+   operands may have elements from HI on as well.  Return true if DST
+   changed.  */
+
+template <bitmap_op OP>
+static bool
+bitmap_dense_op_1 (bitmap dst, unsigned int lo, unsigned int hi, bool open,
+		   const_bitmap a, const_bitmap b, const_bitmap c)
+{
+  bitmap_element *elts = bitmap_dense_make (dst, lo, hi);
+  bitmap_dense_state s;
+  unsigned int len = dst->dense_len, tail_hi, tail_n, indx, i;
+
+  bitmap_dense_reader_init (&s.r[0], a, dst, elts);
+  bitmap_dense_reader_init (&s.r[1], b, dst, elts);
+  bitmap_dense_reader_init (&s.r[2], c, dst, elts);
+  s.prev = NULL;
+  s.changed = 0;
+  s.n = 0;
+
+  dst->first = NULL;
+  bitmap_dense_op_range<OP> (dst, elts, 0, len, &s);
+
+  /* The list operands are not walked beforehand, so it is only known
+     now whether they have elements past the array.  Those go into the
+     array if it stays dense enough, and into a list otherwise.  */
+  if (open
+      && (tail_n = bitmap_dense_tail (&s, dst->dense_base + len, &tail_hi)))
+    {
+      if (s.prev)
+	s.prev->next = NULL;
+      if (tail_hi - dst->dense_base
+	  <= BITMAP_SPARSE_RATIO * (s.n + tail_n))
+	{
+	  /* The array cannot be found from the list if it is empty.  */
+	  indx = dst->dense_base;
+	  if (!s.n)
+	    bitmap_dense_free (dst, elts, true);
+	  elts = bitmap_dense_make (dst, indx, tail_hi);
+	  s.prev = NULL;
+	  for (i = len; i-- > 0; )
+	    if (!bitmap_element_zerop (&elts[i]))
+	      {
+		s.prev = &elts[i];
+		break;
+	      }
+	  bitmap_dense_op_range<OP> (dst, elts, len, dst->dense_len, &s);
+	}
+      else
+	{
+	  bitmap_element tail;
+
+	  indx = dst->dense_base + len;
+	  bitmap_dense_free (dst, elts, false);
+	  while (bitmap_dense_next (&s, indx, &indx))
+	    {
+	      memset (tail.bits, 0, sizeof (tail.bits));
+	      if (bitmap_dense_elt_op<OP> (tail.bits,
+					   bitmap_dense_read (&s.r[0], indx),
+					   bitmap_dense_read (&s.r[1], indx),
+					   bitmap_dense_read (&s.r[2], indx),
+					   &s.changed))
+		{
+		  bitmap_element *elt = bitmap_element_allocate (dst);
+		  elt->indx = indx;
+		  memcpy (elt->bits, tail.bits, sizeof (elt->bits));
+		  bitmap_dense_append (dst, &s, elt);
+		}
+	      indx++;
+	    }
+	}
+    }
+
+  if (s.prev)
+    s.prev->next = NULL;
+  dst->current = dst->first;
+  dst->indx = dst->first ? dst->first->indx : 0;
+
+  if (dst->dense_len)
+    {
+      if (s.n == 0)
+	bitmap_dense_free (dst, elts, true);
+      else if (s.n * BITMAP_SPARSE_RATIO < dst->dense_len)
+	bitmap_dense_free (dst, elts, false);
+    }
+  return s.changed != 0;
+}
+
+/* Set *LO and *HI to the range of element indices of MAP, which may be
+   NULL; an empty range has *LO == *HI.  Add the number of elements of
+   MAP to *N if it is dense, or if EXACT.  Otherwise *HI is UINT_MAX for
+   a list, as finding its end means walking it.  */
+
+static void
+bitmap_elt_range (const_bitmap map, unsigned int *lo, unsigned int *hi,
+		  unsigned int *n, bool exact)
+{
+  const bitmap_element *elt;
+
+  *lo = *hi = 0;
+  if (!map || !map->first)
+    return;
+  if (map->dense_len)
+    {
+      *lo = map->dense_base;
+      *hi = map->dense_base + map->dense_len;
+      *n += map->dense_len;
+      return;
+    }
+  *lo = map->first->indx;
+  if (!exact)
+    {
+      *hi = UINT_MAX;
+      return;
+    }
+  for (elt = map->first; ; elt = elt->next)
+    {
+      ++*n;
+      if (!elt->next)
+	break;
+    }
+  *hi = elt->indx + 1;
+}
+
+/* Set [*LO, *HI) to the union of itself and [LO, HI).  */
+
+static inline void
+bitmap_range_union (unsigned int *lo, unsigned int *hi,
+		    unsigned int lo2, unsigned int hi2)
+{
+  if (lo2 == hi2)
+    return;
+  if (*lo == *hi)
+    *lo = lo2, *hi = hi2;
+  else
+    *lo = MIN (*lo, lo2), *hi = MAX (*hi, hi2);
+}
+
+/* Set [*LO, *HI) to the intersection of itself and [LO, HI).  */
+
+static inline void
+bitmap_range_intersect (unsigned int *lo, unsigned int *hi,
+			unsigned int lo2, unsigned int hi2)
+{
+  *lo = MAX (*lo, lo2);
+  *hi = MIN (*hi, hi2);
+  if (*lo >= *hi)
+    *lo = *hi = 0;
+}
+
+/* Compute hybrid bitmap DST as OP of A, B and C in the dense form if DST
+   or one of the operands is dense and the result is not too sparse for
+   it.  If so, set *CHANGED to whether DST changed and return true.
+   Otherwise make sure DST is a list and return false, for the caller to
+   compute it as a list.  */
+
+static bool
+bitmap_dense_op (enum bitmap_op op, bitmap dst, const_bitmap a,
+		 const_bitmap b, const_bitmap c, bool *changed)
+{
+  unsigned int lo, hi, a_lo, a_hi, b_lo, b_hi, c_lo, c_hi, d_lo, d_hi;
+  unsigned int n = 0, end = 0;
+  bool open;
+
+  if (!dst->dense_len
+      && !a->dense_len
+      && !(b && b->dense_len)
+      && !(c && c->dense_len))
+    return false;
+
+  /* The range of the result, together with the range of DST.  The end
+     of list operands is left open.  */
+  bitmap_elt_range (a, &a_lo, &a_hi, &n, false);
+  bitmap_elt_range (b, &b_lo, &b_hi, &n, false);
+  bitmap_elt_range (c, &c_lo, &c_hi, &n, false);
+  switch (op)
+    {
+    case BITMAP_OP_COPY:
+    case BITMAP_OP_AND_COMPL:
+      lo = a_lo, hi = a_hi;
+      break;
+    case BITMAP_OP_AND:
+      lo = a_lo, hi = a_hi;
+      bitmap_range_intersect (&lo, &hi, b_lo, b_hi);
+      break;
+    case BITMAP_OP_COMPL_AND:
+      lo = b_lo, hi = b_hi;
+      break;
+    case BITMAP_OP_IOR:
+    case BITMAP_OP_XOR:
+    case BITMAP_OP_IOR_AND_COMPL:
+      lo = a_lo, hi = a_hi;
+      bitmap_range_union (&lo, &hi, b_lo, b_hi);
+      break;
+    case BITMAP_OP_IOR_AND:
+      bitmap_range_intersect (&b_lo, &b_hi, c_lo, c_hi);
+      lo = a_lo, hi = a_hi;
+      bitmap_range_union (&lo, &hi, b_lo, b_hi);
+      break;
+    default:
+      gcc_unreachable ();
+    }
+  if (dst != a)
+    bitmap_elt_range (dst, &d_lo, &d_hi, &n, true);
+  else
+    d_lo = a_lo, d_hi = a_hi;
+  bitmap_range_union (&lo, &hi, d_lo, d_hi);
+
+  if (lo == hi)
+    {
+      /* Both DST and the result are empty.  */
+      *changed = false;
+      return true;
+    }
+
+  /* An open range ends where the dense operands and DST do for now.  */
+  open = hi == UINT_MAX;
+  if (open)
+    {
+      if (a->dense_len)
+	end = a->dense_base + a->dense_len;
+      if (b && b->dense_len)
+	end = MAX (end, b->dense_base + b->dense_len);
+      if (c && c->dense_len)
+	end = MAX (end, c->dense_base + c->dense_len);
+      if (d_hi != UINT_MAX)
+	end = MAX (end, d_hi);
+      hi = MAX (end, lo + 1);
+    }
+
+  if (hi - lo > n * BITMAP_SPARSE_RATIO)
+    {
+      if (dst->dense_len)
+	bitmap_dense_free (dst, bitmap_dense_elts (dst), false);
+      return false;
+    }
+
+  switch (op)
+    {
+#define BITMAP_DENSE_OP(OP) \
+    case OP: \
+      *changed = bitmap_dense_op_1<OP> (dst, lo, hi, open, a, b, c); \
+      break;
+    BITMAP_DENSE_OP (BITMAP_OP_COPY)
+    BITMAP_DENSE_OP (BITMAP_OP_AND)
+    BITMAP_DENSE_OP (BITMAP_OP_AND_COMPL)
+    BITMAP_DENSE_OP (BITMAP_OP_COMPL_AND)
+    BITMAP_DENSE_OP (BITMAP_OP_IOR)
+    BITMAP_DENSE_OP (BITMAP_OP_XOR)
+    BITMAP_DENSE_OP (BITMAP_OP_IOR_AND)
+    BITMAP_DENSE_OP (BITMAP_OP_IOR_AND_COMPL)
+#undef BITMAP_DENSE_OP
+    default:
+      gcc_unreachable ();
+    }
+  return true;
+}
+
 /* Copy a bitmap to another bitmap.  */
 
 void
@@ -439,6 +1239,12 @@ bitmap_copy (bitmap to, const_bitmap from)
 {
   const bitmap_element *from_ptr;
   bitmap_element *to_ptr = 0;
+  unsigned long allocated = bitmap_elements_allocated;
+  bool changed;
+
+  if (bitmap_hybrid_p (to)
+      && bitmap_dense_op (BITMAP_OP_COPY, to, from, NULL, NULL, &changed))
+    return;
 
   bitmap_clear (to);
 
@@ -467,6 +1273,7 @@ bitmap_copy (bitmap to, const_bitmap from)
 
       to_ptr = to_elt;
     }
+  bitmap_maybe_dense (to, allocated);
 }
 
 /* Move a bitmap to another bitmap.  */
@@ -482,9 +1289,10 @@ bitmap_move (bitmap to, bitmap from)
 
   if (GATHER_STATISTICS)
     {
-      size_t sz = 0;
-      for (bitmap_element *e = to->first; e; e = e->next)
-	sz += sizeof (bitmap_element);
+      size_t sz = to->dense_len * sizeof (bitmap_element);
+      if (!to->dense_len)
+	for (bitmap_element *e = to->first; e; e = e->next)
+	  sz += sizeof (bitmap_element);
       register_overhead (to, sz);
       register_overhead (from, -sz);
     }
@@ -567,6 +1375,9 @@ bitmap_find_bit (bitmap head, unsigned int bit)
 bool
 bitmap_clear_bit (bitmap head, int bit)
 {
+  if (head->dense_len)
+    return bitmap_dense_clear_bit (head, bit);
+
   bitmap_element *const ptr = bitmap_find_bit (head, bit);
 
   if (ptr != 0)
@@ -595,6 +1406,9 @@ bitmap_clear_bit (bitmap head, int bit)
 bool
 bitmap_set_bit (bitmap head, int bit)
 {
+  if (head->dense_len)
+    return bitmap_dense_set_bit (head, bit);
+
   bitmap_element *ptr = bitmap_find_bit (head, bit);
   unsigned word_num = bit / BITMAP_WORD_BITS % BITMAP_ELEMENT_WORDS;
   unsigned bit_num  = bit % BITMAP_WORD_BITS;
@@ -626,9 +1440,19 @@ bitmap_bit_p (bitmap head, int bit)
   unsigned bit_num;
   unsigned word_num;
 
-  ptr = bitmap_find_bit (head, bit);
-  if (ptr == 0)
-    return 0;
+  if (head->dense_len)
+    {
+      unsigned int i = bit / BITMAP_ELEMENT_ALL_BITS - head->dense_base;
+      if (i >= head->dense_len)
+	return 0;
+      ptr = &bitmap_dense_elts (head)[i];
+    }
+  else
+    {
+      ptr = bitmap_find_bit (head, bit);
+      if (ptr == 0)
+	return 0;
+    }
 
   bit_num = bit % BITMAP_WORD_BITS;
   word_num = bit / BITMAP_WORD_BITS % BITMAP_ELEMENT_WORDS;
@@ -873,6 +1697,8 @@ bitmap_and (bitmap dst, const_bitmap a, const_bitmap b)
   const bitmap_element *a_elt = a->first;
   const bitmap_element *b_elt = b->first;
   bitmap_element *dst_prev = NULL;
+  unsigned long allocated = bitmap_elements_allocated;
+  bool changed;
 
   gcc_assert (dst != a && dst != b);
 
@@ -881,6 +1707,9 @@ bitmap_and (bitmap dst, const_bitmap a, const_bitmap b)
       bitmap_copy (dst, a);
       return;
     }
+  if (bitmap_hybrid_p (dst)
+      && bitmap_dense_op (BITMAP_OP_AND, dst, a, b, NULL, &changed))
+    return;
 
   while (a_elt && b_elt)
     {
@@ -920,6 +1749,7 @@ bitmap_and (bitmap dst, const_bitmap a, const_bitmap b)
   gcc_checking_assert (!dst->current == !dst->first);
   if (dst->current)
     dst->indx = dst->current->indx;
+  bitmap_maybe_dense (dst, allocated);
 }
 
 /* A &= B.  Return true if A changed.  */
@@ -934,6 +1764,9 @@ bitmap_and_into (bitmap a, const_bitmap b)
 
   if (a == b)
     return false;
+  if (bitmap_hybrid_p (a)
+      && bitmap_dense_op (BITMAP_OP_AND, a, a, b, NULL, &changed))
+    return changed;
 
   while (a_elt && b_elt)
     {
@@ -1025,6 +1858,7 @@ bitmap_and_compl (bitmap dst, const_bitmap a, const_bitmap b)
   bitmap_element *dst_prev = NULL;
   bitmap_element **dst_prev_pnext = &dst->first;
   bool changed = false;
+  unsigned long allocated = bitmap_elements_allocated;
 
   gcc_assert (dst != a && dst != b);
 
@@ -1034,6 +1868,9 @@ bitmap_and_compl (bitmap dst, const_bitmap a, const_bitmap b)
       bitmap_clear (dst);
       return changed;
     }
+  if (bitmap_hybrid_p (dst)
+      && bitmap_dense_op (BITMAP_OP_AND_COMPL, dst, a, b, NULL, &changed))
+    return changed;
 
   while (a_elt)
     {
@@ -1123,6 +1960,7 @@ bitmap_and_compl (bitmap dst, const_bitmap a, const_bitmap b)
   gcc_checking_assert (!dst->current == !dst->first);
   if (dst->current)
     dst->indx = dst->current->indx;
+  bitmap_maybe_dense (dst, allocated);
 
   return changed;
 }
@@ -1147,6 +1985,13 @@ bitmap_and_compl_into (bitmap a, const_bitmap b)
 	  return true;
 	}
     }
+  if (bitmap_hybrid_p (a))
+    {
+      bool dense_changed;
+      if (bitmap_dense_op (BITMAP_OP_AND_COMPL, a, a, b, NULL,
+			   &dense_changed))
+	return dense_changed;
+    }
 
   while (a_elt && b_elt)
     {
@@ -1188,6 +2033,7 @@ bitmap_set_range (bitmap head, unsigned int start, unsigned int count)
   unsigned int first_index, end_bit_plus1, last_index;
   bitmap_element *elt, *elt_prev;
   unsigned int i;
+  unsigned long allocated = bitmap_elements_allocated;
 
   if (!count)
     return;
@@ -1198,6 +2044,9 @@ bitmap_set_range (bitmap head, unsigned int start, unsigned int count)
       return;
     }
 
+  if (head->dense_len)
+    bitmap_dense_free (head, bitmap_dense_elts (head), false);
+
   first_index = start / BITMAP_ELEMENT_ALL_BITS;
   end_bit_plus1 = start + count;
   last_index = (end_bit_plus1 - 1) / BITMAP_ELEMENT_ALL_BITS;
@@ -1285,6 +2134,7 @@ bitmap_set_range (bitmap head, unsigned int start, unsigned int count)
 
   head->current = elt ? elt : elt_prev;
   head->indx = head->current->indx;
+  bitmap_maybe_dense (head, allocated);
 }
 
 /* Clear COUNT bits from START in HEAD.  */
@@ -1303,6 +2153,9 @@ bitmap_clear_range (bitmap head, unsigned int start, unsigned int count)
       return;
     }
 
+  if (head->dense_len)
+    bitmap_dense_free (head, bitmap_dense_elts (head), false);
+
   first_index = start / BITMAP_ELEMENT_ALL_BITS;
   end_bit_plus1 = start + count;
   last_index = (end_bit_plus1 - 1) / BITMAP_ELEMENT_ALL_BITS;
@@ -1428,6 +2281,8 @@ bitmap_compl_and_into (bitmap a, const_bitmap b)
   const bitmap_element *b_elt = b->first;
   bitmap_element *a_prev = NULL;
   bitmap_element *next;
+  unsigned long allocated = bitmap_elements_allocated;
+  bool changed;
 
   gcc_assert (a != b);
 
@@ -1441,6 +2296,9 @@ bitmap_compl_and_into (bitmap a, const_bitmap b)
       bitmap_clear (a);
       return;
     }
+  if (bitmap_hybrid_p (a)
+      && bitmap_dense_op (BITMAP_OP_COMPL_AND, a, a, b, NULL, &changed))
+    return;
 
   while (a_elt || b_elt)
     {
@@ -1485,6 +2343,7 @@ bitmap_compl_and_into (bitmap a, const_bitmap b)
     }
   gcc_checking_assert (!a->current == !a->first
 		       && (!a->current || a->indx == a->current->indx));
+  bitmap_maybe_dense (a, allocated);
   return;
 }
 
@@ -1559,9 +2418,14 @@ bitmap_ior (bitmap dst, const_bitmap a, const_bitmap b)
   bitmap_element *dst_prev = NULL;
   bitmap_element **dst_prev_pnext = &dst->first;
   bool changed = false;
+  unsigned long allocated = bitmap_elements_allocated;
 
   gcc_assert (dst != a && dst != b);
 
+  if (bitmap_hybrid_p (dst)
+      && bitmap_dense_op (BITMAP_OP_IOR, dst, a, b, NULL, &changed))
+    return changed;
+
   while (a_elt || b_elt)
     {
       changed = bitmap_elt_ior (dst, dst_elt, dst_prev, a_elt, b_elt, changed);
@@ -1594,6 +2458,7 @@ bitmap_ior (bitmap dst, const_bitmap a, const_bitmap b)
   gcc_checking_assert (!dst->current == !dst->first);
   if (dst->current)
     dst->indx = dst->current->indx;
+  bitmap_maybe_dense (dst, allocated);
   return changed;
 }
 
@@ -1607,9 +2472,13 @@ bitmap_ior_into (bitmap a, const_bitmap b)
   bitmap_element *a_prev = NULL;
   bitmap_element **a_prev_pnext = &a->first;
   bool changed = false;
+  unsigned long allocated = bitmap_elements_allocated;
 
   if (a == b)
     return false;
+  if (bitmap_hybrid_p (a)
+      && bitmap_dense_op (BITMAP_OP_IOR, a, a, b, NULL, &changed))
+    return changed;
 
   while (b_elt)
     {
@@ -1633,6 +2502,7 @@ bitmap_ior_into (bitmap a, const_bitmap b)
   gcc_checking_assert (!a->current == !a->first);
   if (a->current)
     a->indx = a->current->indx;
+  bitmap_maybe_dense (a, allocated);
   return changed;
 }
 
@@ -1645,6 +2515,8 @@ bitmap_xor (bitmap dst, const_bitmap a, const_bitmap b)
   const bitmap_element *a_elt = a->first;
   const bitmap_element *b_elt = b->first;
   bitmap_element *dst_prev = NULL;
+  unsigned long allocated = bitmap_elements_allocated;
+  bool changed;
 
   gcc_assert (dst != a && dst != b);
   if (a == b)
@@ -1652,6 +2524,9 @@ bitmap_xor (bitmap dst, const_bitmap a, const_bitmap b)
       bitmap_clear (dst);
       return;
     }
+  if (bitmap_hybrid_p (dst)
+      && bitmap_dense_op (BITMAP_OP_XOR, dst, a, b, NULL, &changed))
+    return;
 
   while (a_elt || b_elt)
     {
@@ -1711,6 +2586,7 @@ bitmap_xor (bitmap dst, const_bitmap a, const_bitmap b)
   gcc_checking_assert (!dst->current == !dst->first);
   if (dst->current)
     dst->indx = dst->current->indx;
+  bitmap_maybe_dense (dst, allocated);
 }
 
 /* A ^= B */
@@ -1721,12 +2597,17 @@ bitmap_xor_into (bitmap a, const_bitmap b)
   bitmap_element *a_elt = a->first;
   const bitmap_element *b_elt = b->first;
   bitmap_element *a_prev = NULL;
+  unsigned long allocated = bitmap_elements_allocated;
+  bool changed;
 
   if (a == b)
     {
       bitmap_clear (a);
       return;
     }
+  if (bitmap_hybrid_p (a)
+      && bitmap_dense_op (BITMAP_OP_XOR, a, a, b, NULL, &changed))
+    return;
 
   while (b_elt)
     {
@@ -1768,6 +2649,7 @@ bitmap_xor_into (bitmap a, const_bitmap b)
   gcc_checking_assert (!a->current == !a->first);
   if (a->current)
     a->indx = a->current->indx;
+  bitmap_maybe_dense (a, allocated);
 }
 
 /* Return true if two bitmaps are identical.
@@ -1863,6 +2745,7 @@ bitmap_ior_and_compl (bitmap dst, const_bitmap a, const_bitmap b, const_bitmap k
   const bitmap_element *kill_elt = kill->first;
   bitmap_element *dst_prev = NULL;
   bitmap_element **dst_prev_pnext = &dst->first;
+  unsigned long allocated = bitmap_elements_allocated;
 
   gcc_assert (dst != a && dst != b && dst != kill);
 
@@ -1878,6 +2761,10 @@ bitmap_ior_and_compl (bitmap dst, const_bitmap a, const_bitmap b, const_bitmap k
     return bitmap_ior (dst, a, b);
   if (bitmap_empty_p (a))
     return bitmap_and_compl (dst, b, kill);
+  if (bitmap_hybrid_p (dst)
+      && bitmap_dense_op (BITMAP_OP_IOR_AND_COMPL, dst, a, b, kill,
+			  &changed))
+    return changed;
 
   while (a_elt || b_elt)
     {
@@ -1952,6 +2839,7 @@ bitmap_ior_and_compl (bitmap dst, const_bitmap a, const_bitmap b, const_bitmap k
   gcc_checking_assert (!dst->current == !dst->first);
   if (dst->current)
     dst->indx = dst->current->indx;
+  bitmap_maybe_dense (dst, allocated);
 
   return changed;
 }
@@ -1964,6 +2852,11 @@ bitmap_ior_and_compl_into (bitmap a, const_bitmap from1, const_bitmap from2)
   bitmap_head tmp;
   bool changed;
 
+  if (bitmap_hybrid_p (a)
+      && bitmap_dense_op (BITMAP_OP_IOR_AND_COMPL, a, a, from1, from2,
+			  &changed))
+    return changed;
+
   bitmap_initialize (&tmp, &bitmap_default_obstack);
   bitmap_and_compl (&tmp, from1, from2);
   changed = bitmap_ior_into (a, &tmp);
@@ -1985,11 +2878,15 @@ bitmap_ior_and_into (bitmap a, const_bitmap b, const_bitmap c)
   bitmap_element **a_prev_pnext = &a->first;
   bool changed = false;
   unsigned ix;
+  unsigned long allocated = bitmap_elements_allocated;
 
   if (b == c)
     return bitmap_ior_into (a, b);
   if (bitmap_empty_p (b) || bitmap_empty_p (c))
     return false;
+  if (bitmap_hybrid_p (a)
+      && bitmap_dense_op (BITMAP_OP_IOR_AND, a, a, b, c, &changed))
+    return changed;
 
   and_elt.indx = -1;
   while (b_elt && c_elt)
@@ -2048,6 +2945,7 @@ bitmap_ior_and_into (bitmap a, const_bitmap b, const_bitmap c)
   gcc_checking_assert (!a->current == !a->first);
   if (a->current)
     a->indx = a->current->indx;
+  bitmap_maybe_dense (a, allocated);
   return changed;
 }
 
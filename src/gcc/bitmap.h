@@ -125,7 +125,19 @@ along with GCC; see the file COPYING3.  If not see
 
    A single free-list is used for all sets allocated in GGC space.  This is
    bad for persistent sets, so persistent sets should be allocated on an
-   obstack whenever possible.  */
+   obstack whenever possible.
+
+   Sets that fill most of their range are better off as a plain array of
+   elements.  A set allocated on a hybrid obstack (see
+   bitmap_obstack_set_hybrid) switches to a dense form once at least half
+   of the elements between its first and its last element are present.
+   The elements of a dense set are then one array indexed by the element
+   index, of which the list links the nonzero ones, so anything that only
+   walks the list, including the iterators below, works on either form.
+   The set operations on a dense set go over the array in order, a whole
+   element at a time, instead of searching the lists; a dense set that
+   becomes sparse again switches back to the list form.  Dense sets are
+   not supported in GGC space.  */
 
 #include "obstack.h"
 
@@ -210,6 +222,7 @@ struct GTY (()) bitmap_obstack {
   struct bitmap_element *elements;
   struct bitmap_head *heads;
   struct obstack GTY ((skip)) obstack;
+  bool hybrid;			/* Whether the bitmaps may become dense.  */
 };
 
 /* Bitmap set element.  We use a linked list to hold only the bits that
@@ -243,6 +256,10 @@ struct GTY(()) bitmap_head {
   bitmap_element * GTY((skip(""))) current; /* Last element looked at.  */
   bitmap_obstack *obstack;		/* Obstack to allocate elements from.
 					   If NULL, then use GGC allocation.  */
+  unsigned int dense_base;		/* Index of the first element of the
+					   array of a dense bitmap.  */
+  unsigned int dense_len;		/* Number of elements in that array,
+					   0 if the bitmap is a list.  */
 };
 
 /* Global data */
@@ -274,6 +291,12 @@ inline bool bitmap_empty_p (const_bitmap map)
   return !map->first;
 }
 
+/* True if MAP is in the dense form.  */
+inline bool bitmap_dense_p (const_bitmap map)
+{
+  return map->dense_len != 0;
+}
+
 /* True if the bitmap has only a single bit set.  */
 extern bool bitmap_single_bit_set_p (const_bitmap);
 
@@ -328,6 +351,7 @@ extern void bitmap_print (FILE *, const_bitmap, const char *, const char *);
 /* Initialize and release a bitmap obstack.  */
 extern void bitmap_obstack_initialize (bitmap_obstack *);
 extern void bitmap_obstack_release (bitmap_obstack *);
+extern void bitmap_obstack_set_hybrid (bitmap_obstack *, bool);
 extern void bitmap_register (bitmap MEM_STAT_DECL);
 extern void dump_bitmap_statistics (void);
 
@@ -339,6 +363,7 @@ bitmap_initialize_stat (bitmap head, bitmap_obstack *obstack MEM_STAT_DECL)
 {
   head->first = head->current = NULL;
   head->obstack = obstack;
+  head->dense_base = head->dense_len = 0;
   if (GATHER_STATISTICS)
     bitmap_register (head PASS_MEM_STAT);
 }
@@ -507,6 +507,10 @@ c_common_handle_option (size_t scode, const char *arg, int value,
       cpp_opts->wide_charset = arg;
       break;
 
+    case OPT_finclude_cache_:
+      cpp_opts->include_cache = arg;
+      break;
+
     case OPT_finput_charset_:
       cpp_opts->input_charset = arg;
       break;
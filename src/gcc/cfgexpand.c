@@ -73,6 +73,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "builtins.h"
 #include "tree-chkp.h"
 #include "rtl-chkp.h"
+#include "compile-cache.h"
 
 /* Some systems use __main in a way incompatible with its use in gcc, in these
    cases use the macros NAME__MAIN to give a quoted symbol and SYMBOL__MAIN to
@@ -6118,6 +6119,14 @@ public:
   {}
 
   /* opt_pass methods: */
+  virtual bool gate (function *fun)
+    {
+      /* The assembly of the function may have been taken from the
+	 compile cache, or its expansion deferred by the parallel back
+	 end.  */
+      return !compile_cache_hit_p () && !compile_cache_deferred_p (fun->decl);
+    }
+
   virtual unsigned int execute (function *);
 
 }; // class pass_expand
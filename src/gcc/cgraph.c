@@ -62,6 +62,7 @@ along with GCC; see the file COPYING3.  If not see
 
 /* FIXME: Only for PROP_loops, but cgraph shouldn't have to know about this.  */
 #include "tree-pass.h"
+#include "compile-cache.h"
 
 /* Queue of cgraph nodes scheduled to be lowered.  */
 symtab_node *x_cgraph_nodes_queue;
@@ -1972,7 +1973,10 @@ cgraph_node::rtl_info (tree decl)
   if (decl != current_function_decl
       && (avail < AVAIL_AVAILABLE
 	  || (node->decl != current_function_decl
-	      && !TREE_ASM_WRITTEN (node->decl))))
+	      && (!TREE_ASM_WRITTEN (node->decl)
+		  /* The parallel back end compiles the functions in an
+		     order that the RTL passes cannot see.  */
+		  || compile_cache_parallel_p ()))))
     return NULL;
   /* Allocate if it doesn't exist.  */
   if (node->rtl == NULL)
@@ -995,6 +995,10 @@ public:
   /* Expand function specified by node.  */
   void expand (void);
 
+  /* Complete the expansion of the function, whose RTL passes were
+     deferred by the parallel back end.  */
+  void expand_deferred (void);
+
   /* As an GCC extension we allow redefinition of the function.  The
      semantics when both copies of bodies differ is not well defined.
      We replace the old body with new body so in unit at a time mode
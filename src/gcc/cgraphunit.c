@@ -203,6 +203,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "dbgcnt.h"
 #include "tree-chkp.h"
 #include "lto-section-names.h"
+#include "compile-cache.h"
 
 /* Queue of cgraph nodes scheduled to be added into cgraph.  This is a
    secondary queue used during optimization to accommodate passes that
@@ -1948,54 +1949,19 @@ cgraph_node::assemble_thunks_and_aliases (void)
     }
 }
 
-/* Expand function specified by node.  */
+/* Finish the expansion of NODE once all passes have run on its body,
+   and restore SAVED_LOC as the input location.  */
 
-void
-cgraph_node::expand (void)
+static void
+finish_expansion (cgraph_node *node, location_t saved_loc)
 {
-  location_t saved_loc;
-
-  /* We ought to not compile any inline clones.  */
-  gcc_assert (!global.inlined_to);
-
-  announce_function (decl);
-  process = 0;
-  gcc_assert (lowered);
-  get_untransformed_body ();
-
-  /* Generate RTL for the body of DECL.  */
-
-  timevar_push (TV_REST_OF_COMPILATION);
-
-  gcc_assert (symtab->global_info_ready);
-
-  /* Initialize the default bitmap obstack.  */
-  bitmap_obstack_initialize (NULL);
-
-  /* Initialize the RTL code for the function.  */
-  saved_loc = input_location;
-  input_location = DECL_SOURCE_LOCATION (decl);
-
-  gcc_assert (DECL_STRUCT_FUNCTION (decl));
-  push_cfun (DECL_STRUCT_FUNCTION (decl));
-  init_function_start (decl);
-
-  gimple_register_cfg_hooks ();
-
-  bitmap_obstack_initialize (&reg_obstack); /* FIXME, only at RTL generation*/
-
-  execute_all_ipa_transforms ();
-
-  /* Perform all tree transforms and optimizations.  */
-
-  /* Signal the start of passes.  */
-  invoke_plugin_callbacks (PLUGIN_ALL_PASSES_START, NULL);
-
-  execute_pass_list (cfun, g->get_passes ()->all_passes);
+  tree decl = node->decl;
 
   /* Signal the end of passes.  */
   invoke_plugin_callbacks (PLUGIN_ALL_PASSES_END, NULL);
 
+  compile_cache_finish_function ();
+
   bitmap_obstack_release (&reg_obstack);
 
   /* Release the default bitmap obstack.  */
@@ -2054,12 +2020,96 @@ cgraph_node::expand (void)
      make one pass assemblers, like one on AIX, happy.  See PR 50689.
      FIXME: Perhaps thunks should be move before function IFF they are not in comdat
      groups.  */
-  assemble_thunks_and_aliases ();
-  release_body ();
+  node->assemble_thunks_and_aliases ();
+  node->release_body ();
   /* Eliminate all call edges.  This is important so the GIMPLE_CALL no longer
      points to the dead function body.  */
-  remove_callees ();
-  remove_all_references ();
+  node->remove_callees ();
+  node->remove_all_references ();
+}
+
+/* Expand function specified by node.  */
+
+void
+cgraph_node::expand (void)
+{
+  location_t saved_loc;
+
+  /* We ought to not compile any inline clones.  */
+  gcc_assert (!global.inlined_to);
+
+  announce_function (decl);
+  process = 0;
+  gcc_assert (lowered);
+  get_untransformed_body ();
+
+  /* Generate RTL for the body of DECL.  */
+
+  timevar_push (TV_REST_OF_COMPILATION);
+
+  gcc_assert (symtab->global_info_ready);
+
+  /* Initialize the default bitmap obstack.  */
+  bitmap_obstack_initialize (NULL);
+
+  /* Initialize the RTL code for the function.  */
+  saved_loc = input_location;
+  input_location = DECL_SOURCE_LOCATION (decl);
+
+  gcc_assert (DECL_STRUCT_FUNCTION (decl));
+  push_cfun (DECL_STRUCT_FUNCTION (decl));
+  init_function_start (decl);
+
+  gimple_register_cfg_hooks ();
+
+  bitmap_obstack_initialize (&reg_obstack); /* FIXME, only at RTL generation*/
+
+  execute_all_ipa_transforms ();
+
+  /* Perform all tree transforms and optimizations.  */
+
+  /* Signal the start of passes.  */
+  invoke_plugin_callbacks (PLUGIN_ALL_PASSES_START, NULL);
+
+  execute_pass_list (cfun, g->get_passes ()->all_passes);
+
+  /* The parallel back end may stop before the RTL passes, leaving the
+     body and the default bitmap obstack for expand_deferred.  */
+  if (compile_cache_deferred_p (decl))
+    {
+      bitmap_obstack_release (&reg_obstack);
+      input_location = saved_loc;
+      timevar_pop (TV_REST_OF_COMPILATION);
+      pop_cfun ();
+      return;
+    }
+
+  finish_expansion (this, saved_loc);
+}
+
+/* Complete the expansion of the function, whose RTL passes were
+   deferred by the parallel back end.  */
+
+void
+cgraph_node::expand_deferred (void)
+{
+  location_t saved_loc;
+
+  timevar_push (TV_REST_OF_COMPILATION);
+
+  saved_loc = input_location;
+  input_location = DECL_SOURCE_LOCATION (decl);
+
+  push_cfun (DECL_STRUCT_FUNCTION (decl));
+  reinit_function_start (decl);
+
+  gimple_register_cfg_hooks ();
+
+  bitmap_obstack_initialize (&reg_obstack);
+
+  execute_pass_list (cfun, compile_cache_resume_passes ());
+
+  finish_expansion (this, saved_loc);
 }
 
 /* Node comparer that is responsible for the order that corresponds
@@ -2098,6 +2148,7 @@ expand_all_functions (void)
 					 symtab->cgraph_count);
   unsigned int expanded_func_count = 0, profiled_func_count = 0;
   int order_pos, new_order_pos = 0;
+  bool parallel;
   int i;
 
   order_pos = ipa_reverse_postorder (order);
@@ -2112,6 +2163,10 @@ expand_all_functions (void)
   if (flag_profile_reorder_functions)
     qsort (order, new_order_pos, sizeof (cgraph_node *), node_cmp);
 
+  /* With -fparallel-backend, the loop below only runs the GIMPLE passes,
+     and the RTL passes are run afterwards by forked workers.  */
+  parallel = compile_cache_begin_parallel ();
+
   for (i = new_order_pos - 1; i >= 0; i--)
     {
       node = order[i];
@@ -2139,6 +2194,9 @@ expand_all_functions (void)
     fprintf (symtab->dump_file, "Expanded functions with time profile:%u/%u\n",
              profiled_func_count, expanded_func_count);
 
+  if (parallel)
+    compile_cache_finish_parallel ();
+
   symtab->process_new_functions ();
   free_gimplify_stack ();
 
@@ -0,0 +1,1963 @@
+/* Cache of the assembly generated for individual functions.
+   Copyright (C) 2016 Free Software Foundation, Inc.
+
+This file is part of GCC.
+
+GCC is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free
+Software Foundation; either version 3, or (at your option) any later
+version.
+
+GCC is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with GCC; see the file COPYING3.  If not see
+<http://www.gnu.org/licenses/>.  */
+
+/* With -fcompile-cache=<dir>, the assembly output for a function is
+   stored in <dir> under a key computed just before the function is
+   expanded to RTL.  A later compilation that computes the same key,
+   in the same or in another translation unit or LTRANS partition,
+   copies the stored assembly to its output and skips the RTL passes.
+
+   The key is an MD5 digest of
+
+     - the compiler version and the options that can affect code
+       generation, including the optimization and target options of
+       the function itself;
+     - the optimized GIMPLE body: the CFG with its profile, the loop
+       tree, every statement and the operands of statements, including
+       the points-to and value range information of SSA names;
+     - the layout of the types and the properties of the declarations
+       that the body refers to, and for global declarations also their
+       binding and, for read-only variables, their initializer;
+     - the summaries of the callees that the RTL passes read from
+       functions compiled earlier, like the registers they clobber
+       with -fipa-ra and the stack alignment they need.
+
+   Local declarations, types and SSA names are numbered in the order in
+   which the walk finds them, so that their UIDs do not leak into the
+   key.  The structural hashes of ipa-icf are deliberately lossy and are
+   only used to find candidates for a full comparison, so they cannot
+   be used here.
+
+   The assembly is recorded by directing asm_out_file to a temporary
+   file from the start of the expansion to the end of the function.
+   The recording starts in an unknown section and declares all named
+   sections in full, so that it can be copied anywhere.  It is only
+   stored if every local label it refers to is defined within it;
+   functions that refer to labels output on behalf of other functions,
+   such as shared constants or section anchors, are compiled as usual.
+   When a recording is replayed, its local labels are renamed so that
+   they do not clash with the labels of the rest of the file.
+
+   Functions with exception regions, nonlocal labels, setjmp calls or a
+   static chain are not cached, and neither are functions compiled with
+   debug information, -fstack-usage or frame tables that the assembler
+   does not build from CFI directives.  Functions for which the RTL
+   passes issue diagnostics are not stored, so that the diagnostics are
+   issued again by later compilations.  Entries are never removed by
+   the compiler, and the directory must be cleared when the compiler
+   itself is rebuilt from changed sources.
+
+   The same entries carry the output of the parallel back end.  With
+   -fparallel-backend=<n>, the GIMPLE passes are first run on all the
+   functions, whose bodies are kept, and their RTL passes are deferred.
+   The functions are then split, in the order in which they are output,
+   into up to <n> partitions of balanced size, counted in statements as
+   for the balanced LTO partitioning.  A worker is forked for each
+   partition but the first, which the compiler handles itself; the
+   worker records every function of its partition and streams the
+   entries to a temporary file.  The compiler then reads the entries
+   back and replays them when it reaches functions with the same key,
+   compiling those that no worker could record as usual.
+
+   Before the workers are forked, the variables that live in object
+   blocks are placed and their section anchors created, so that the
+   workers can refer to them; the anchors are not renamed when the
+   entries are replayed.  A function that places anything else in an
+   object block is compiled again.  The RTL passes do not use what they
+   recorded for the other functions while the parallel back end is in
+   use, so that the output does not depend on the order in which the
+   functions are compiled.  */
+
+#include "config.h"
+#include "system.h"
+#include "coretypes.h"
+#include "backend.h"
+#include "target.h"
+#include "rtl.h"
+#include "tree.h"
+#include "gimple.h"
+#include "tree-pass.h"
+#include "ssa.h"
+#include "cgraph.h"
+#include "emit-rtl.h"
+#include "diagnostic.h"
+#include "varasm.h"
+#include "output.h"
+#include "calls.h"
+#include "stor-layout.h"
+#include "gimple-iterator.h"
+#include "cfgloop.h"
+#include "debug.h"
+#include "dwarf2out.h"
+#include "opts.h"
+#include "toplev.h"
+#include "except.h"
+#include "md5.h"
+#include "version.h"
+#include "params.h"
+#include "context.h"
+#include "dumpfile.h"
+#include "compile-cache.h"
+
+/* Whether the cache has been set up, and whether it can be used.  */
+static bool cache_initialized;
+static bool cache_usable;
+
+/* The digest of the compiler version and the command line, common to
+   all the functions of the translation unit.  */
+static unsigned char options_digest[16];
+
+/* The prefix of the local labels generated by the compiler.  */
+static const char *local_label_prefix;
+
+/* Number of recordings replayed so far, used to rename their labels.  */
+static unsigned replay_count;
+
+/* True if the assembly of the current function was replayed.  */
+static bool cache_hit;
+
+/* While the assembly of the current function is being recorded, the
+   file it goes to, the real output file and the key of the entry.  */
+static FILE *record_file;
+static FILE *saved_asm_out_file;
+static char *record_key;
+/* The value of trampolines_created when the recording started.  */
+static int saved_trampolines_created;
+/* The number of diagnostics issued before the recording started.  */
+static int saved_diagnostic_count;
+
+/* What a cache entry records besides the assembly: the effects of
+   compiling the function on the rest of the translation unit.  */
+struct entry_summary
+{
+  unsigned preferred_incoming_stack_boundary;
+  bool trampolines_created;
+  bool function_used_regs_valid;
+  HARD_REG_SET function_used_regs;
+};
+
+/* An entry streamed by a worker of the parallel back end.  */
+struct parallel_entry
+{
+  const char *text;
+  size_t len;
+  struct entry_summary summary;
+};
+
+/* Whether the parallel back end is in use, and whether the RTL passes
+   of the functions are being deferred.  */
+static bool parallel_active;
+static bool deferring;
+
+/* The functions whose RTL passes have been deferred, in order, and the
+   pass to resume them from.  */
+static vec<cgraph_node *> deferred_nodes;
+static hash_set<tree> *deferred_decls;
+static opt_pass *resume_pass;
+
+/* The local labels of the section anchors created before the workers
+   were forked.  */
+static hash_set<nofree_string_hash> *shared_labels;
+
+/* In a worker, the file its entries are streamed to, and the value of
+   object_block_changes when the recording started.  */
+static FILE *worker_stream;
+static int saved_object_block_changes;
+
+/* In the compiler, the entries streamed by the workers.  */
+static hash_map<nofree_string_hash, parallel_entry> *parallel_entries;
+
+/* State of the key computation.  */
+static struct md5_ctx key_ctx;
+/* Numbers of the declarations, types and SSA names seen so far.  */
+static hash_map<tree, unsigned> *key_ids;
+static unsigned key_next_id;
+/* Types whose layout has been added to the key, as opposed to those
+   only seen as targets of pointers.  */
+static hash_set<tree> *key_laid_out_types;
+/* Numbers of the DECL_PT_UIDs that points-to sets refer to.  */
+static hash_map<int_hash <unsigned, UINT_MAX>, unsigned> *key_pt_ids;
+/* SSA names whose points-to set is added at the end of the walk.  */
+static vec<tree> key_pt_names;
+/* Global declarations referred to by the body.  */
+static vec<tree> key_globals;
+/* Nonzero while walking the initializer of a global variable.  */
+static int key_in_initializer;
+/* Why the function cannot be cached, or NULL.  */
+static const char *key_failure;
+
+static void key_tree (tree);
+
+/* Mark the current function as not cacheable, for REASON.  */
+
+static void
+key_fail (const char *reason)
+{
+  if (!key_failure)
+    key_failure = reason;
+}
+
+/* Add LEN bytes at P to the key.  */
+
+static void
+key_bytes (const void *p, size_t len)
+{
+  md5_process_bytes (p, len, &key_ctx);
+}
+
+/* Add the integer X to the key.  */
+
+static void
+key_int (HOST_WIDE_INT x)
+{
+  key_bytes (&x, sizeof (x));
+}
+
+/* Add the string S to the key.  */
+
+static void
+key_string (const char *s)
+{
+  if (s == NULL)
+    {
+      key_int (-1);
+      return;
+    }
+  key_int (strlen (s));
+  key_bytes (s, strlen (s));
+}
+
+/* Add the wide integer W to the key.  */
+
+template <typename T>
+static void
+key_wide_int (const T &w)
+{
+  unsigned int i;
+
+  key_int (w.get_len ());
+  for (i = 0; i < w.get_len (); i++)
+    key_int (w.elt (i));
+}
+
+/* If T was numbered before, add its number to the key and return true.
+   Otherwise number T, add that to the key and return false.  */
+
+static bool
+key_seen_p (tree t)
+{
+  bool existed;
+  unsigned &id = key_ids->get_or_insert (t, &existed);
+
+  if (!existed)
+    id = key_next_id++;
+  key_int (existed);
+  key_int (id);
+  return existed;
+}
+
+/* Add the optimization and target options of function DECL to the
+   key.  */
+
+static void
+key_function_options (tree decl)
+{
+  tree opts = DECL_FUNCTION_SPECIFIC_OPTIMIZATION (decl);
+  tree target_opts = DECL_FUNCTION_SPECIFIC_TARGET (decl);
+
+  if (opts == NULL_TREE)
+    opts = optimization_default_node;
+  if (target_opts == NULL_TREE)
+    target_opts = target_option_default_node;
+  key_bytes (TREE_OPTIMIZATION (opts), sizeof (struct cl_optimization));
+  if (target_opts)
+    key_bytes (TREE_TARGET_OPTION (target_opts),
+	       sizeof (struct cl_target_option));
+}
+
+/* Add type T to the key.  Only add its layout if LAID_OUT; types that
+   are just pointed to contribute only their identity.  */
+
+static void
+key_type (tree t, bool laid_out)
+{
+  tree f;
+
+  if (t == NULL_TREE)
+    {
+      key_int (-1);
+      return;
+    }
+  if (!key_seen_p (t))
+    {
+      key_int (TREE_CODE (t));
+      key_int (TYPE_QUALS (t));
+      key_type (TYPE_MAIN_VARIANT (t) == t ? NULL_TREE : TYPE_MAIN_VARIANT (t),
+		false);
+      key_int (TYPE_STRUCTURAL_EQUALITY_P (t));
+      key_type (TYPE_CANONICAL (t) == t ? NULL_TREE : TYPE_CANONICAL (t),
+		false);
+    }
+  if (!laid_out || key_laid_out_types->add (t))
+    return;
+
+  key_int (-2);
+  key_int (TYPE_MODE (t));
+  key_int (TYPE_ALIGN (t));
+  key_int (TYPE_USER_ALIGN (t));
+  key_int (TYPE_UNSIGNED (t));
+  key_int (TYPE_PRECISION (t));
+  key_int (TYPE_PACKED (t));
+  key_int (TYPE_STRING_FLAG (t));
+  key_int (TYPE_NO_FORCE_BLK (t));
+  key_int (TYPE_SATURATING (t));
+  key_int (TREE_ADDRESSABLE (t));
+  key_tree (TYPE_SIZE (t));
+  key_tree (TYPE_SIZE_UNIT (t));
+  key_tree (TYPE_ATTRIBUTES (t));
+
+  switch (TREE_CODE (t))
+    {
+    case INTEGER_TYPE:
+    case ENUMERAL_TYPE:
+    case BOOLEAN_TYPE:
+      key_tree (TYPE_MIN_VALUE (t));
+      key_tree (TYPE_MAX_VALUE (t));
+      break;
+
+    case REAL_TYPE:
+    case FIXED_POINT_TYPE:
+    case VOID_TYPE:
+    case NULLPTR_TYPE:
+    case POINTER_BOUNDS_TYPE:
+      break;
+
+    case POINTER_TYPE:
+    case REFERENCE_TYPE:
+      key_int (TYPE_REF_CAN_ALIAS_ALL (t));
+      key_type (TREE_TYPE (t), false);
+      break;
+
+    case OFFSET_TYPE:
+      key_type (TREE_TYPE (t), false);
+      key_type (TYPE_OFFSET_BASETYPE (t), false);
+      break;
+
+    case ARRAY_TYPE:
+      key_int (TYPE_NONALIASED_COMPONENT (t));
+      key_int (TYPE_REVERSE_STORAGE_ORDER (t));
+      key_type (TREE_TYPE (t), true);
+      key_type (TYPE_DOMAIN (t), true);
+      break;
+
+    case VECTOR_TYPE:
+      key_int (TYPE_VECTOR_SUBPARTS (t));
+      key_type (TREE_TYPE (t), true);
+      break;
+
+    case COMPLEX_TYPE:
+      key_type (TREE_TYPE (t), true);
+      break;
+
+    case RECORD_TYPE:
+    case UNION_TYPE:
+    case QUAL_UNION_TYPE:
+      key_int (TYPE_TRANSPARENT_AGGR (t));
+      key_int (TYPE_REVERSE_STORAGE_ORDER (t));
+      for (f = TYPE_FIELDS (t); f; f = DECL_CHAIN (f))
+	if (TREE_CODE (f) == FIELD_DECL)
+	  key_tree (f);
+      key_int (-3);
+      break;
+
+    case FUNCTION_TYPE:
+    case METHOD_TYPE:
+      key_type (TREE_TYPE (t), true);
+      for (f = TYPE_ARG_TYPES (t); f; f = TREE_CHAIN (f))
+	key_type (TREE_VALUE (f), true);
+      key_int (-3);
+      if (TREE_CODE (t) == METHOD_TYPE)
+	key_type (TYPE_METHOD_BASETYPE (t), false);
+      break;
+
+    default:
+      key_fail ("type");
+      break;
+    }
+}
+
+/* Add what the RTL passes of the current function may use of the
+   function DECL, which has been compiled before or is still to be
+   compiled, to the key.  */
+
+static void
+key_callee (tree decl)
+{
+  cgraph_node *node = cgraph_node::get (decl);
+  struct cgraph_rtl_info *info = NULL;
+
+  if (node == NULL)
+    {
+      key_int (-1);
+      return;
+    }
+  key_int (node->local.local);
+  key_int (node->local.can_change_signature);
+  node = node->ultimate_alias_target ();
+  if (TREE_ASM_WRITTEN (node->decl) && !parallel_active)
+    info = node->rtl;
+  key_int (info ? info->preferred_incoming_stack_boundary : 0);
+  key_int (info && info->function_used_regs_valid);
+  if (info && info->function_used_regs_valid)
+    key_bytes (&info->function_used_regs, sizeof (HARD_REG_SET));
+}
+
+/* Add the global variable or function DECL to the key.  */
+
+static void
+key_global_decl (tree decl)
+{
+  symtab_node *snode = symtab_node::get (decl);
+  tree init;
+
+  if (!key_in_initializer)
+    key_globals.safe_push (decl);
+  key_string (IDENTIFIER_POINTER (DECL_ASSEMBLER_NAME (decl)));
+  key_int (TREE_PUBLIC (decl));
+  key_int (DECL_EXTERNAL (decl));
+  key_int (TREE_STATIC (decl));
+  key_int (DECL_WEAK (decl));
+  key_int (DECL_COMMON (decl));
+  key_int (DECL_COMDAT (decl));
+  key_int (DECL_VISIBILITY (decl));
+  key_int (DECL_VISIBILITY_SPECIFIED (decl));
+  key_int (DECL_PRESERVE_P (decl));
+  key_int (DECL_DLLIMPORT_P (decl));
+  key_string (DECL_SECTION_NAME (decl));
+  key_tree (snode ? snode->get_comdat_group () : NULL_TREE);
+  key_int (targetm.binds_local_p (decl));
+  key_int (decl_binds_to_current_def_p (decl));
+
+  if (TREE_CODE (decl) == FUNCTION_DECL)
+    {
+      key_int (flags_from_decl_or_type (decl));
+      key_int (DECL_BUILT_IN_CLASS (decl));
+      if (DECL_BUILT_IN (decl))
+	key_int (DECL_FUNCTION_CODE (decl));
+      key_int (DECL_STATIC_CHAIN (decl));
+      key_int (DECL_NO_INSTRUMENT_FUNCTION_ENTRY_EXIT (decl));
+      key_int (DECL_NO_LIMIT_STACK (decl));
+      key_function_options (decl);
+      key_callee (decl);
+      return;
+    }
+
+  key_int (DECL_HARD_REGISTER (decl));
+  key_int (DECL_THREAD_LOCAL_P (decl) ? DECL_TLS_MODEL (decl) : -1);
+  key_int (DECL_IN_CONSTANT_POOL (decl));
+  key_int (DECL_IN_TEXT_SECTION (decl));
+  key_int (targetm.in_small_data_p (decl));
+
+  /* Loads from read-only variables may be folded.  */
+  if (TREE_READONLY (decl) && !TREE_THIS_VOLATILE (decl)
+      && (init = ctor_for_folding (decl)) != error_mark_node)
+    {
+      key_in_initializer++;
+      key_tree (init);
+      key_in_initializer--;
+    }
+  else
+    key_int (-1);
+}
+
+/* Add declaration DECL to the key.  */
+
+static void
+key_decl (tree decl)
+{
+  bool existed;
+  enum tree_code code = TREE_CODE (decl);
+
+  if (key_seen_p (decl))
+    return;
+
+  key_int (code);
+  key_int (DECL_MODE (decl));
+  switch (code)
+    {
+    case LABEL_DECL:
+      if (FORCED_LABEL (decl) || DECL_NONLOCAL (decl))
+	key_fail ("label whose address is taken");
+      return;
+
+    case CONST_DECL:
+      key_type (TREE_TYPE (decl), true);
+      key_tree (DECL_INITIAL (decl));
+      return;
+
+    case FIELD_DECL:
+      key_type (TREE_TYPE (decl), true);
+      key_tree (DECL_FIELD_OFFSET (decl));
+      key_tree (DECL_FIELD_BIT_OFFSET (decl));
+      key_tree (DECL_SIZE (decl));
+      key_int (DECL_ALIGN (decl));
+      key_int (DECL_OFFSET_ALIGN (decl));
+      key_int (DECL_USER_ALIGN (decl));
+      key_int (DECL_PACKED (decl));
+      key_int (DECL_BIT_FIELD (decl));
+      key_int (DECL_NONADDRESSABLE_P (decl));
+      key_int (TREE_THIS_VOLATILE (decl));
+      key_type (DECL_BIT_FIELD_TYPE (decl), true);
+      key_tree (DECL_BIT_FIELD_REPRESENTATIVE (decl));
+      key_tree (DECL_QUALIFIER (decl));
+      return;
+
+    case VAR_DECL:
+    case PARM_DECL:
+    case RESULT_DECL:
+    case FUNCTION_DECL:
+      break;
+
+    default:
+      key_fail ("declaration");
+      return;
+    }
+
+  if (code != FUNCTION_DECL)
+    {
+      unsigned &id = key_pt_ids->get_or_insert (DECL_PT_UID (decl), &existed);
+      if (!existed)
+	id = *key_ids->get (decl);
+    }
+
+  key_type (TREE_TYPE (decl), true);
+  key_tree (DECL_SIZE (decl));
+  key_tree (DECL_SIZE_UNIT (decl));
+  key_int (DECL_ALIGN (decl));
+  key_int (DECL_USER_ALIGN (decl));
+  key_int (TREE_ADDRESSABLE (decl));
+  key_int (TREE_THIS_VOLATILE (decl));
+  key_int (TREE_READONLY (decl));
+  key_int (TREE_USED (decl));
+  key_int (DECL_ARTIFICIAL (decl));
+  key_int (DECL_IGNORED_P (decl));
+  key_tree (DECL_ATTRIBUTES (decl));
+
+  if (code == FUNCTION_DECL || is_global_var (decl))
+    {
+      key_global_decl (decl);
+      return;
+    }
+
+  key_int (DECL_REGISTER (decl));
+  key_int (DECL_BY_REFERENCE (decl));
+  key_int (DECL_GIMPLE_REG_P (decl));
+  key_int (DECL_NONLOCAL (decl));
+  if (code == VAR_DECL)
+    {
+      key_int (DECL_HARD_REGISTER (decl));
+      if (DECL_HARD_REGISTER (decl))
+	key_string (IDENTIFIER_POINTER (DECL_ASSEMBLER_NAME (decl)));
+    }
+  else if (code == PARM_DECL)
+    key_type (DECL_ARG_TYPE (decl), true);
+}
+
+/* Add SSA name NAME to the key.  */
+
+static void
+key_ssa_name (tree name)
+{
+  if (key_seen_p (name))
+    return;
+
+  key_type (TREE_TYPE (name), true);
+  key_tree (SSA_NAME_VAR (name));
+  key_int (SSA_NAME_IS_DEFAULT_DEF (name));
+  key_int (SSA_NAME_OCCURS_IN_ABNORMAL_PHI (name));
+  if (POINTER_TYPE_P (TREE_TYPE (name)))
+    {
+      struct ptr_info_def *pi = SSA_NAME_PTR_INFO (name);
+      unsigned int align, misalign;
+
+      key_int (pi != NULL);
+      if (pi)
+	{
+	  key_int (get_ptr_info_alignment (pi, &align, &misalign));
+	  key_int (align);
+	  key_int (misalign);
+	  key_pt_names.safe_push (name);
+	}
+    }
+  else if (SSA_NAME_RANGE_INFO (name))
+    {
+      wide_int min, max;
+      enum value_range_type type = get_range_info (name, &min, &max);
+
+      key_int (type);
+      if (type == VR_RANGE || type == VR_ANTI_RANGE)
+	{
+	  key_wide_int (min);
+	  key_wide_int (max);
+	}
+      key_wide_int (get_nonzero_bits (name));
+    }
+  else
+    key_int (-1);
+}
+
+/* Add constant T to the key.  */
+
+static void
+key_constant (tree t)
+{
+  unsigned i;
+
+  key_bytes (&t->base, sizeof (t->base));
+  key_type (TREE_TYPE (t), true);
+  switch (TREE_CODE (t))
+    {
+    case INTEGER_CST:
+      for (i = 0; i < (unsigned) TREE_INT_CST_NUNITS (t); i++)
+	key_int (TREE_INT_CST_ELT (t, i));
+      break;
+
+    case REAL_CST:
+      key_bytes (TREE_REAL_CST_PTR (t), sizeof (REAL_VALUE_TYPE));
+      break;
+
+    case FIXED_CST:
+      key_bytes (TREE_FIXED_CST_PTR (t), sizeof (FIXED_VALUE_TYPE));
+      break;
+
+    case COMPLEX_CST:
+      key_tree (TREE_REALPART (t));
+      key_tree (TREE_IMAGPART (t));
+      break;
+
+    case VECTOR_CST:
+      for (i = 0; i < VECTOR_CST_NELTS (t); i++)
+	key_tree (VECTOR_CST_ELT (t, i));
+      break;
+
+    case STRING_CST:
+      key_int (TREE_STRING_LENGTH (t));
+      key_bytes (TREE_STRING_POINTER (t), TREE_STRING_LENGTH (t));
+      break;
+
+    case VOID_CST:
+      break;
+
+    default:
+      key_fail ("constant");
+      break;
+    }
+}
+
+/* Add tree T, an operand of a statement or a part of one, to the key.  */
+
+static void
+key_tree (tree t)
+{
+  enum tree_code code;
+  unsigned HOST_WIDE_INT i;
+  tree value, index;
+  int n;
+
+  if (t == NULL_TREE)
+    {
+      key_int (-1);
+      return;
+    }
+
+  code = TREE_CODE (t);
+  switch (TREE_CODE_CLASS (code))
+    {
+    case tcc_type:
+      key_type (t, true);
+      return;
+
+    case tcc_declaration:
+      key_decl (t);
+      return;
+
+    case tcc_constant:
+      key_int (code);
+      key_constant (t);
+      return;
+
+    case tcc_exceptional:
+      key_int (code);
+      switch (code)
+	{
+	case SSA_NAME:
+	  key_ssa_name (t);
+	  break;
+
+	case IDENTIFIER_NODE:
+	  key_string (IDENTIFIER_POINTER (t));
+	  break;
+
+	case TREE_LIST:
+	  for (; t; t = TREE_CHAIN (t))
+	    {
+	      key_tree (TREE_PURPOSE (t));
+	      key_tree (TREE_VALUE (t));
+	    }
+	  key_int (-3);
+	  break;
+
+	case TREE_VEC:
+	  key_int (TREE_VEC_LENGTH (t));
+	  for (n = 0; n < TREE_VEC_LENGTH (t); n++)
+	    key_tree (TREE_VEC_ELT (t, n));
+	  break;
+
+	case CONSTRUCTOR:
+	  key_bytes (&t->base, sizeof (t->base));
+	  key_type (TREE_TYPE (t), true);
+	  key_int (CONSTRUCTOR_NELTS (t));
+	  FOR_EACH_CONSTRUCTOR_ELT (CONSTRUCTOR_ELTS (t), i, index, value)
+	    {
+	      key_tree (index);
+	      key_tree (value);
+	    }
+	  break;
+
+	default:
+	  key_fail ("tree");
+	  break;
+	}
+      return;
+
+    case tcc_statement:
+      /* Only the labels of switch statements are expected, and their
+	 chains are not part of the body.  */
+      key_int (code);
+      if (code != CASE_LABEL_EXPR)
+	{
+	  key_fail ("statement tree");
+	  return;
+	}
+      key_tree (CASE_LOW (t));
+      key_tree (CASE_HIGH (t));
+      key_tree (CASE_LABEL (t));
+      return;
+
+    default:
+      break;
+    }
+
+  /* An expression.  Its flags, including the dependence information of
+     memory references, are in the tree_base.  */
+  key_int (code);
+  key_bytes (&t->base, sizeof (t->base));
+  key_type (TREE_TYPE (t), true);
+  for (n = 0; n < TREE_OPERAND_LENGTH (t); n++)
+    key_tree (TREE_OPERAND (t, n));
+}
+
+/* Compare the unsigned integers at A and B, for qsort.  */
+
+static int
+compare_unsigned (const void *a, const void *b)
+{
+  unsigned x = *(const unsigned *) a;
+  unsigned y = *(const unsigned *) b;
+
+  return x < y ? -1 : x > y;
+}
+
+/* Add the points-to solution PT to the key.  The variables are added
+   by the numbers of their declarations if the body refers to them, and
+   otherwise by numbers in the order of their first appearance, which
+   keeps the relations between the sets.  */
+
+static void
+key_pt_solution (struct pt_solution *pt)
+{
+  auto_vec<unsigned> ids;
+  bitmap_iterator bi;
+  unsigned uid;
+  bool existed;
+
+  key_int (pt->anything);
+  key_int (pt->nonlocal);
+  key_int (pt->escaped);
+  key_int (pt->ipa_escaped);
+  key_int (pt->null);
+  key_int (pt->vars_contains_nonlocal);
+  key_int (pt->vars_contains_escaped);
+  key_int (pt->vars_contains_escaped_heap);
+  if (pt->vars == NULL)
+    {
+      key_int (-1);
+      return;
+    }
+  EXECUTE_IF_SET_IN_BITMAP (pt->vars, 0, uid, bi)
+    {
+      unsigned &id = key_pt_ids->get_or_insert (uid, &existed);
+      if (!existed)
+	id = key_next_id++;
+      ids.safe_push (id);
+    }
+  ids.qsort (compare_unsigned);
+  key_int (ids.length ());
+  key_bytes (ids.address (), ids.length () * sizeof (unsigned));
+}
+
+/* Add statement STMT to the key.  */
+
+static void
+key_stmt (gimple *stmt)
+{
+  enum gimple_code code = gimple_code (stmt);
+  unsigned i;
+
+  switch (code)
+    {
+    case GIMPLE_DEBUG:
+      /* Debug statements do not change the generated code.  */
+      return;
+
+    case GIMPLE_ASSIGN:
+    case GIMPLE_CALL:
+    case GIMPLE_COND:
+    case GIMPLE_SWITCH:
+    case GIMPLE_LABEL:
+    case GIMPLE_GOTO:
+    case GIMPLE_RETURN:
+    case GIMPLE_ASM:
+    case GIMPLE_NOP:
+    case GIMPLE_PREDICT:
+      break;
+
+    default:
+      key_fail ("statement");
+      return;
+    }
+
+  key_int (code);
+  key_int (stmt->subcode);
+  key_int (stmt->nontemporal_move);
+  key_int (gimple_has_volatile_ops (stmt));
+  key_tree (gimple_vuse (stmt));
+  key_tree (gimple_vdef (stmt));
+
+  if (code == GIMPLE_CALL)
+    {
+      if (gimple_call_internal_p (stmt))
+	key_int (gimple_call_internal_fn (stmt));
+      else
+	key_type (gimple_call_fntype (stmt), true);
+      key_int (gimple_call_flags (stmt));
+    }
+  else if (code == GIMPLE_ASM)
+    {
+      gasm *asm_stmt = as_a <gasm *> (stmt);
+
+      /* The operands are chained lists; add them one by one.  */
+      key_string (gimple_asm_string (asm_stmt));
+      key_int (gimple_asm_ninputs (asm_stmt));
+      key_int (gimple_asm_noutputs (asm_stmt));
+      key_int (gimple_asm_nclobbers (asm_stmt));
+      key_int (gimple_asm_nlabels (asm_stmt));
+      for (i = 0; i < gimple_num_ops (stmt); i++)
+	{
+	  tree op = gimple_op (stmt, i);
+	  key_tree (TREE_PURPOSE (op));
+	  key_tree (TREE_VALUE (op));
+	}
+      return;
+    }
+
+  key_int (gimple_num_ops (stmt));
+  for (i = 0; i < gimple_num_ops (stmt); i++)
+    key_tree (gimple_op (stmt, i));
+}
+
+/* Add the body of function FN, its declarations and its CFG to the
+   key.  */
+
+static void
+key_function_body (function *fn)
+{
+  int *order = XNEWVEC (int, last_basic_block_for_fn (fn));
+  basic_block bb;
+  gimple_stmt_iterator gsi;
+  gphi_iterator psi;
+  struct loop *loop;
+  edge_iterator ei;
+  unsigned ix, i;
+  edge e;
+  tree var;
+  int n = 0;
+
+  for (var = DECL_ARGUMENTS (fn->decl); var; var = DECL_CHAIN (var))
+    key_tree (var);
+  key_tree (DECL_RESULT (fn->decl));
+  FOR_EACH_LOCAL_DECL (fn, ix, var)
+    key_tree (var);
+  key_int (-3);
+
+  FOR_ALL_BB_FN (bb, fn)
+    order[bb->index] = n++;
+
+  FOR_ALL_BB_FN (bb, fn)
+    {
+      key_int (-4);
+      key_int (bb->frequency);
+      key_int (bb->count);
+      key_int (bb->flags & (BB_IRREDUCIBLE_LOOP | BB_HOT_PARTITION
+			    | BB_COLD_PARTITION | BB_NON_LOCAL_GOTO_TARGET
+			    | BB_IN_TRANSACTION | BB_DISABLE_SCHEDULE));
+      key_int (bb->loop_father ? bb->loop_father->num : -1);
+      FOR_EACH_EDGE (e, ei, bb->preds)
+	key_int (order[e->src->index]);
+      key_int (-3);
+      FOR_EACH_EDGE (e, ei, bb->succs)
+	{
+	  key_int (order[e->dest->index]);
+	  key_int (e->flags & ~(EDGE_EXECUTABLE | EDGE_DFS_BACK));
+	  key_int (e->probability);
+	  key_int (e->count);
+	}
+      key_int (-3);
+      if (bb == ENTRY_BLOCK_PTR_FOR_FN (fn) || bb == EXIT_BLOCK_PTR_FOR_FN (fn))
+	continue;
+
+      for (psi = gsi_start_phis (bb); !gsi_end_p (psi); gsi_next (&psi))
+	{
+	  gphi *phi = psi.phi ();
+
+	  key_int (-5);
+	  key_tree (gimple_phi_result (phi));
+	  for (i = 0; i < gimple_phi_num_args (phi); i++)
+	    key_tree (gimple_phi_arg_def (phi, i));
+	}
+      for (gsi = gsi_start_bb (bb); !gsi_end_p (gsi); gsi_next (&gsi))
+	key_stmt (gsi_stmt (gsi));
+    }
+
+  if (loops_for_fn (fn))
+    {
+      key_int (loops_for_fn (fn)->state);
+      FOR_EACH_LOOP (loop, 0)
+	{
+	  key_int (loop->num);
+	  key_int (loop_outer (loop) ? loop_outer (loop)->num : -1);
+	  key_int (loop->header ? order[loop->header->index] : -1);
+	  key_int (loop->latch ? order[loop->latch->index] : -1);
+	  key_int (loop->any_upper_bound);
+	  if (loop->any_upper_bound)
+	    key_wide_int (loop->nb_iterations_upper_bound);
+	  key_int (loop->any_estimate);
+	  if (loop->any_estimate)
+	    key_wide_int (loop->nb_iterations_estimate);
+	  key_int (loop->safelen);
+	  key_int (loop->can_be_parallel);
+	  key_int (loop->dont_vectorize);
+	  key_int (loop->force_vectorize);
+	  key_tree (loop->simduid);
+	}
+    }
+  key_int (-3);
+
+  XDELETEVEC (order);
+}
+
+/* Return the key of the current function, or NULL if it cannot be
+   cached.  */
+
+static char *
+compute_key (function *fn)
+{
+  tree decl = fn->decl;
+  cgraph_node *node = cgraph_node::get (decl);
+  unsigned char digest[16];
+  char *key;
+  unsigned i;
+
+  key_failure = NULL;
+  if (fn->calls_setjmp)
+    key_fail ("calls setjmp");
+  else if (fn->has_nonlocal_label || fn->nonlocal_goto_save_area)
+    key_fail ("has nonlocal labels");
+  else if (fn->has_forced_label_in_static)
+    key_fail ("label whose address is taken");
+  else if (fn->static_chain_decl || DECL_STATIC_CHAIN (decl))
+    key_fail ("has a static chain");
+  else if (fn->eh->region_tree)
+    key_fail ("has exception regions");
+  else if (fn->is_cilk_function || fn->calls_cilk_spawn)
+    key_fail ("Cilk Plus function");
+  if (key_failure)
+    return NULL;
+
+  md5_init_ctx (&key_ctx);
+  key_bytes (options_digest, sizeof (options_digest));
+  key_ids = new hash_map<tree, unsigned>;
+  key_laid_out_types = new hash_set<tree>;
+  key_pt_ids = new hash_map<int_hash <unsigned, UINT_MAX>, unsigned>;
+  key_next_id = 0;
+  key_globals.truncate (0);
+
+  /* The function itself and what decides where and how it is output.  */
+  key_tree (decl);
+  key_int (node->frequency);
+  key_int (node->only_called_at_startup);
+  key_int (node->only_called_at_exit);
+  key_int (node->definition_alignment ());
+  key_int (DECL_STATIC_CONSTRUCTOR (decl)
+	   ? decl_init_priority_lookup (decl) : -1);
+  key_int (DECL_STATIC_DESTRUCTOR (decl)
+	   ? decl_fini_priority_lookup (decl) : -1);
+
+  key_int (fn->curr_properties);
+  key_int (fn->last_clique);
+  key_int (fn->va_list_gpr_size);
+  key_int (fn->va_list_fpr_size);
+  key_int (fn->calls_alloca);
+  key_int (fn->cannot_be_copied_set);
+  key_int (fn->stdarg);
+  key_int (fn->after_inlining);
+  key_int (fn->can_throw_non_call_exceptions);
+  key_int (fn->can_delete_dead_exceptions);
+  key_int (fn->returns_struct);
+  key_int (fn->returns_pcc_struct);
+  key_int (fn->has_local_explicit_reg_vars);
+  key_int (fn->is_thunk);
+  key_int (fn->has_force_vectorize_loops);
+  key_int (fn->has_simduid_loops);
+  key_int (fn->tail_call_marked);
+
+  key_function_body (fn);
+
+  /* The points-to sets, now that the declarations have their numbers.  */
+  key_int (fn->gimple_df->ipa_pta);
+  key_pt_solution (&fn->gimple_df->escaped);
+  key_pt_solution (&ipa_escaped_pt);
+  for (i = 0; i < key_pt_names.length (); i++)
+    key_pt_solution (&SSA_NAME_PTR_INFO (key_pt_names[i])->pt);
+
+  key_pt_names.release ();
+  delete key_pt_ids;
+  delete key_laid_out_types;
+  delete key_ids;
+  md5_finish_ctx (&key_ctx, digest);
+  if (key_failure)
+    return NULL;
+
+  key = XNEWVEC (char, 2 * sizeof (digest) + 1);
+  for (i = 0; i < sizeof (digest); i++)
+    sprintf (key + 2 * i, "%02x", digest[i]);
+  return key;
+}
+
+/* Compute the digest of the compiler version and of the options that
+   may change the generated code.  */
+
+static void
+compute_options_digest (void)
+{
+  unsigned i;
+
+  md5_init_ctx (&key_ctx);
+  key_string (version_string);
+  key_string (pkgversion_string);
+  key_string (TARGET_NAME);
+  for (i = 0; i < save_decoded_options_count; i++)
+    {
+      struct cl_decoded_option *opt = &save_decoded_options[i];
+      const struct cl_option *option = &cl_options[opt->opt_index];
+
+      if (!(option->flags & (CL_COMMON | CL_TARGET))
+	  || (option->flags & CL_WARNING))
+	continue;
+      switch (opt->opt_index)
+	{
+	case OPT_o:
+	case OPT_quiet:
+	case OPT_auxbase:
+	case OPT_auxbase_strip:
+	case OPT_dumpbase:
+	case OPT_dumpdir:
+	case OPT_fdump_:
+	case OPT_fcompile_cache_:
+	case OPT_fparallel_backend_:
+	case OPT_fltrans_output_list_:
+	case OPT_fresolution_:
+	case OPT_ftime_report:
+	case OPT_fmem_report:
+	case OPT_fdiagnostics_color_:
+	case OPT_fdiagnostics_show_caret:
+	case OPT_fdiagnostics_show_location_:
+	case OPT_fdiagnostics_show_option:
+	case OPT_fmessage_length_:
+	  /* These name files or only change diagnostics and reports.  */
+	  continue;
+
+	default:
+	  break;
+	}
+      key_string (option->opt_text);
+      key_string (opt->arg);
+      key_int (opt->value);
+    }
+  md5_finish_ctx (&key_ctx, options_digest);
+}
+
+/* Set up the cache, for itself or for the parallel back end.  Return
+   false if it cannot be used with the current options, after saying
+   why.  */
+
+static bool
+init_compile_cache (void)
+{
+  const char *dir = flag_compile_cache;
+  const char *option
+    = parallel_active ? "-fparallel-backend" : "-fcompile-cache";
+  char label[64];
+  struct stat st;
+
+  if (cache_initialized)
+    return cache_usable;
+  cache_initialized = true;
+
+  if (asm_out_file == NULL)
+    return false;
+  if (debug_info_level > DINFO_LEVEL_NONE)
+    {
+      warning (0, "%qs is not used with debug information", option);
+      return false;
+    }
+  if (flag_stack_usage_info || flag_dump_final_insns || flag_check_pointer_bounds
+      || (dwarf2out_do_frame () && !dwarf2out_do_cfi_asm ()))
+    {
+      warning (0, "%qs cannot be used with these options", option);
+      return false;
+    }
+
+  /* Find the prefix of local labels, ".L" for ELF.  */
+  ASM_GENERATE_INTERNAL_LABEL (label, "L", 7);
+  if (label[0] == '*')
+    memmove (label, label + 1, strlen (label));
+  if (strlen (label) < 2 || strcmp (label + strlen (label) - 2, "L7") != 0)
+    {
+      warning (0, "%qs is not supported for this target", option);
+      return false;
+    }
+  label[strlen (label) - 1] = '\0';
+  local_label_prefix = xstrdup (label);
+
+  /* The parallel back end can do without the directory.  */
+  if (dir != NULL
+      && stat (dir, &st) != 0 && mkdir (dir, 0777) != 0 && errno != EEXIST)
+    {
+      warning (0, "cannot create compile cache directory %s: %m", dir);
+      dir = NULL;
+    }
+  else if (dir != NULL
+	   && (stat (dir, &st) != 0 || !S_ISDIR (st.st_mode)
+	       || access (dir, R_OK | W_OK | X_OK) != 0))
+    {
+      warning (0, "compile cache %s is not a writable directory", dir);
+      dir = NULL;
+    }
+  flag_compile_cache = dir;
+  if (dir == NULL && !parallel_active)
+    return false;
+
+  compute_options_digest ();
+  cache_usable = true;
+  return true;
+}
+
+/* Return the file name of the cache entry for KEY.  Entries are spread
+   over subdirectories named after the first two digits of the key.  */
+
+static char *
+cache_entry_name (const char *key)
+{
+  char subdir[3] = { key[0], key[1], '\0' };
+
+  return concat (flag_compile_cache, "/", subdir, "/", key + 2, ".s", NULL);
+}
+
+/* Read the whole of the file F.  Return the contents and set *LEN, or
+   return NULL if the file cannot be read.  */
+
+static char *
+read_file (FILE *f, size_t *len)
+{
+  char *buf;
+  long size;
+
+  if (fseek (f, 0, SEEK_END) != 0 || (size = ftell (f)) < 0
+      || fseek (f, 0, SEEK_SET) != 0)
+    return NULL;
+  buf = XNEWVEC (char, size + 1);
+  if (fread (buf, 1, size, f) != (size_t) size)
+    {
+      XDELETEVEC (buf);
+      return NULL;
+    }
+  buf[size] = '\0';
+  *len = size;
+  return buf;
+}
+
+/* Return true if C may be part of a local label.  */
+
+static inline bool
+label_char_p (char c)
+{
+  return ISALNUM (c) || c == '_' || c == '.';
+}
+
+/* Find the next local label in the LEN bytes of assembly at TEXT,
+   starting at *POS and skipping string literals and comments.  Return
+   its start and set *POS to its end, or return LEN if there is none.  */
+
+static size_t
+find_local_label (const char *text, size_t len, size_t *pos)
+{
+  size_t prefix_len = strlen (local_label_prefix);
+  size_t comment_len = strlen (ASM_COMMENT_START);
+  size_t i = *pos, start;
+
+  while (i < len)
+    {
+      if (text[i] == '"')
+	{
+	  for (i++; i < len && text[i] != '"' && text[i] != '\n'; i++)
+	    if (text[i] == '\\')
+	      i++;
+	  i++;
+	}
+      else if (comment_len
+	       && strncmp (text + i, ASM_COMMENT_START, comment_len) == 0)
+	{
+	  while (i < len && text[i] != '\n')
+	    i++;
+	}
+      else if (strncmp (text + i, local_label_prefix, prefix_len) == 0
+	       && (i == 0 || !label_char_p (text[i - 1])))
+	{
+	  start = i;
+	  for (i += prefix_len; i < len && label_char_p (text[i]); i++)
+	    ;
+	  *pos = i;
+	  return start;
+	}
+      else
+	i++;
+    }
+  *pos = len;
+  return len;
+}
+
+/* Return true if every local label that the LEN bytes of assembly at
+   TEXT refer to is defined in TEXT or, if SHARED is not null, is one of
+   the labels in SHARED.  */
+
+static bool
+local_labels_defined_p (const char *text, size_t len,
+			hash_set<nofree_string_hash> *shared)
+{
+  hash_set<nofree_string_hash> defined;
+  auto_vec<char *> labels;
+  size_t pos = 0, start;
+  bool ok = true;
+  unsigned i;
+  char *label;
+
+  while ((start = find_local_label (text, len, &pos)) < len)
+    {
+      label = xstrndup (text + start, pos - start);
+      if ((start == 0 || text[start - 1] == '\n')
+	  && pos < len && text[pos] == ':')
+	defined.add (label);
+      labels.safe_push (label);
+    }
+  FOR_EACH_VEC_ELT (labels, i, label)
+    if (!defined.contains (label)
+	&& !(shared != NULL && shared->contains (label)))
+      ok = false;
+  FOR_EACH_VEC_ELT (labels, i, label)
+    free (label);
+  return ok;
+}
+
+/* Write the entry for the LEN bytes of assembly at TEXT, generated for
+   the current function, with KEY and SUMMARY to F.  */
+
+static void
+write_entry (FILE *f, const char *key, const char *text, size_t len,
+	     const struct entry_summary *summary)
+{
+  int i;
+
+  fprintf (f, "compile-cache %s\n", key);
+  fprintf (f, "%u %d %d ", summary->preferred_incoming_stack_boundary,
+	   (int) summary->trampolines_created,
+	   (int) summary->function_used_regs_valid);
+  for (i = 0; i < FIRST_PSEUDO_REGISTER; i++)
+    putc (summary->function_used_regs_valid
+	  && TEST_HARD_REG_BIT (summary->function_used_regs, i) ? '1' : '0', f);
+  fprintf (f, "\n%lu\n", (unsigned long) len);
+  fwrite (text, 1, len, f);
+}
+
+/* Store the LEN bytes of assembly at TEXT, generated for the current
+   function, in the cache under KEY, with SUMMARY.  Failures are silently
+   ignored.  */
+
+static void
+store_entry (const char *key, const char *text, size_t len,
+	     const struct entry_summary *summary)
+{
+  char subdir[3] = { key[0], key[1], '\0' };
+  char *dir = concat (flag_compile_cache, "/", subdir, NULL);
+  char *name = cache_entry_name (key);
+  char *tmp = xasprintf ("%s.%d.tmp", name, (int) getpid ());
+  FILE *f;
+
+  if (mkdir (dir, 0777) != 0 && errno != EEXIST)
+    goto out;
+  f = fopen (tmp, "w");
+  if (f == NULL)
+    goto out;
+
+  write_entry (f, key, text, len, summary);
+  if (fclose (f) != 0 || rename (tmp, name) != 0)
+    unlink (tmp);
+
+ out:
+  free (tmp);
+  free (name);
+  free (dir);
+}
+
+/* Parse the flag at *P, followed by a space, into *FLAG.  Return false
+   if there is none.  */
+
+static bool
+parse_flag (const char **p, bool *flag)
+{
+  if (((*p)[0] != '0' && (*p)[0] != '1') || (*p)[1] != ' ')
+    return false;
+  *flag = (*p)[0] == '1';
+  *p += 2;
+  return true;
+}
+
+/* Parse the entry at *P, in a buffer that ends with a null character at
+   END.  Return its key, point *TEXT to its assembly, set *LEN and fill
+   in *SUMMARY, then move *P past the entry.  Return NULL if the entry is
+   malformed.  */
+
+static char *
+parse_entry (const char **p, const char *end, const char **text, size_t *len,
+	     struct entry_summary *summary)
+{
+  const char *q = *p, *key, *key_end;
+  unsigned long text_len;
+  char *num_end;
+  int i;
+
+  /* The header names the key, then gives the summary and the size of
+     the assembly that follows.  */
+  if (strncmp (q, "compile-cache ", 14) != 0)
+    return NULL;
+  key = q + 14;
+  key_end = strchr (key, '\n');
+  if (key_end == NULL || key_end == key)
+    return NULL;
+  q = key_end + 1;
+  summary->preferred_incoming_stack_boundary = strtoul (q, &num_end, 10);
+  if (num_end == q || *num_end != ' ')
+    return NULL;
+  q = num_end + 1;
+  if (!parse_flag (&q, &summary->trampolines_created)
+      || !parse_flag (&q, &summary->function_used_regs_valid))
+    return NULL;
+  CLEAR_HARD_REG_SET (summary->function_used_regs);
+  for (i = 0; i < FIRST_PSEUDO_REGISTER; i++, q++)
+    if (*q == '1')
+      SET_HARD_REG_BIT (summary->function_used_regs, i);
+    else if (*q != '0')
+      return NULL;
+  if (*q++ != '\n')
+    return NULL;
+  text_len = strtoul (q, &num_end, 10);
+  if (num_end == q || *num_end != '\n'
+      || text_len > (unsigned long) (end - (num_end + 1)))
+    return NULL;
+
+  *text = num_end + 1;
+  *len = text_len;
+  *p = *text + text_len;
+  return xstrndup (key, key_end - key);
+}
+
+/* Look up KEY in the cache.  If it is there, return the assembly, set
+   *LEN and fill in *SUMMARY.  Otherwise return NULL.  */
+
+static char *
+lookup_entry (const char *key, size_t *len, struct entry_summary *summary)
+{
+  char *name = cache_entry_name (key);
+  FILE *f = fopen (name, "r");
+  const char *p, *text;
+  char *buf, *entry_key;
+  size_t size;
+  bool ok;
+
+  free (name);
+  if (f == NULL)
+    return NULL;
+  buf = read_file (f, &size);
+  fclose (f);
+  if (buf == NULL)
+    return NULL;
+
+  p = buf;
+  entry_key = parse_entry (&p, buf + size, &text, len, summary);
+  ok = (entry_key != NULL && strcmp (entry_key, key) == 0
+	&& p == buf + size);
+  free (entry_key);
+  if (!ok)
+    {
+      XDELETEVEC (buf);
+      return NULL;
+    }
+  memmove (buf, text, *len + 1);
+  return buf;
+}
+
+/* Output the LEN bytes of assembly at TEXT, taken from the cache for the
+   current function, renaming its local labels apart from the others,
+   except for those in SHARED if it is not null.  Restore what compiling
+   the function would have left behind from SUMMARY.  */
+
+static void
+replay_entry (const char *text, size_t len,
+	      const struct entry_summary *summary,
+	      hash_set<nofree_string_hash> *shared)
+{
+  tree decl = current_function_decl;
+  struct cgraph_rtl_info *info;
+  size_t prefix_len = strlen (local_label_prefix);
+  size_t pos = 0, start, done = 0;
+  unsigned i;
+  tree global;
+
+  app_disable ();
+  while ((start = find_local_label (text, len, &pos)) < len)
+    {
+      if (shared != NULL)
+	{
+	  char *label = xstrndup (text + start, pos - start);
+	  bool keep = shared->contains (label);
+
+	  free (label);
+	  if (keep)
+	    continue;
+	}
+      fwrite (text + done, 1, start - done, asm_out_file);
+      fprintf (asm_out_file, "%scc%u_", local_label_prefix, replay_count);
+      fwrite (text + start + prefix_len, 1, pos - start - prefix_len,
+	      asm_out_file);
+      done = pos;
+    }
+  fwrite (text + done, 1, len - done, asm_out_file);
+  replay_count++;
+
+  /* The text leaves the assembler in an unknown section.  */
+  in_section = NULL;
+  note_function_assembled (decl);
+  if (summary->trampolines_created)
+    trampolines_created = 1;
+
+  /* Make the symbols that the text refers to needed, as expanding the
+     body would have.  Variables are kept by remove_unreferenced_decls
+     when they have RTL.  */
+  FOR_EACH_VEC_ELT (key_globals, i, global)
+    if (global != decl)
+      {
+	if (!DECL_RTL_SET_P (global))
+	  make_decl_rtl (global);
+	assemble_external (global);
+	mark_referenced (DECL_ASSEMBLER_NAME (global));
+      }
+
+  /* Restore what the RTL passes would have recorded for the callers.
+     pass_clean_state sets the preferred incoming stack boundary from
+     crtl.  */
+  crtl->preferred_stack_boundary = summary->preferred_incoming_stack_boundary;
+  crtl->stack_alignment_needed = 0;
+  info = cgraph_node::rtl_info (decl);
+  info->function_used_regs_valid = summary->function_used_regs_valid;
+  COPY_HARD_REG_SET (info->function_used_regs, summary->function_used_regs);
+
+  DECL_DEFER_OUTPUT (decl) = 0;
+  TREE_ASM_WRITTEN (decl) = 1;
+  user_defined_section_attribute = false;
+}
+
+/* Return the number of diagnostics issued so far.  */
+
+static int
+diagnostic_count (void)
+{
+  return errorcount + warningcount + werrorcount + sorrycount;
+}
+
+/* See compile-cache.h.  */
+
+bool
+compile_cache_hit_p (void)
+{
+  return cache_hit;
+}
+
+/* See compile-cache.h.  */
+
+void
+compile_cache_finish_function (void)
+{
+  struct entry_summary summary;
+  struct cgraph_rtl_info *info;
+  char *text;
+  size_t len;
+
+  if (cache_hit)
+    {
+      cache_hit = false;
+      return;
+    }
+  if (record_file == NULL)
+    return;
+
+  asm_out_file = saved_asm_out_file;
+  end_standalone_sections ();
+  text = read_file (record_file, &len);
+  fclose (record_file);
+  record_file = NULL;
+
+  summary.trampolines_created = trampolines_created;
+  trampolines_created |= saved_trampolines_created;
+  info = cgraph_node::rtl_info (current_function_decl);
+  summary.preferred_incoming_stack_boundary
+    = info->preferred_incoming_stack_boundary;
+  summary.function_used_regs_valid = info->function_used_regs_valid;
+  COPY_HARD_REG_SET (summary.function_used_regs, info->function_used_regs);
+
+  if (text != NULL)
+    {
+      fwrite (text, 1, len, asm_out_file);
+      /* Functions with diagnostics are compiled again so that the
+	 diagnostics are repeated.  */
+      if (!seen_error ()
+	  && diagnostic_count () == saved_diagnostic_count
+	  && cold_function_name == NULL_TREE)
+	{
+	  if (flag_compile_cache != NULL
+	      && local_labels_defined_p (text, len, NULL))
+	    store_entry (record_key, text, len, &summary);
+	  /* A worker may refer to the anchors created before it was
+	     forked, but not change the layout of the object blocks.  */
+	  if (worker_stream != NULL
+	      && object_block_changes == saved_object_block_changes
+	      && local_labels_defined_p (text, len, shared_labels))
+	    write_entry (worker_stream, record_key, text, len, &summary);
+	}
+      XDELETEVEC (text);
+    }
+  else
+    fatal_error (input_location,
+		 "cannot read the assembly recorded for the compile cache");
+
+  free (record_key);
+  record_key = NULL;
+}
+
+/* See compile-cache.h.  */
+
+bool
+compile_cache_parallel_p (void)
+{
+  return parallel_active;
+}
+
+/* See compile-cache.h.  */
+
+bool
+compile_cache_deferred_p (tree decl)
+{
+  return deferred_decls != NULL && deferred_decls->contains (decl);
+}
+
+/* See compile-cache.h.  */
+
+opt_pass *
+compile_cache_resume_passes (void)
+{
+  deferred_decls->remove (current_function_decl);
+  return resume_pass;
+}
+
+/* See compile-cache.h.  */
+
+bool
+compile_cache_begin_parallel (void)
+{
+  if (flag_parallel_backend <= 1)
+    return false;
+#ifndef HAVE_WORKING_FORK
+  warning (0, "%<-fparallel-backend%> is not supported on this host");
+  return false;
+#else
+  parallel_active = true;
+  if (!init_compile_cache ())
+    {
+      parallel_active = false;
+      return false;
+    }
+  deferring = true;
+  deferred_decls = new hash_set<tree>;
+  return true;
+#endif
+}
+
+#ifdef HAVE_WORKING_FORK
+
+/* Return the number of statements in the body of FN.  */
+
+static int
+count_statements (function *fn)
+{
+  gimple_stmt_iterator gsi;
+  basic_block bb;
+  int n = 0;
+
+  FOR_EACH_BB_FN (bb, fn)
+    for (gsi = gsi_start_bb (bb); !gsi_end_p (gsi); gsi_next (&gsi))
+      n++;
+  return n;
+}
+
+/* In a forked worker, run the RTL passes on the deferred functions from
+   FIRST to LAST, excluded, and stream the entries recorded for them to
+   the file NAME.  Does not return.  */
+
+static void ATTRIBUTE_NORETURN
+run_worker (unsigned first, unsigned last, const char *name)
+{
+  FILE *stream = fopen (name, "w");
+  int null_fd = open (HOST_BIT_BUCKET, O_WRONLY);
+  unsigned i;
+
+  if (stream == NULL || null_fd < 0)
+    _exit (1);
+
+  /* Nothing but the stream may be written: the assembly of what cannot
+     be recorded goes nowhere, and the functions with diagnostics or
+     dumps are compiled again by the compiler.  */
+  dup2 (null_fd, STDOUT_FILENO);
+  dup2 (null_fd, STDERR_FILENO);
+  close (null_fd);
+  asm_out_file = fopen (HOST_BIT_BUCKET, "w");
+  if (asm_out_file == NULL)
+    _exit (1);
+  g->get_dumps ()->dump_disable_all ();
+  statistics_disable ();
+  symtab->dump_file = NULL;
+
+  worker_stream = stream;
+  for (i = first; i < last; i++)
+    deferred_nodes[i]->expand_deferred ();
+  _exit (fclose (stream) != 0);
+}
+
+/* Read the entries that a worker streamed to the file NAME.  */
+
+static void
+read_worker_stream (const char *name)
+{
+  FILE *f = fopen (name, "r");
+  struct parallel_entry entry;
+  const char *p;
+  char *buf, *key;
+  size_t size;
+
+  if (f == NULL)
+    return;
+  buf = read_file (f, &size);
+  fclose (f);
+  if (buf == NULL)
+    return;
+
+  /* The buffer is kept for the rest of the compilation.  */
+  p = buf;
+  while (p < buf + size
+	 && (key = parse_entry (&p, buf + size, &entry.text, &entry.len,
+				&entry.summary)) != NULL)
+    if (parallel_entries->get (key) == NULL)
+      parallel_entries->put (key, entry);
+    else
+      free (key);
+}
+
+#endif
+
+/* See compile-cache.h.  */
+
+void
+compile_cache_finish_parallel (void)
+{
+  unsigned n = deferred_nodes.length ();
+  unsigned i;
+#ifdef HAVE_WORKING_FORK
+  auto_vec<int> sizes (n);
+  auto_vec<unsigned> first;
+  auto_vec<char *> names;
+  auto_vec<pid_t> pids;
+  vec<rtx> anchors = vNULL;
+  unsigned workers, k;
+  gcov_type total = 0, size = 0;
+  int status;
+  rtx anchor;
+  pid_t pid;
+#endif
+
+  deferring = false;
+
+#ifdef HAVE_WORKING_FORK
+  for (i = 0; i < n; i++)
+    {
+      sizes.quick_push (count_statements
+			  (DECL_STRUCT_FUNCTION (deferred_nodes[i]->decl)));
+      total += sizes[i];
+    }
+
+  /* Split the functions into contiguous partitions of about the same
+     size, none smaller than the minimal partition size.  */
+  workers = MIN ((gcov_type) flag_parallel_backend,
+		 total / PARAM_VALUE (PARAM_PARALLEL_BACKEND_MIN_PARTITION));
+  workers = MIN (workers, n);
+  first.safe_push (0);
+  for (i = 0; i + 1 < n && first.length () < workers; i++)
+    {
+      size += sizes[i];
+      if (size * workers >= total * first.length ())
+	first.safe_push (i + 1);
+    }
+  first.safe_push (n);
+  workers = first.length () - 1;
+
+  if (workers > 1)
+    {
+      place_variables_in_object_blocks (&anchors);
+      shared_labels = new hash_set<nofree_string_hash>;
+      FOR_EACH_VEC_ELT (anchors, i, anchor)
+	shared_labels->add (targetm.strip_name_encoding (XSTR (anchor, 0)));
+      anchors.release ();
+
+      /* The workers must not inherit unwritten output.  */
+      fflush (NULL);
+      names.safe_push (NULL);
+      pids.safe_push (-1);
+      for (k = 1; k < workers; k++)
+	{
+	  names.safe_push (make_temp_file (".s"));
+	  pid = fork ();
+	  if (pid == 0)
+	    run_worker (first[k], first[k + 1], names[k]);
+	  pids.safe_push (pid);
+	}
+    }
+
+  /* Compile the first partition while the workers run.  */
+  for (i = 0; i < first[1]; i++)
+    deferred_nodes[i]->expand_deferred ();
+
+  if (workers > 1)
+    {
+      parallel_entries = new hash_map<nofree_string_hash, parallel_entry>;
+      for (k = 1; k < workers; k++)
+	{
+	  /* A worker that failed is ignored, and the compiler compiles
+	     its functions again.  */
+	  pid = -1;
+	  if (pids[k] > 0)
+	    while ((pid = waitpid (pids[k], &status, 0)) < 0 && errno == EINTR)
+	      ;
+	  if (pid > 0 && WIFEXITED (status) && WEXITSTATUS (status) == 0)
+	    read_worker_stream (names[k]);
+	  unlink (names[k]);
+	  free (names[k]);
+	}
+    }
+  i = first[1];
+#else
+  i = 0;
+#endif
+
+  for (; i < n; i++)
+    deferred_nodes[i]->expand_deferred ();
+  deferred_nodes.release ();
+}
+
+namespace {
+
+const pass_data pass_data_compile_cache =
+{
+  GIMPLE_PASS, /* type */
+  "compcache", /* name */
+  OPTGROUP_NONE, /* optinfo_flags */
+  TV_COMPILE_CACHE, /* tv_id */
+  ( PROP_ssa | PROP_cfg ), /* properties_required */
+  0, /* properties_provided */
+  0, /* properties_destroyed */
+  0, /* todo_flags_start */
+  0, /* todo_flags_finish */
+};
+
+class pass_compile_cache : public gimple_opt_pass
+{
+public:
+  pass_compile_cache (gcc::context *ctxt)
+    : gimple_opt_pass (pass_data_compile_cache, ctxt)
+  {}
+
+  /* opt_pass methods: */
+  virtual bool gate (function *)
+    {
+      return ((flag_compile_cache != NULL || parallel_active)
+	      && !seen_error ());
+    }
+
+  virtual unsigned int execute (function *);
+
+}; // class pass_compile_cache
+
+unsigned int
+pass_compile_cache::execute (function *fun)
+{
+  struct entry_summary summary;
+  parallel_entry *entry = NULL;
+  char *key, *text = NULL;
+  size_t len;
+
+  if (!init_compile_cache ())
+    return 0;
+
+  /* The pass manager stops here, and the RTL passes are run from this
+     pass again by cgraph_node::expand_deferred.  */
+  if (deferring)
+    {
+      deferred_nodes.safe_push (cgraph_node::get (fun->decl));
+      deferred_decls->add (fun->decl);
+      resume_pass = this;
+      if (dump_file)
+	fprintf (dump_file, "RTL passes deferred for the parallel back end\n");
+      return 0;
+    }
+
+  key = compute_key (fun);
+  if (key == NULL)
+    {
+      if (dump_file)
+	fprintf (dump_file, "Not cached: %s\n", key_failure);
+      statistics_counter_event (fun, "compile cache: not cacheable", 1);
+      return 0;
+    }
+  if (dump_file)
+    fprintf (dump_file, "Compile cache key: %s\n", key);
+
+  if (parallel_entries != NULL)
+    entry = parallel_entries->get (key);
+  if (entry != NULL)
+    replay_entry (entry->text, entry->len, &entry->summary, shared_labels);
+  else if (flag_compile_cache != NULL
+	   && (text = lookup_entry (key, &len, &summary)) != NULL)
+    {
+      replay_entry (text, len, &summary, NULL);
+      XDELETEVEC (text);
+    }
+  if (entry != NULL || text != NULL)
+    {
+      free (key);
+      cache_hit = true;
+      /* The function is left as if it had been expanded, so that
+	 pass_clean_state releases it.  */
+      fun->curr_properties &= ~(PROP_ssa | PROP_trees);
+      fun->curr_properties |= PROP_rtl;
+      if (dump_file)
+	fprintf (dump_file, entry != NULL
+		 ? "Replayed from a parallel back end worker\n"
+		 : "Replayed from the compile cache\n");
+      statistics_counter_event (fun, entry != NULL
+				? "compile cache: parallel hit"
+				: "compile cache: hit", 1);
+      return 0;
+    }
+
+  /* Only the cache and the workers need a recording.  */
+  if (flag_compile_cache == NULL && worker_stream == NULL)
+    {
+      free (key);
+      return 0;
+    }
+  record_file = tmpfile ();
+  if (record_file == NULL)
+    {
+      free (key);
+      return 0;
+    }
+  app_disable ();
+  saved_asm_out_file = asm_out_file;
+  asm_out_file = record_file;
+  record_key = key;
+  saved_trampolines_created = trampolines_created;
+  trampolines_created = 0;
+  saved_diagnostic_count = diagnostic_count ();
+  if (worker_stream != NULL)
+    {
+      /* Let the function output its own copy of the constants that
+	 other functions of the worker output before.  */
+      forget_output_constants ();
+      saved_object_block_changes = object_block_changes;
+    }
+  begin_standalone_sections ();
+  if (dump_file)
+    fprintf (dump_file, "Recording for the compile cache\n");
+  statistics_counter_event (fun, "compile cache: miss", 1);
+  return 0;
+}
+
+} // anon namespace
+
+gimple_opt_pass *
+make_pass_compile_cache (gcc::context *ctxt)
+{
+  return new pass_compile_cache (ctxt);
+}
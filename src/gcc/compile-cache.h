@@ -0,0 +1,48 @@
+/* Cache of the assembly generated for individual functions.
+   Copyright (C) 2016 Free Software Foundation, Inc.
+
+This file is part of GCC.
+
+GCC is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free
+Software Foundation; either version 3, or (at your option) any later
+version.
+
+GCC is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with GCC; see the file COPYING3.  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#ifndef GCC_COMPILE_CACHE_H
+#define GCC_COMPILE_CACHE_H
+
+/* True if the assembly of the current function was taken from the
+   compile cache, so that it must not be expanded to RTL.  */
+extern bool compile_cache_hit_p (void);
+
+/* Called once all passes have run on the current function.  */
+extern void compile_cache_finish_function (void);
+
+/* True if the parallel back end is in use, so that the RTL passes must
+   not use what they recorded for other functions.  */
+extern bool compile_cache_parallel_p (void);
+
+/* True if the RTL passes of the function DECL have been deferred by the
+   parallel back end.  */
+extern bool compile_cache_deferred_p (tree);
+
+/* Return the first pass to run on the current function, whose RTL
+   passes have been deferred, and forget that they were.  */
+extern opt_pass *compile_cache_resume_passes (void);
+
+/* Called before the functions are expanded.  Return true if the RTL
+   passes are to be deferred, and then run in parallel by
+   compile_cache_finish_parallel once all functions have been seen.  */
+extern bool compile_cache_begin_parallel (void);
+extern void compile_cache_finish_parallel (void);
+
+#endif /* GCC_COMPILE_CACHE_H */
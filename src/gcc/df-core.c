@@ -384,10 +384,14 @@ are write-only operations.
 #include "cfganal.h"
 #include "tree-pass.h"
 #include "cfgloop.h"
+#include "diagnostic-core.h"
 
 static void *df_get_bb_info (struct dataflow *, unsigned int);
 static void df_set_bb_info (struct dataflow *, unsigned int, void *);
 static void df_clear_bb_info (struct dataflow *, unsigned int);
+static void df_incremental_reset (int);
+static void df_incremental_invalidate (void);
+static void df_incremental_renumber (const int *);
 #ifdef DF_DEBUG_CFG
 static void df_set_clean_cfg (void);
 #endif
@@ -401,6 +405,32 @@ struct bitmap_obstack reg_obstack;
 
 bitmap_obstack df_bitmap_obstack;
 
+/* The state of the incremental solution of a problem, see
+   df_incremental_dataflow.  */
+
+struct df_incremental_d
+{
+  /* True if the problem was last solved over the whole function and
+     CFG_IMAGE describes the CFG it was solved for.  */
+  bool valid;
+
+  /* True if the solution of any block may have changed since the
+     problem that depends on this one was last solved.  Otherwise the
+     blocks whose solution may have changed are in CHANGED.  */
+  bool all_changed;
+  bitmap changed;
+
+  /* The edges of the block with index I, as pushed by df_edge_image,
+     are CFG_IMAGE[CFG_START[I]] to CFG_IMAGE[CFG_START[I + 1] - 1].  */
+  vec<int> cfg_image;
+  vec<unsigned int> cfg_start;
+
+  /* For LR, the registers that were live everywhere.  */
+  bitmap hardware_regs_used;
+};
+
+static struct df_incremental_d df_incremental[DF_LAST_PROBLEM_PLUS1];
+
 
 /*----------------------------------------------------------------------------
   Functions to create, destroy and manipulate an instance of df.
@@ -433,6 +463,7 @@ df_add_problem (struct df_problem *problem)
   dflow->computed = false;
   dflow->solutions_dirty = true;
   df->problems_by_index[dflow->problem->id] = dflow;
+  df_incremental_reset (dflow->problem->id);
 
   /* Keep the defined problems ordered by index.  This solves the
      problem that RI will use the information from UREC if UREC has
@@ -612,6 +643,7 @@ df_remove_problem (struct dataflow *dflow)
 
   (problem->remove_problem_fun) ();
   df->problems_by_index[problem->id] = NULL;
+  df_incremental_reset (problem->id);
 }
 
 
@@ -817,6 +849,9 @@ rest_of_handle_df_finish (void)
       dflow->problem->free_fun ();
     }
 
+  for (i = 0; i < DF_LAST_PROBLEM_PLUS1; i++)
+    df_incremental_reset (i);
+
   free (df->postorder);
   free (df->postorder_inverted);
   free (df->hard_regs_live_count);
@@ -1074,13 +1109,17 @@ df_worklist_dataflow_doublequeue (struct dataflow *dataflow,
    The solver is a double-queue algorithm similar to the "double stack" solver
    from Cooper, Harvey and Kennedy, "Iterative data-flow analysis, Revisited".
    The only significant difference is that the worklist in this implementation
-   is always sorted in RPO of the CFG visiting direction.  */
+   is always sorted in RPO of the CFG visiting direction.
 
-void
-df_worklist_dataflow (struct dataflow *dataflow,
-                      bitmap blocks_to_consider,
-                      int *blocks_in_postorder,
-                      int n_blocks)
+   If BLOCKS_TO_SOLVE is nonnull, only the solution of those blocks is
+   recomputed; the other blocks of BLOCKS_TO_CONSIDER keep theirs.  */
+
+static void
+df_worklist_dataflow_1 (struct dataflow *dataflow,
+			bitmap blocks_to_consider,
+			bitmap blocks_to_solve,
+			int *blocks_in_postorder,
+			int n_blocks)
 {
   bitmap pending = BITMAP_ALLOC (&df_bitmap_obstack);
   sbitmap considered = sbitmap_alloc (last_basic_block_for_fn (cfun));
@@ -1112,12 +1151,15 @@ df_worklist_dataflow (struct dataflow *dataflow,
     {
       bbindex_to_postorder[blocks_in_postorder[i]] = i;
       /* Add all blocks to the worklist.  */
-      bitmap_set_bit (pending, i);
+      if (!blocks_to_solve
+	  || bitmap_bit_p (blocks_to_solve, blocks_in_postorder[i]))
+	bitmap_set_bit (pending, i);
     }
 
   /* Initialize the problem. */
   if (dataflow->problem->init_fun)
-    dataflow->problem->init_fun (blocks_to_consider);
+    dataflow->problem->init_fun (blocks_to_solve
+				 ? blocks_to_solve : blocks_to_consider);
 
   /* Solve it.  */
   df_worklist_dataflow_doublequeue (dataflow, pending, considered,
@@ -1128,6 +1170,623 @@ df_worklist_dataflow (struct dataflow *dataflow,
   free (bbindex_to_postorder);
 }
 
+/* Solve DATAFLOW over BLOCKS_TO_CONSIDER from scratch, see
+   df_worklist_dataflow_1.  */
+
+void
+df_worklist_dataflow (struct dataflow *dataflow,
+                      bitmap blocks_to_consider,
+                      int *blocks_in_postorder,
+                      int n_blocks)
+{
+  df_worklist_dataflow_1 (dataflow, blocks_to_consider, NULL,
+			  blocks_in_postorder, n_blocks);
+  df_incremental[dataflow->problem->id].all_changed = true;
+}
+
+
+/*----------------------------------------------------------------------------
+   Incremental solutions of the register liveness problems.
+
+   Most RTL passes only change a few blocks between two calls to
+   df_analyze, and mark them with df_set_bb_dirty or df_insn_rescan.
+   Once LR or LIVE has been solved over the whole function, the next
+   solution can start from the previous one: the blocks whose transfer
+   functions or edges changed (and for LIVE, the blocks whose LR solution
+   changed) are re-solved, then the blocks that consume their values (the
+   predecessors for LR, the successors for LIVE) if those values changed,
+   and so on until the values stop changing.  As bits carried around a
+   loop may be stale, this is done a strongly connected component of the
+   CFG at a time, each one re-solved from scratch with the values of the
+   components it depends on, in topological order.  The result is the
+   least fixed point, as that of df_worklist_dataflow.
+   -fincremental-dataflow-check re-solves the problem from scratch after
+   each incremental solution and compares.
+----------------------------------------------------------------------------*/
+
+/* Forget the incremental state of the problem with index ID.  */
+
+static void
+df_incremental_reset (int id)
+{
+  struct df_incremental_d *info = &df_incremental[id];
+
+  info->valid = false;
+  info->all_changed = false;
+  if (info->changed)
+    BITMAP_FREE (info->changed);
+  if (info->hardware_regs_used)
+    BITMAP_FREE (info->hardware_regs_used);
+  info->cfg_image.release ();
+  info->cfg_start.release ();
+}
+
+
+/* Forget the block indices recorded for every problem, which are about
+   to change.  */
+
+static void
+df_incremental_invalidate (void)
+{
+  int i;
+
+  for (i = 0; i < DF_LAST_PROBLEM_PLUS1; i++)
+    {
+      df_incremental[i].valid = false;
+      df_incremental[i].all_changed = true;
+    }
+}
+
+
+/* Renumber the blocks in the incremental state of every problem for
+   df_compact_blocks: the block with index I gets index MAP[I], or is
+   gone if that is -1.  Called before the blocks are renumbered.  */
+
+static void
+df_incremental_renumber (const int *map)
+{
+  int n_new = n_basic_blocks_for_fn (cfun);
+  int *old_index = XNEWVEC (int, n_new);
+  bitmap_head tmp;
+  bitmap_iterator bi;
+  unsigned int index;
+  int i, id;
+
+  for (i = 0; i < last_basic_block_for_fn (cfun); i++)
+    if (map[i] >= 0)
+      old_index[map[i]] = i;
+
+  bitmap_initialize (&tmp, &df_bitmap_obstack);
+  for (id = 0; id < DF_LAST_PROBLEM_PLUS1; id++)
+    {
+      struct df_incremental_d *info = &df_incremental[id];
+
+      if (info->changed)
+	{
+	  bitmap_copy (&tmp, info->changed);
+	  bitmap_clear (info->changed);
+	  EXECUTE_IF_SET_IN_BITMAP (&tmp, 0, index, bi)
+	    if (map[index] >= 0)
+	      bitmap_set_bit (info->changed, map[index]);
+	}
+
+      if (info->valid)
+	{
+	  vec<int> image = vNULL;
+	  vec<unsigned int> start = vNULL;
+
+	  for (i = 0; i < n_new; i++)
+	    {
+	      unsigned int o = old_index[i], k;
+
+	      start.safe_push (image.length ());
+	      if (o + 1 >= info->cfg_start.length ())
+		{
+		  image.safe_push (-2);
+		  continue;
+		}
+	      for (k = info->cfg_start[o]; k < info->cfg_start[o + 1]; k++)
+		{
+		  int v = info->cfg_image[k];
+
+		  /* An edge to a deleted block can no longer match.  */
+		  if (v >= 0)
+		    v = map[v / 4] >= 0 ? map[v / 4] * 4 + v % 4 : -3;
+		  image.safe_push (v);
+		}
+	    }
+	  start.safe_push (image.length ());
+
+	  info->cfg_image.release ();
+	  info->cfg_start.release ();
+	  info->cfg_image = image;
+	  info->cfg_start = start;
+	}
+    }
+  bitmap_clear (&tmp);
+  free (old_index);
+}
+
+
+/* Push the edges of BB that matter to LR and LIVE onto IMAGE.  */
+
+static void
+df_edge_image (basic_block bb, vec<int> *image)
+{
+  edge e;
+  edge_iterator ei;
+
+  FOR_EACH_EDGE (e, ei, bb->succs)
+    image->safe_push (e->dest->index * 4
+		      + ((e->flags & EDGE_EH) ? 1 : 0)
+		      + ((e->flags & EDGE_FAKE) ? 2 : 0));
+  image->safe_push (-1);
+  FOR_EACH_EDGE (e, ei, bb->preds)
+    image->safe_push (e->src->index * 4
+		      + ((e->flags & EDGE_EH) ? 1 : 0)
+		      + ((e->flags & EDGE_FAKE) ? 2 : 0));
+}
+
+
+/* Return the blocks of BLOCKS_TO_CONSIDER from which DFLOW has to be
+   re-solved, or NULL if it has to be solved from scratch.  Called
+   before the local information of DFLOW is recomputed.  */
+
+static bitmap
+df_incremental_seeds (struct dataflow *dflow, bitmap blocks_to_consider)
+{
+  struct df_incremental_d *info = &df_incremental[dflow->problem->id];
+  struct df_problem *dependent = dflow->problem->dependent_problem;
+  auto_vec<int, 32> image;
+  bitmap seeds;
+  bitmap_iterator bi;
+  unsigned int index;
+
+  if (!flag_incremental_dataflow
+      || (dflow != df_lr && dflow != df_live)
+      || !info->valid
+      || !dflow->computed
+      || df->analyze_subset
+      || (dependent && df_incremental[dependent->id].all_changed))
+    return NULL;
+
+  seeds = BITMAP_ALLOC (&df_bitmap_obstack);
+  if (dflow->out_of_date_transfer_functions)
+    bitmap_copy (seeds, dflow->out_of_date_transfer_functions);
+  if (dependent && df_incremental[dependent->id].changed)
+    bitmap_ior_into (seeds, df_incremental[dependent->id].changed);
+
+  EXECUTE_IF_SET_IN_BITMAP (blocks_to_consider, 0, index, bi)
+    {
+      unsigned int start, len;
+
+      if (bitmap_bit_p (seeds, index))
+	continue;
+      if (index + 1 >= info->cfg_start.length ())
+	{
+	  bitmap_set_bit (seeds, index);
+	  continue;
+	}
+      image.truncate (0);
+      df_edge_image (BASIC_BLOCK_FOR_FN (cfun, index), &image);
+      start = info->cfg_start[index];
+      len = info->cfg_start[index + 1] - start;
+      if (len != image.length ()
+	  || memcmp (&info->cfg_image[start], image.address (),
+		     len * sizeof (int)) != 0)
+	bitmap_set_bit (seeds, index);
+    }
+
+  bitmap_and_into (seeds, blocks_to_consider);
+  return seeds;
+}
+
+
+/* Return the solution of DFLOW at the block with index INDEX in IN and
+   OUT.  */
+
+static void
+df_incremental_solution (struct dataflow *dflow, unsigned int index,
+			 bitmap *in, bitmap *out)
+{
+  if (dflow == df_lr)
+    {
+      *in = &df_lr_get_bb_info (index)->in;
+      *out = &df_lr_get_bb_info (index)->out;
+    }
+  else
+    {
+      *in = &df_live_get_bb_info (index)->in;
+      *out = &df_live_get_bb_info (index)->out;
+    }
+}
+
+
+/* Append to SCCS the strongly connected components of the part of the
+   CFG that consumes the values of the blocks in SEEDS, following the
+   successors if FORWARD and the predecessors otherwise, and only the
+   blocks in BLOCKS_TO_CONSIDER.  The blocks of the I-th component are
+   SCCS[SCC_START[I]] to SCCS[SCC_START[I + 1] - 1], and a component
+   comes after all those that consume its values.  */
+
+static void
+df_incremental_sccs (bitmap seeds, bitmap blocks_to_consider, bool forward,
+		     vec<int> *sccs, vec<unsigned int> *scc_start)
+{
+  int n = last_basic_block_for_fn (cfun);
+  int *dfsnum = XNEWVEC (int, n);
+  int *low = XNEWVEC (int, n);
+  sbitmap done = sbitmap_alloc (n);
+  auto_vec<int, 32> stack;
+  auto_vec<std::pair<int, unsigned int>, 32> dfs;
+  bitmap_iterator bi;
+  unsigned int seed;
+  int i, num = 0;
+
+  for (i = 0; i < n; i++)
+    dfsnum[i] = -1;
+  bitmap_clear (done);
+
+  /* Tarjan's algorithm.  */
+  EXECUTE_IF_SET_IN_BITMAP (seeds, 0, seed, bi)
+    {
+      if (dfsnum[seed] != -1)
+	continue;
+      dfsnum[seed] = low[seed] = num++;
+      stack.safe_push (seed);
+      dfs.safe_push (std::make_pair ((int) seed, 0u));
+
+      while (!dfs.is_empty ())
+	{
+	  int v = dfs.last ().first;
+	  unsigned int ix = dfs.last ().second;
+	  basic_block bb = BASIC_BLOCK_FOR_FN (cfun, v);
+	  vec<edge, va_gc> *edges = forward ? bb->succs : bb->preds;
+
+	  if (ix < vec_safe_length (edges))
+	    {
+	      edge e = (*edges)[ix];
+	      int w = forward ? e->dest->index : e->src->index;
+
+	      dfs.last ().second++;
+	      if (!bitmap_bit_p (blocks_to_consider, w))
+		continue;
+	      if (dfsnum[w] == -1)
+		{
+		  dfsnum[w] = low[w] = num++;
+		  stack.safe_push (w);
+		  dfs.safe_push (std::make_pair (w, 0u));
+		}
+	      else if (!bitmap_bit_p (done, w))
+		low[v] = MIN (low[v], dfsnum[w]);
+	      continue;
+	    }
+
+	  dfs.pop ();
+	  if (!dfs.is_empty ())
+	    low[dfs.last ().first] = MIN (low[dfs.last ().first], low[v]);
+	  if (low[v] == dfsnum[v])
+	    {
+	      int w;
+
+	      scc_start->safe_push (sccs->length ());
+	      do
+		{
+		  w = stack.pop ();
+		  bitmap_set_bit (done, w);
+		  sccs->safe_push (w);
+		}
+	      while (w != v);
+	    }
+	}
+    }
+  scc_start->safe_push (sccs->length ());
+
+  free (dfsnum);
+  free (low);
+  sbitmap_free (done);
+}
+
+
+/* Re-solve DFLOW over the blocks of BLOCKS_TO_CONSIDER whose solution
+   may depend on the blocks in SEEDS, see above.  Set SEEDS to the blocks
+   whose solution changed, and add to TOUCHED the blocks whose solution
+   was recomputed.  POSTORDER and N_BLOCKS are as for
+   df_worklist_dataflow; as there, the blocks not in POSTORDER keep the
+   value init_fun gives them.  */
+
+static void
+df_incremental_dataflow (struct dataflow *dflow, bitmap blocks_to_consider,
+			 bitmap seeds, bitmap touched, int *postorder,
+			 int n_blocks)
+{
+  struct df_problem *problem = dflow->problem;
+  bool forward = problem->dir == DF_FORWARD;
+  int n = last_basic_block_for_fn (cfun);
+  int *position = XNEWVEC (int, n);
+  bitmap_head dirty, changed, scc_blocks, pending, worklist;
+  bitmap_head *saved_in, *saved_out;
+  auto_vec<int, 64> sccs;
+  auto_vec<unsigned int, 16> scc_start;
+  unsigned int k, solved = 0;
+  int i;
+
+  /* The position of each block in POSTORDER, or -1.  */
+  for (i = 0; i < n; i++)
+    position[i] = -1;
+  for (i = 0; i < n_blocks; i++)
+    position[postorder[i]] = i;
+
+  df_incremental_sccs (seeds, blocks_to_consider, forward,
+		       &sccs, &scc_start);
+
+  bitmap_initialize (&dirty, &df_bitmap_obstack);
+  bitmap_initialize (&changed, &df_bitmap_obstack);
+  bitmap_initialize (&scc_blocks, &df_bitmap_obstack);
+  bitmap_initialize (&pending, &df_bitmap_obstack);
+  bitmap_initialize (&worklist, &df_bitmap_obstack);
+  bitmap_copy (&dirty, seeds);
+  saved_in = XNEWVEC (bitmap_head, n);
+  saved_out = XNEWVEC (bitmap_head, n);
+
+  /* The components that produce values come last.  */
+  for (k = scc_start.length () - 1; k-- > 0; )
+    {
+      unsigned int first = scc_start[k], last = scc_start[k + 1], j;
+      bool cyclic = last - first > 1;
+      edge e;
+      edge_iterator ei;
+
+      bitmap_clear (&scc_blocks);
+      for (j = first; j < last; j++)
+	bitmap_set_bit (&scc_blocks, sccs[j]);
+      if (!bitmap_intersect_p (&scc_blocks, &dirty))
+	continue;
+
+      /* Set the old values aside.  df_live_finalize trims the values
+	 of LIVE, so first recompute those the component reads from its
+	 producers and its own, which the transfer functions of the
+	 blocks that are not seeds still give.  */
+      for (j = first; j < last; j++)
+	{
+	  basic_block bb = BASIC_BLOCK_FOR_FN (cfun, sccs[j]);
+	  bitmap in, out;
+
+	  FOR_EACH_EDGE (e, ei, forward ? bb->preds : bb->succs)
+	    {
+	      int other = forward ? e->src->index : e->dest->index;
+
+	      if (other == bb->index)
+		cyclic = true;
+	      else if (dflow == df_live
+		       && bitmap_bit_p (blocks_to_consider, other)
+		       && !bitmap_bit_p (&scc_blocks, other)
+		       && bitmap_set_bit (touched, other))
+		problem->trans_fun (other);
+	    }
+
+	  if (dflow == df_live && !bitmap_bit_p (seeds, bb->index))
+	    problem->trans_fun (bb->index);
+	  df_incremental_solution (dflow, bb->index, &in, &out);
+	  bitmap_initialize (&saved_in[bb->index], in->obstack);
+	  bitmap_move (&saved_in[bb->index], in);
+	  bitmap_initialize (in, saved_in[bb->index].obstack);
+	  bitmap_initialize (&saved_out[bb->index], out->obstack);
+	  bitmap_move (&saved_out[bb->index], out);
+	  bitmap_initialize (out, saved_out[bb->index].obstack);
+	}
+
+      /* Solve the component from scratch, visiting its blocks in the
+	 order of POSTORDER as df_worklist_dataflow does.  */
+      if (problem->init_fun)
+	problem->init_fun (&scc_blocks);
+      for (j = first; j < last; j++)
+	if (position[sccs[j]] >= 0)
+	  bitmap_set_bit (&pending, position[sccs[j]]);
+      while (!bitmap_empty_p (&pending))
+	{
+	  bitmap_iterator bi;
+	  unsigned int pos;
+
+	  bitmap_copy (&worklist, &pending);
+	  bitmap_clear (&pending);
+	  EXECUTE_IF_SET_IN_BITMAP (&worklist, 0, pos, bi)
+	    {
+	      basic_block bb = BASIC_BLOCK_FOR_FN (cfun, postorder[pos]);
+	      vec<edge, va_gc> *edges = forward ? bb->preds : bb->succs;
+
+	      if (EDGE_COUNT (edges) > 0)
+		FOR_EACH_EDGE (e, ei, edges)
+		  {
+		    if (bitmap_bit_p (blocks_to_consider,
+				      forward ? e->src->index
+				      : e->dest->index))
+		      problem->con_fun_n (e);
+		  }
+	      else if (problem->con_fun_0)
+		problem->con_fun_0 (bb);
+	      if (problem->trans_fun (bb->index) && cyclic)
+		FOR_EACH_EDGE (e, ei, forward ? bb->succs : bb->preds)
+		  {
+		    int other = forward ? e->dest->index : e->src->index;
+
+		    if (bitmap_bit_p (&scc_blocks, other)
+			&& position[other] >= 0)
+		      bitmap_set_bit (&pending, position[other]);
+		  }
+	    }
+	}
+      solved += last - first;
+
+      /* Mark the consumers of the values that changed.  */
+      for (j = first; j < last; j++)
+	{
+	  basic_block bb = BASIC_BLOCK_FOR_FN (cfun, sccs[j]);
+	  bitmap in, out;
+	  bool in_changed, out_changed;
+
+	  bitmap_set_bit (touched, bb->index);
+	  df_incremental_solution (dflow, bb->index, &in, &out);
+	  in_changed = !bitmap_equal_p (&saved_in[bb->index], in);
+	  out_changed = !bitmap_equal_p (&saved_out[bb->index], out);
+	  bitmap_clear (&saved_in[bb->index]);
+	  bitmap_clear (&saved_out[bb->index]);
+
+	  if (in_changed || out_changed || bitmap_bit_p (seeds, bb->index))
+	    bitmap_set_bit (&changed, bb->index);
+	  if (bitmap_bit_p (seeds, bb->index)
+	      || (forward ? out_changed : in_changed))
+	    FOR_EACH_EDGE (e, ei, forward ? bb->succs : bb->preds)
+	      bitmap_set_bit (&dirty, forward ? e->dest->index
+				      : e->src->index);
+	}
+    }
+
+  if (dump_file)
+    fprintf (dump_file, "df_incremental_dataflow: %s re-solved %u of %d"
+	     " blocks, %u changed\n", dflow == df_lr ? "lr" : "live",
+	     solved, n_blocks, (unsigned) bitmap_count_bits (&changed));
+
+  bitmap_copy (seeds, &changed);
+  bitmap_clear (&dirty);
+  bitmap_clear (&changed);
+  bitmap_clear (&scc_blocks);
+  bitmap_clear (&worklist);
+  free (saved_in);
+  free (saved_out);
+  free (position);
+}
+
+
+/* Check the incremental solution of DFLOW over BLOCKS_TO_CONSIDER
+   against one computed from scratch.  */
+
+static void
+df_incremental_verify (struct dataflow *dflow, bitmap blocks_to_consider,
+		       int *postorder, int n_blocks)
+{
+  int n = last_basic_block_for_fn (cfun);
+  bitmap_head *saved_in = XNEWVEC (bitmap_head, n);
+  bitmap_head *saved_out = XNEWVEC (bitmap_head, n);
+  bitmap_iterator bi;
+  unsigned int index;
+  bitmap in, out;
+  int old_flags;
+
+  EXECUTE_IF_SET_IN_BITMAP (blocks_to_consider, 0, index, bi)
+    {
+      df_incremental_solution (dflow, index, &in, &out);
+      bitmap_initialize (&saved_in[index], &df_bitmap_obstack);
+      bitmap_initialize (&saved_out[index], &df_bitmap_obstack);
+      bitmap_copy (&saved_in[index], in);
+      bitmap_copy (&saved_out[index], out);
+    }
+
+  /* Fast dce must not change the insns behind our back.  */
+  old_flags = df_clear_flags (DF_LR_RUN_DCE);
+  df_worklist_dataflow_1 (dflow, blocks_to_consider, NULL,
+			  postorder, n_blocks);
+  if (dflow->problem->finalize_fun)
+    {
+      dflow->solutions_dirty = true;
+      dflow->problem->finalize_fun (blocks_to_consider);
+    }
+  if (old_flags & DF_LR_RUN_DCE)
+    df_set_flags (DF_LR_RUN_DCE);
+
+  EXECUTE_IF_SET_IN_BITMAP (blocks_to_consider, 0, index, bi)
+    {
+      df_incremental_solution (dflow, index, &in, &out);
+      if (!bitmap_equal_p (&saved_in[index], in)
+	  || !bitmap_equal_p (&saved_out[index], out))
+	{
+	  if (dump_file)
+	    {
+	      fprintf (dump_file, "incremental in/out of bb %u:\n", index);
+	      dump_bitmap (dump_file, &saved_in[index]);
+	      dump_bitmap (dump_file, &saved_out[index]);
+	      fprintf (dump_file, "full in/out of bb %u:\n", index);
+	      dump_bitmap (dump_file, in);
+	      dump_bitmap (dump_file, out);
+	    }
+	  internal_error ("incremental %s solution of bb %u differs from"
+			  " a full recompute",
+			  dflow == df_lr ? "lr" : "live", index);
+	}
+      bitmap_clear (&saved_in[index]);
+      bitmap_clear (&saved_out[index]);
+    }
+
+  free (saved_in);
+  free (saved_out);
+}
+
+
+/* Record that DFLOW has been solved over BLOCKS_TO_CONSIDER, by
+   df_incremental_dataflow changing the solution of the blocks in
+   CHANGED if nonnull and from scratch otherwise.  */
+
+static void
+df_incremental_record (struct dataflow *dflow, bitmap blocks_to_consider,
+		       bitmap changed)
+{
+  struct df_incremental_d *info = &df_incremental[dflow->problem->id];
+  struct df_problem *dependent = dflow->problem->dependent_problem;
+  unsigned int index;
+
+  if (dflow != df_lr && dflow != df_live)
+    return;
+
+  /* The changes of the problem this one depends on have been used.  */
+  if (dependent)
+    {
+      df_incremental[dependent->id].all_changed = false;
+      if (df_incremental[dependent->id].changed)
+	bitmap_clear (df_incremental[dependent->id].changed);
+    }
+
+  if (!changed)
+    info->all_changed = true;
+  if (info->all_changed)
+    {
+      if (info->changed)
+	bitmap_clear (info->changed);
+    }
+  else
+    {
+      if (!info->changed)
+	info->changed = BITMAP_ALLOC (&df_bitmap_obstack);
+      bitmap_ior_into (info->changed, changed);
+    }
+
+  info->valid = flag_incremental_dataflow && !df->analyze_subset;
+  if (!info->valid)
+    return;
+
+  info->cfg_image.truncate (0);
+  info->cfg_start.truncate (0);
+  for (index = 0; index < (unsigned) last_basic_block_for_fn (cfun); index++)
+    {
+      basic_block bb = BASIC_BLOCK_FOR_FN (cfun, index);
+
+      info->cfg_start.safe_push (info->cfg_image.length ());
+      if (bb && bitmap_bit_p (blocks_to_consider, index))
+	df_edge_image (bb, &info->cfg_image);
+      else
+	/* No block can have this image, so the block is a seed once it
+	   appears.  */
+	info->cfg_image.safe_push (-2);
+    }
+  info->cfg_start.safe_push (info->cfg_image.length ());
+
+  if (dflow == df_lr)
+    {
+      if (!info->hardware_regs_used)
+	info->hardware_regs_used = BITMAP_ALLOC (&df_bitmap_obstack);
+      bitmap_copy (info->hardware_regs_used, &df->hardware_regs_used);
+    }
+}
+
 
 /* Remove the entries not in BLOCKS from the LIST of length LEN, preserving
    the order of the remaining entries.  Returns the length of the resulting
@@ -1151,6 +1810,10 @@ df_prune_to_subcfg (int list[], unsigned len, bitmap blocks)
    BLOCKS_TO_CONSIDER are the blocks whose solution can either be
    examined or will be computed.  For calls from DF_ANALYZE, this is
    the set of blocks that has been passed to DF_SET_BLOCKS.
+
+   With -fincremental-dataflow, LR and LIVE are only re-solved from the
+   blocks that changed since they were last solved, see
+   df_incremental_dataflow.
 */
 
 void
@@ -1158,6 +1821,8 @@ df_analyze_problem (struct dataflow *dflow,
 		    bitmap blocks_to_consider,
 		    int *postorder, int n_blocks)
 {
+  bitmap seeds, touched = NULL;
+
   timevar_push (dflow->problem->tv_id);
 
   /* (Re)Allocate the datastructures necessary to solve the problem.  */
@@ -1169,18 +1834,50 @@ df_analyze_problem (struct dataflow *dflow,
     dflow->problem->verify_start_fun ();
 #endif
 
+  /* Find the blocks the problem has to be re-solved from, while their
+     transfer functions are still marked out of date.  */
+  seeds = df_incremental_seeds (dflow, blocks_to_consider);
+
   /* Set up the problem and compute the local information.  */
   if (dflow->problem->local_compute_fun)
     dflow->problem->local_compute_fun (blocks_to_consider);
 
+  /* The registers live everywhere feed every block of LR.  */
+  if (seeds
+      && dflow == df_lr
+      && !bitmap_equal_p (&df->hardware_regs_used,
+			  df_incremental[DF_LR].hardware_regs_used))
+    BITMAP_FREE (seeds);
+
   /* Solve the equations.  */
-  if (dflow->problem->dataflow_fun)
+  if (seeds)
+    {
+      touched = BITMAP_ALLOC (&df_bitmap_obstack);
+      df_incremental_dataflow (dflow, blocks_to_consider, seeds, touched,
+			       postorder, n_blocks);
+    }
+  else if (dflow->problem->dataflow_fun)
     dflow->problem->dataflow_fun (dflow, blocks_to_consider,
 				  postorder, n_blocks);
 
-  /* Massage the solution.  */
+  /* Massage the solution.  LIVE only needs to trim the blocks that were
+     re-solved; the fast dce of LR needs all of them.  */
   if (dflow->problem->finalize_fun)
-    dflow->problem->finalize_fun (blocks_to_consider);
+    dflow->problem->finalize_fun (touched && dflow == df_live
+				  ? touched : blocks_to_consider);
+
+#ifdef ENABLE_DF_CHECKING
+  if (seeds)
+#else
+  if (seeds && flag_incremental_dataflow_check)
+#endif
+    df_incremental_verify (dflow, blocks_to_consider, postorder, n_blocks);
+  df_incremental_record (dflow, blocks_to_consider, seeds);
+  if (seeds)
+    {
+      BITMAP_FREE (seeds);
+      BITMAP_FREE (touched);
+    }
 
 #ifdef ENABLE_DF_CHECKING
   if (dflow->problem->verify_end_fun)
@@ -1513,7 +2210,7 @@ df_simple_dataflow (enum df_flow_dir dir,
   user_problem.con_fun_n = con_fun_n;
   user_problem.trans_fun = trans_fun;
   user_dflow.problem = &user_problem;
-  df_worklist_dataflow (&user_dflow, blocks, postorder, n_blocks);
+  df_worklist_dataflow_1 (&user_dflow, blocks, NULL, postorder, n_blocks);
 }
 
 
@@ -1653,11 +2350,21 @@ df_clear_bb_dirty (basic_block bb)
 void
 df_compact_blocks (void)
 {
-  int i, p;
+  int i, p, *map;
   basic_block bb;
   void *problem_temps;
   bitmap_head tmp;
 
+  /* Tell the incremental solutions where the blocks go.  */
+  map = XNEWVEC (int, last_basic_block_for_fn (cfun));
+  for (i = 0; i < last_basic_block_for_fn (cfun); i++)
+    map[i] = i < NUM_FIXED_BLOCKS ? i : -1;
+  i = NUM_FIXED_BLOCKS;
+  FOR_EACH_BB_FN (bb, cfun)
+    map[bb->index] = i++;
+  df_incremental_renumber (map);
+  free (map);
+
   bitmap_initialize (&tmp, &df_bitmap_obstack);
   for (p = 0; p < df->num_problems_defined; p++)
     {
@@ -1767,6 +2474,7 @@ df_bb_replace (int old_index, basic_block new_block)
   gcc_assert (df);
   gcc_assert (BASIC_BLOCK_FOR_FN (cfun, old_index) == NULL);
 
+  df_incremental_invalidate ();
   for (p = 0; p < df->num_problems_defined; p++)
     {
       struct dataflow *dflow = df->problems_in_order[p];
@@ -35,6 +35,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "valtrack.h"
 #include "dumpfile.h"
 #include "rtl-iter.h"
+#include "params.h"
 
 /* Note that turning REG_DEAD_DEBUGGING on will cause
    gcc.c-torture/unsorted/dump-noaddr.c to fail because it prints
@@ -766,6 +767,8 @@ df_lr_alloc (bitmap all_blocks ATTRIBUTE_UNUSED)
       problem_data->out = NULL;
       problem_data->in = NULL;
       bitmap_obstack_initialize (&problem_data->lr_bitmaps);
+      bitmap_obstack_set_hybrid (&problem_data->lr_bitmaps,
+				 PARAM_VALUE (PARAM_HYBRID_BITMAPS));
     }
 
   EXECUTE_IF_SET_IN_BITMAP (df_lr->out_of_date_transfer_functions, 0, bb_index, bi)
@@ -1371,6 +1374,8 @@ df_live_alloc (bitmap all_blocks ATTRIBUTE_UNUSED)
       problem_data->out = NULL;
       problem_data->in = NULL;
       bitmap_obstack_initialize (&problem_data->live_bitmaps);
+      bitmap_obstack_set_hybrid (&problem_data->live_bitmaps,
+				 PARAM_VALUE (PARAM_HYBRID_BITMAPS));
       bitmap_initialize (&df_live_scratch, &problem_data->live_bitmaps);
     }
 
@@ -635,6 +635,21 @@ dump_flag_name (int phase) const
   return dfi->swtch;
 }
 
+/* Disable all the dumps, in a forked process that must not write to
+   the dump files of its parent.  */
+
+void
+gcc::dump_manager::
+dump_disable_all (void)
+{
+  size_t i;
+
+  for (i = TDI_none + 1; i < (size_t) TDI_end; i++)
+    dump_files[i].pstate = dump_files[i].alt_state = 0;
+  for (i = 0; i < m_extra_dump_files_in_use; i++)
+    m_extra_dump_files[i].pstate = m_extra_dump_files[i].alt_state = 0;
+}
+
 /* Finish a tree dump for PHASE. STREAM is the stream created by
    dump_begin.  */
 
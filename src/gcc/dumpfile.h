@@ -219,6 +219,11 @@ public:
   const char *
   dump_flag_name (int phase) const;
 
+  /* Disable all the dumps, in a forked process that must not write to
+     the dump files of its parent.  */
+  void
+  dump_disable_all (void);
+
 private:
 
   int
@@ -2708,6 +2708,9 @@ typedef struct GTY((chain_circular ("%h.die_sib"), for_user)) die_struct {
   /* Die is used and must not be pruned as unused.  */
   BOOL_BITFIELD die_perennial_p : 1;
   BOOL_BITFIELD comdat_type_p : 1; /* DIE has a type signature */
+  /* DIE was written out by stream_function_die and is no longer part
+     of the tree that dwarf2out_finish outputs.  */
+  BOOL_BITFIELD die_streamed_p : 1;
   /* Lots of spare bits.  */
 }
 die_node;
@@ -3099,6 +3102,43 @@ static GTY(()) unsigned ranges_by_label_in_use;
 /* Whether we have location lists that need outputting */
 static GTY(()) bool have_location_lists;
 
+/* Whether -fstream-dwarf2 is in effect for this compilation unit, i.e.
+   completed function DIEs are written to a subsection of .debug_info as
+   soon as the function has been assembled.  */
+static bool stream_dwarf;
+
+/* The concrete DIE of the function being assembled, if it is a candidate
+   for stream_function_die.  */
+static GTY(()) dw_die_ref stream_candidate_die;
+
+/* Set while stream_function_die resolves the addresses in a subtree.  */
+static bool resolving_streamed_die;
+
+/* Set when an address in that subtree refers to a symbol that may only
+   be output later.  */
+static bool streamed_die_deferred;
+
+/* The subtree whose unused types stream_function_die is pruning.  The
+   marking does not leave it, and the strings are counted only once the
+   main compilation unit is pruned.  */
+static dw_die_ref streamed_prune_root;
+
+/* Whether any DIEs have been streamed.  The main compilation unit then
+   has children even if none are left in the tree, and its sibling
+   list is terminated after the streamed DIEs.  */
+static GTY(()) bool have_streamed_dies;
+
+/* DIEs of the main compilation unit referenced from streamed DIEs.
+   They are kept by prune_unused_types.  */
+static GTY(()) vec<dw_die_ref, va_gc> *streamed_die_refs;
+
+/* Strings referenced through DW_FORM_strp from streamed DIEs.  */
+static GTY (()) hash_table<indirect_string_hasher> *streamed_str_hash;
+
+/* The child of the abbreviation representatives that stand in for
+   streamed DIEs with children.  */
+static GTY(()) dw_die_ref streamed_abbrev_child;
+
 /* Unique label counter.  */
 static GTY(()) unsigned int loclabel_num;
 
@@ -3274,6 +3314,7 @@ static void output_die_symbol (dw_die_ref);
 static void output_die (dw_die_ref);
 static void output_compilation_unit_header (void);
 static void output_comp_unit (dw_die_ref, int);
+static void stream_function_die (tree, dw_die_ref);
 static void output_comdat_type_unit (comdat_type_node *);
 static const char *dwarf2_name (tree, int);
 static void add_pubname (tree, dw_die_ref);
@@ -3609,6 +3650,12 @@ new_addr_loc_descr (rtx addr, enum dtprel_bool dtprel)
 #ifndef DEBUG_INFO_SECTION_LABEL
 #define DEBUG_INFO_SECTION_LABEL           "Ldebug_info"
 #endif
+#ifndef DEBUG_INFO_START_LABEL
+#define DEBUG_INFO_START_LABEL             "Ldebug_info_start"
+#endif
+#ifndef DEBUG_INFO_END_LABEL
+#define DEBUG_INFO_END_LABEL               "Ldebug_info_end"
+#endif
 #ifndef DEBUG_SKELETON_INFO_SECTION_LABEL
 #define DEBUG_SKELETON_INFO_SECTION_LABEL   "Lskeleton_debug_info"
 #endif
@@ -3648,6 +3695,8 @@ static char cold_text_section_label[MAX_ARTIFICIAL_LABEL_BYTES];
 static char cold_end_label[MAX_ARTIFICIAL_LABEL_BYTES];
 static char abbrev_section_label[MAX_ARTIFICIAL_LABEL_BYTES];
 static char debug_info_section_label[MAX_ARTIFICIAL_LABEL_BYTES];
+static char debug_info_start_label[MAX_ARTIFICIAL_LABEL_BYTES];
+static char debug_info_end_label[MAX_ARTIFICIAL_LABEL_BYTES];
 static char debug_skeleton_info_section_label[MAX_ARTIFICIAL_LABEL_BYTES];
 static char debug_skeleton_abbrev_section_label[MAX_ARTIFICIAL_LABEL_BYTES];
 static char debug_line_section_label[MAX_ARTIFICIAL_LABEL_BYTES];
@@ -8233,6 +8282,16 @@ optimize_external_refs (dw_die_ref die)
   return map;
 }
 
+/* Return true if DIE is output with children.  The main compilation
+   unit has children once any DIEs have been streamed into it.  */
+
+static inline bool
+die_has_children_p (dw_die_ref die)
+{
+  return (die->die_child != NULL
+	  || (have_streamed_dies && die == single_comp_unit_die));
+}
+
 /* The format of each DIE (and its attribute value pairs) is encoded in an
    abbreviation table.  This routine builds the abbreviation table and assigns
    a unique abbreviation id for each abbreviation entry.  The children of each
@@ -8274,7 +8333,7 @@ build_abbrev_table (dw_die_ref die, external_ref_hash_type *extern_map)
 
       if (abbrev->die_tag != die->die_tag)
 	continue;
-      if ((abbrev->die_child != NULL) != (die->die_child != NULL))
+      if (die_has_children_p (abbrev) != die_has_children_p (die))
 	continue;
 
       if (vec_safe_length (abbrev->die_attr) != vec_safe_length (die->die_attr))
@@ -8520,7 +8579,7 @@ calc_die_sizes (dw_die_ref die)
 
   FOR_EACH_CHILD (die, c, calc_die_sizes (c));
 
-  if (die->die_child != NULL)
+  if (die_has_children_p (die))
     /* Count the null byte used to terminate sibling lists.  */
     next_die_offset += 1;
 }
@@ -8922,7 +8981,7 @@ output_die_abbrevs (unsigned long abbrev_id, dw_die_ref abbrev)
   dw2_asm_output_data_uleb128 (abbrev->die_tag, "(TAG: %s)",
                                dwarf_tag_name (abbrev->die_tag));
 
-  if (abbrev->die_child != NULL)
+  if (die_has_children_p (abbrev))
     dw2_asm_output_data (1, DW_children_yes, "DW_children_yes");
   else
     dw2_asm_output_data (1, DW_children_no, "DW_children_no");
@@ -9491,8 +9550,11 @@ output_die (dw_die_ref die)
 
   FOR_EACH_CHILD (die, c, output_die (c));
 
-  /* Add null byte to terminate sibling list.  */
-  if (die->die_child != NULL)
+  /* Add null byte to terminate sibling list.  The children of the main
+     compilation unit continue with the streamed DIEs, and output_comp_unit
+     terminates them.  */
+  if (die->die_child != NULL
+      && (!have_streamed_dies || die != single_comp_unit_die))
     dw2_asm_output_data (1, 0, "end of children of DIE %#lx",
 			 (unsigned long) die->die_offset);
 }
@@ -9512,9 +9574,18 @@ output_compilation_unit_header (void)
       if (DWARF_INITIAL_LENGTH_SIZE - DWARF_OFFSET_SIZE == 4)
 	dw2_asm_output_data (4, 0xffffffff,
 	  "Initial length escape value indicating 64-bit DWARF extension");
-      dw2_asm_output_data (DWARF_OFFSET_SIZE,
-			   next_die_offset - DWARF_INITIAL_LENGTH_SIZE,
-			   "Length of Compilation Unit Info");
+      if (have_streamed_dies)
+	{
+	  /* The unit ends after the DIEs streamed into subsection 1.  */
+	  dw2_asm_output_delta (DWARF_OFFSET_SIZE, debug_info_end_label,
+				debug_info_start_label,
+				"Length of Compilation Unit Info");
+	  ASM_OUTPUT_LABEL (asm_out_file, debug_info_start_label);
+	}
+      else
+	dw2_asm_output_data (DWARF_OFFSET_SIZE,
+			     next_die_offset - DWARF_INITIAL_LENGTH_SIZE,
+			     "Length of Compilation Unit Info");
     }
 
   dw2_asm_output_data (2, ver, "DWARF version number");
@@ -9533,7 +9604,7 @@ output_comp_unit (dw_die_ref die, int output_if_empty)
   char *tmp;
 
   /* Unless we are outputting main CU, we may throw away empty ones.  */
-  if (!output_if_empty && die->die_child == NULL)
+  if (!output_if_empty && !die_has_children_p (die))
     return;
 
   /* Even if there are no children of this DIE, we must output the information
@@ -9574,6 +9645,16 @@ output_comp_unit (dw_die_ref die, int output_if_empty)
   output_compilation_unit_header ();
   output_die (die);
 
+  if (have_streamed_dies && !oldsym)
+    {
+      /* Terminate the children of the unit after the streamed DIEs.  */
+      fputs ("\t.subsection\t1\n", asm_out_file);
+      dw2_asm_output_data (1, 0, "end of children of DIE %#lx",
+			   (unsigned long) die->die_offset);
+      ASM_OUTPUT_LABEL (asm_out_file, debug_info_end_label);
+      fputs ("\t.subsection\t0\n", asm_out_file);
+    }
+
   /* Leave the marks on the main CU, so we can check them in
      output_pubnames.  */
   if (oldsym)
@@ -20568,6 +20649,9 @@ gen_subprogram_die (tree decl, dw_die_ref context_die)
 
       struct function *fun = DECL_STRUCT_FUNCTION (decl);
 
+      if (stream_dwarf && decl == current_function_decl)
+	stream_candidate_die = subr_die;
+
       if (!flag_reorder_blocks_and_partition)
 	{
 	  dw_fde_ref fde = fun->fde;
@@ -24094,6 +24178,11 @@ static void
 dwarf2out_function_decl (tree decl)
 {
   dwarf2out_decl (decl);
+  if (stream_candidate_die)
+    {
+      stream_function_die (decl, stream_candidate_die);
+      stream_candidate_die = NULL;
+    }
   call_arg_locations = NULL;
   call_arg_loc_last = NULL;
   call_site_count = -1;
@@ -25542,6 +25631,28 @@ dwarf2out_init (const char *filename ATTRIBUTE_UNUSED)
 			       : DEBUG_MACRO_SECTION_LABEL, 0);
   ASM_GENERATE_INTERNAL_LABEL (loc_section_label, DEBUG_LOC_SECTION_LABEL, 0);
 
+  /* Streaming function DIEs needs assembler subsections, and is not done
+     for the output modes that rework the whole DIE tree at the end.  */
+#ifdef OBJECT_FORMAT_ELF
+  stream_dwarf = (flag_stream_dwarf2
+		  && !dwarf_split_debug_info
+		  && !use_debug_types
+		  && !flag_eliminate_dwarf2_dups
+		  && !want_pubnames ()
+		  && (dwarf_version >= 3 || !dwarf_strict));
+#endif
+  if (stream_dwarf)
+    {
+      ASM_GENERATE_INTERNAL_LABEL (debug_info_start_label,
+				   DEBUG_INFO_START_LABEL, 0);
+      ASM_GENERATE_INTERNAL_LABEL (debug_info_end_label,
+				   DEBUG_INFO_END_LABEL, 0);
+      /* Location lists of streamed DIEs are output before we know
+	 whether all code goes to .text, so always use absolute
+	 addresses in them.  */
+      have_multiple_function_sections = true;
+    }
+
   if (debug_info_level >= DINFO_LEVEL_VERBOSE)
     vec_alloc (macinfo_table, 64);
 
@@ -25834,7 +25945,8 @@ prune_unused_types_walk_attribs (dw_die_ref die)
 	case dw_val_class_str:
 	  /* Set the string's refcount to 0 so that prune_unused_types_mark
 	     accounts properly for it.  */
-	  a->dw_attr_val.v.val_str->refcount = 0;
+	  if (!streamed_prune_root)
+	    a->dw_attr_val.v.val_str->refcount = 0;
 	  break;
 
 	default:
@@ -25861,6 +25973,58 @@ prune_unused_types_mark_generic_parms_dies (dw_die_ref die)
     } while (c && c != die->die_child);
 }
 
+/* Return true if DIE is part of the subtree that stream_function_die
+   prunes.  */
+
+static bool
+streamed_prune_die_p (dw_die_ref die)
+{
+  for (; die; die = die->die_parent)
+    if (die == streamed_prune_root)
+      return true;
+  return false;
+}
+
+static void prune_unused_types_mark (dw_die_ref, int);
+
+/* DIE lies outside the subtree that stream_function_die prunes.  If it is
+   a derived type, such as an array type, which are put in the compilation
+   unit even if their element type is local to the function, mark the
+   types it is derived from.  */
+
+static void
+prune_streamed_derived_type (dw_die_ref die)
+{
+  dw_attr_node *a;
+  dw_die_ref c;
+  unsigned ix;
+
+  switch (die->die_tag)
+    {
+    case DW_TAG_array_type:
+    case DW_TAG_subrange_type:
+    case DW_TAG_pointer_type:
+    case DW_TAG_reference_type:
+    case DW_TAG_rvalue_reference_type:
+    case DW_TAG_const_type:
+    case DW_TAG_volatile_type:
+    case DW_TAG_restrict_type:
+    case DW_TAG_atomic_type:
+    case DW_TAG_packed_type:
+    case DW_TAG_ptr_to_member_type:
+    case DW_TAG_subroutine_type:
+    case DW_TAG_formal_parameter:
+      break;
+    default:
+      return;
+    }
+
+  FOR_EACH_VEC_SAFE_ELT (die->die_attr, ix, a)
+    if (AT_class (a) == dw_val_class_die_ref)
+      prune_unused_types_mark (AT_ref (a), 1);
+  FOR_EACH_CHILD (die, c, prune_streamed_derived_type (c));
+}
+
 /* Mark DIE as being used.  If DOKIDS is true, then walk down
    to DIE's children.  */
 
@@ -25869,6 +26033,16 @@ prune_unused_types_mark (dw_die_ref die, int dokids)
 {
   dw_die_ref c;
 
+  /* Streamed DIEs have been output already, together with everything
+     they refer to.  */
+  if (die->die_streamed_p)
+    return;
+  if (streamed_prune_root && !streamed_prune_die_p (die))
+    {
+      prune_streamed_derived_type (die);
+      return;
+    }
+
   if (die->die_mark == 0)
     {
       /* We haven't done this node yet.  Mark it as used.  */
@@ -26065,7 +26239,8 @@ prune_unused_types_prune (dw_die_ref die)
   dw_die_ref c;
 
   gcc_assert (die->die_mark);
-  prune_unused_types_update_strings (die);
+  if (!streamed_prune_root)
+    prune_unused_types_update_strings (die);
 
   if (! die->die_child)
     return;
@@ -26094,6 +26269,25 @@ prune_unused_types_prune (dw_die_ref die)
   } while (c != die->die_child);
 }
 
+/* Put a string referenced from streamed DIEs back into the .debug_str
+   table after prune_unused_types has recounted the references to it.
+   Called through hash_table::traverse.  */
+
+int
+add_streamed_string (indirect_string_node **h, void *)
+{
+  struct indirect_string_node *node = *h;
+  indirect_string_node **slot
+    = debug_str_hash->find_slot_with_hash (node->str,
+					   htab_hash_string (node->str),
+					   INSERT);
+
+  if (*slot == NULL)
+    *slot = node;
+  node->refcount++;
+  return 1;
+}
+
 /* Remove dies representing declarations that we never use.  */
 
 static void
@@ -26103,7 +26297,7 @@ prune_unused_types (void)
   limbo_die_node *node;
   comdat_type_node *ctnode;
   pubname_entry *pub;
-  dw_die_ref base_type;
+  dw_die_ref base_type, ref;
 
 #if ENABLE_ASSERT_CHECKING
   /* All the marks should already be clear.  */
@@ -26136,6 +26330,8 @@ prune_unused_types (void)
       prune_unused_types_mark (pub->die, 1);
   for (i = 0; base_types.iterate (i, &base_type); i++)
     prune_unused_types_mark (base_type, 1);
+  FOR_EACH_VEC_SAFE_ELT (streamed_die_refs, i, ref)
+    prune_unused_types_mark (ref, 1);
 
   if (debug_str_hash)
     debug_str_hash->empty ();
@@ -26155,6 +26351,8 @@ prune_unused_types (void)
     }
   for (ctnode = comdat_type_list; ctnode; ctnode = ctnode->next)
     prune_unused_types_prune (ctnode->root_die);
+  if (streamed_str_hash)
+    streamed_str_hash->traverse<void *, add_streamed_string> (NULL);
 
   /* Leave the marks clear.  */
   prune_unmark_dies (comp_unit_die ());
@@ -26347,6 +26545,50 @@ move_marked_base_types (void)
     }
 }
 
+/* Return true if DECL has been assembled, or, while stream_function_die
+   resolves addresses, if it is certain to be assembled in this
+   compilation unit.  */
+
+static bool
+decl_asm_written_p (tree decl)
+{
+  if (TREE_ASM_WRITTEN (decl))
+    return true;
+  if (!resolving_streamed_die || DECL_EXTERNAL (decl))
+    return false;
+
+  if (TREE_CODE (decl) == FUNCTION_DECL)
+    {
+      cgraph_node *node = cgraph_node::get (decl);
+      return node && node->process && !node->global.inlined_to;
+    }
+  if (TREE_CODE (decl) == VAR_DECL)
+    {
+      varpool_node *node = varpool_node::get (decl);
+      return (node
+	      && node->definition
+	      && !node->alias
+	      && !node->in_other_partition
+	      && !DECL_HARD_REGISTER (decl)
+	      && !DECL_HAS_VALUE_EXPR_P (decl));
+    }
+  return false;
+}
+
+/* Helper function for resolve_addr, called for an address that refers to
+   something that has not been output.  The rest of the compilation may
+   still output it, so while resolving a subtree for stream_function_die
+   keep the address as it is and leave the subtree for dwarf2out_finish.  */
+
+static bool
+defer_streamed_die_addr (void)
+{
+  if (!resolving_streamed_die)
+    return false;
+  streamed_die_deferred = true;
+  return true;
+}
+
 /* Helper function for resolve_addr, attempt to resolve
    one CONST_STRING, return true if successful.  Similarly verify that
    SYMBOL_REFs refer to variables emitted in the current CU.  */
@@ -26365,12 +26607,12 @@ resolve_one_addr (rtx *addr)
 	= build_array_type (char_type_node, build_index_type (tlen));
       rtl = lookup_constant_def (t);
       if (!rtl || !MEM_P (rtl))
-	return false;
+	return defer_streamed_die_addr ();
       rtl = XEXP (rtl, 0);
       if (GET_CODE (rtl) == SYMBOL_REF
 	  && SYMBOL_REF_DECL (rtl)
 	  && !TREE_ASM_WRITTEN (SYMBOL_REF_DECL (rtl)))
-	return false;
+	return defer_streamed_die_addr ();
       vec_safe_push (used_rtx_array, rtl);
       *addr = rtl;
       return true;
@@ -26382,10 +26624,11 @@ resolve_one_addr (rtx *addr)
       if (TREE_CONSTANT_POOL_ADDRESS_P (rtl))
 	{
 	  if (!TREE_ASM_WRITTEN (DECL_INITIAL (SYMBOL_REF_DECL (rtl))))
-	    return false;
+	    return defer_streamed_die_addr ();
 	}
-      else if (!TREE_ASM_WRITTEN (SYMBOL_REF_DECL (rtl)))
-	return false;
+      else if (!decl_asm_written_p (SYMBOL_REF_DECL (rtl)))
+	return (!DECL_EXTERNAL (SYMBOL_REF_DECL (rtl))
+		&& defer_streamed_die_addr ());
     }
 
   if (GET_CODE (rtl) == CONST)
@@ -26929,8 +27172,11 @@ resolve_addr (dw_die_ref die)
 		    curr = &(*curr)->dw_loc_next;
 		  }
 	      }
+	    /* dwarf2out_finish resolves the lists again that
+	       stream_function_die has not output, and counts the base
+	       types they use.  */
 	    if (loc == *start)
-	      loc->resolved_addr = 1;
+	      loc->resolved_addr = !resolving_streamed_die;
 	    else
 	      {
 		loc->replaced = 1;
@@ -27049,7 +27295,7 @@ resolve_addr (dw_die_ref die)
 		a->dw_attr_val.v.val_die_ref.die = tdie;
 		a->dw_attr_val.v.val_die_ref.external = 0;
 	      }
-	    else
+	    else if (!defer_streamed_die_addr ())
 	      {
                 if (AT_index (a) != NOT_INDEXED)
                   remove_addr_table_entry (a->dw_attr_val.val_entry);
@@ -27605,6 +27851,368 @@ optimize_location_lists (dw_die_ref die)
   optimize_location_lists_1 (die, &htab);
 }
 
+/* Return true if the location description LOC can be output without
+   knowing where the DIEs of the main compilation unit end up.  */
+
+static bool
+streamable_loc_descr_p (dw_loc_descr_ref loc)
+{
+  for (; loc; loc = loc->dw_loc_next)
+    {
+      if (loc->dw_loc_oprnd1.val_class == dw_val_class_die_ref
+	  || loc->dw_loc_oprnd1.val_class == dw_val_class_decl_ref
+	  || loc->dw_loc_oprnd2.val_class == dw_val_class_die_ref
+	  || loc->dw_loc_oprnd2.val_class == dw_val_class_decl_ref)
+	return false;
+      if (loc->dw_loc_opc == DW_OP_GNU_entry_value
+	  && !streamable_loc_descr_p (loc->dw_loc_oprnd1.v.val_loc))
+	return false;
+    }
+  return true;
+}
+
+/* Return true if DIE and its children are complete and can be output on
+   their own, with references to other DIEs in DW_FORM_ref_addr.  */
+
+static bool
+streamable_die_p (dw_die_ref die)
+{
+  dw_attr_node *a;
+  dw_loc_list_ref list;
+  dw_die_ref c;
+  unsigned ix;
+
+  if (die->die_tag == DW_TAG_dwarf_procedure)
+    return false;
+
+  FOR_EACH_VEC_SAFE_ELT (die->die_attr, ix, a)
+    switch (AT_class (a))
+      {
+      case dw_val_class_loc:
+	if (!streamable_loc_descr_p (AT_loc (a)))
+	  return false;
+	break;
+      case dw_val_class_loc_list:
+	for (list = AT_loc_list (a); list; list = list->dw_loc_next)
+	  if (!streamable_loc_descr_p (list->expr))
+	    return false;
+	break;
+      default:
+	break;
+      }
+
+  /* Nested functions and member functions of local classes are added
+     here when they are assembled themselves.  */
+  FOR_EACH_CHILD (die, c,
+		  if ((c->die_tag == DW_TAG_subprogram
+		       && (is_type_die (die) || !is_declaration_die (c)))
+		      || !streamable_die_p (c))
+		    return false);
+  return true;
+}
+
+/* Return true if no DIE for the variables declared in BLOCK and its
+   subblocks is completed only after the function has been assembled.  */
+
+static bool
+streamable_block_p (tree block)
+{
+  for (; block; block = BLOCK_CHAIN (block))
+    {
+      for (tree var = BLOCK_VARS (block); var; var = DECL_CHAIN (var))
+	/* Function-scope statics get their location when they are
+	   assembled, in dwarf2out_late_global_decl.  */
+	if (TREE_CODE (var) == VAR_DECL
+	    && TREE_STATIC (var)
+	    && !DECL_EXTERNAL (var))
+	  return false;
+      if (!streamable_block_p (BLOCK_SUBBLOCKS (block)))
+	return false;
+    }
+  return true;
+}
+
+/* Return true if a decl in BLOCK or its subblocks has a variably modified
+   type.  The DIEs of such types may be put in the compilation unit, and
+   refer to types local to the function.  */
+
+static bool
+variably_modified_block_p (tree block)
+{
+  for (; block; block = BLOCK_CHAIN (block))
+    {
+      for (tree var = BLOCK_VARS (block); var; var = DECL_CHAIN (var))
+	if (TREE_TYPE (var)
+	    && variably_modified_type_p (TREE_TYPE (var), NULL_TREE))
+	  return true;
+      if (variably_modified_block_p (BLOCK_SUBBLOCKS (block)))
+	return true;
+    }
+  return false;
+}
+
+/* Give DIE a symbol if it may be referred to after it has been streamed,
+   and give one to every DIE it refers to.  Record the referenced DIEs of
+   the main compilation unit, i.e. those that are not marked.  */
+
+static void
+assign_streamed_die_symbols (dw_die_ref die)
+{
+  dw_attr_node *a;
+  dw_die_ref c;
+  unsigned ix;
+
+  if (!die->die_id.die_symbol
+      && (die->die_tag == DW_TAG_formal_parameter
+	  || is_type_die (die)
+	  || is_declaration_die (die)
+	  || ((die->die_tag == DW_TAG_variable
+	       || die->die_tag == DW_TAG_label)
+	      && get_AT (die, DW_AT_abstract_origin))
+	  /* The bounds of variable length arrays.  */
+	  || (die->die_tag == DW_TAG_variable
+	      && get_AT_flag (die, DW_AT_artificial))))
+    die->die_id.die_symbol = gen_internal_sym ("LDIE");
+
+  FOR_EACH_VEC_SAFE_ELT (die->die_attr, ix, a)
+    if (AT_class (a) == dw_val_class_die_ref
+	&& !(c = AT_ref (a))->die_id.die_symbol)
+      {
+	c->die_id.die_symbol = gen_internal_sym ("LDIE");
+	if (!c->die_mark && !c->die_streamed_p)
+	  vec_safe_push (streamed_die_refs, c);
+      }
+
+  FOR_EACH_CHILD (die, c, assign_streamed_die_symbols (c));
+}
+
+/* Flag DIE and its children as streamed, record the strings they put in
+   .debug_str, and unlink the children so that the DIEs nobody refers to
+   any more can be collected.  */
+
+static void
+release_streamed_dies (dw_die_ref die)
+{
+  dw_attr_node *a;
+  dw_die_ref c, next, last;
+  unsigned ix;
+
+  die->die_streamed_p = 1;
+
+  FOR_EACH_VEC_SAFE_ELT (die->die_attr, ix, a)
+    if (AT_class (a) == dw_val_class_str
+	&& AT_string_form (a) == DW_FORM_strp)
+      {
+	struct indirect_string_node *node = a->dw_attr_val.v.val_str;
+	indirect_string_node **slot;
+
+	if (!streamed_str_hash)
+	  streamed_str_hash = hash_table<indirect_string_hasher>::create_ggc (64);
+	slot = streamed_str_hash->find_slot_with_hash (node->str,
+						       htab_hash_string (node->str),
+						       INSERT);
+	*slot = node;
+      }
+
+  last = die->die_child;
+  if (last)
+    {
+      c = last->die_sib;
+      do
+	{
+	  next = c->die_sib;
+	  release_streamed_dies (c);
+	  c->die_parent = NULL;
+	  c->die_sib = NULL;
+	}
+      while (c != last && (c = next));
+    }
+  die->die_child = NULL;
+}
+
+/* Drop the references from the BLOCK tree of a streamed function, and
+   from decl_die_table, to the DIEs of its local variables and labels.
+   The DIEs of the variables and labels of an out-of-line copy of an inline
+   function stay in decl_die_table, as inlined copies compiled later use
+   them as abstract origins.  */
+
+static void
+forget_streamed_block_dies (tree block)
+{
+  for (; block; block = BLOCK_CHAIN (block))
+    {
+      if (BLOCK_DIE (block) && BLOCK_DIE (block)->die_streamed_p)
+	BLOCK_DIE (block) = NULL;
+      for (tree var = BLOCK_VARS (block); var; var = DECL_CHAIN (var))
+	if ((TREE_CODE (var) == VAR_DECL && !DECL_EXTERNAL (var))
+	    || TREE_CODE (var) == LABEL_DECL)
+	  {
+	    dw_die_ref die = lookup_decl_die (var);
+	    if (die
+		&& die->die_streamed_p
+		&& (DECL_ORIGIN (var) != var
+		    || !get_AT (die, DW_AT_abstract_origin)))
+	      decl_die_table->remove_elt_with_hash (var, DECL_UID (var));
+	  }
+      forget_streamed_block_dies (BLOCK_SUBBLOCKS (block));
+    }
+}
+
+/* Output the DIE of the function DECL, which has just been assembled,
+   and its children into subsection 1 of .debug_info, if they are
+   complete.  The streamed DIEs follow the DIEs that dwarf2out_finish
+   outputs for the main compilation unit, and refer to each other and to
+   those DIEs through symbols.  Afterwards only the DIEs that may still
+   be referred to are kept, with their children unlinked.  */
+
+static void
+stream_function_die (tree decl, dw_die_ref die)
+{
+  section *saved_section = in_section;
+  unsigned long abbrev_id;
+  unsigned ix;
+  limbo_die_node *node;
+  die_arg_entry *e;
+  dw_die_ref base_type;
+  bool ok = true;
+
+  if (die->die_parent != comp_unit_die ()
+      || decl_function_context (decl)
+      || !streamable_block_p (DECL_INITIAL (decl)))
+    return;
+
+  cgraph_node *cnode = cgraph_node::get (decl);
+  if (cnode && cnode->nested)
+    return;
+
+  /* DIEs still waiting for their parent may end up in this function.  */
+  for (node = limbo_die_list; node; node = node->next)
+    if (node->die->die_parent == NULL && node->created_for)
+      for (tree t = node->created_for; t; )
+	{
+	  if (t == decl)
+	    return;
+	  if (TREE_CODE (t) == BLOCK)
+	    t = BLOCK_SUPERCONTEXT (t);
+	  else if (DECL_P (t) || TYPE_P (t))
+	    t = get_containing_scope (t);
+	  else
+	    break;
+	}
+
+  /* Resolve the addresses now, trusting the symbols that the rest of
+     the compilation will assemble.  */
+  resolving_streamed_die = true;
+  streamed_die_deferred = false;
+  resolve_addr (die);
+  resolving_streamed_die = false;
+
+  /* dwarf2out_finish counts the uses of the base types again.  */
+  FOR_EACH_VEC_ELT (base_types, ix, base_type)
+    base_type->die_mark = 0;
+  base_types.truncate (0);
+
+  if (streamed_die_deferred || !streamable_die_p (die))
+    return;
+
+  /* Remove the types local to the function that it does not use, as
+     prune_unused_types would.  */
+  if (flag_eliminate_unused_debug_types
+      && !variably_modified_block_p (DECL_INITIAL (decl)))
+    {
+      streamed_prune_root = die;
+      prune_unused_types_walk (die);
+      prune_unused_types_prune (die);
+      prune_unmark_dies (die);
+      streamed_prune_root = NULL;
+    }
+
+  mark_dies (die);
+  /* The values of template value parameters are only added at the end.  */
+  FOR_EACH_VEC_SAFE_ELT (tmpl_value_parm_die_table, ix, e)
+    if (e->die->die_mark)
+      ok = false;
+  if (ok)
+    {
+      if (!die->die_id.die_symbol)
+	die->die_id.die_symbol = gen_internal_sym ("LDIE");
+      assign_streamed_die_symbols (die);
+    }
+  unmark_dies (die);
+  if (!ok)
+    return;
+
+  /* With no DIE marked, every reference is to a symbol.  The DIEs
+     representing the new abbreviations are replaced by copies without
+     relatives, so that they do not keep the subtree alive.  */
+  abbrev_id = abbrev_die_table_in_use;
+  external_ref_hash_type extern_map (10);
+  build_abbrev_table (die, &extern_map);
+  for (; abbrev_id < abbrev_die_table_in_use; abbrev_id++)
+    {
+      dw_die_ref abbrev = abbrev_die_table[abbrev_id];
+      dw_die_ref copy = ggc_cleared_alloc<die_node> ();
+
+      copy->die_tag = abbrev->die_tag;
+      copy->die_attr = vec_safe_copy (abbrev->die_attr);
+      if (abbrev->die_child)
+	{
+	  if (!streamed_abbrev_child)
+	    streamed_abbrev_child = ggc_cleared_alloc<die_node> ();
+	  copy->die_child = streamed_abbrev_child;
+	}
+      abbrev_die_table[abbrev_id] = copy;
+    }
+
+  /* Sizing the DIEs also settles the forms of their strings and the
+     branch offsets in their location expressions.  */
+  next_die_offset = 0;
+  calc_die_sizes (die);
+
+  /* Both the DIEs and their location lists go after those of the main
+     compilation unit, so that the two sections stay in the same order.  */
+  if (have_location_lists)
+    {
+      switch_to_section (debug_loc_section);
+      fputs ("\t.subsection\t1\n", asm_out_file);
+      output_location_lists (die);
+      fputs ("\t.subsection\t0\n", asm_out_file);
+    }
+  switch_to_section (debug_info_section);
+  fputs ("\t.subsection\t1\n", asm_out_file);
+  output_die (die);
+  fputs ("\t.subsection\t0\n", asm_out_file);
+  if (saved_section)
+    switch_to_section (saved_section);
+  have_streamed_dies = true;
+
+  release_streamed_dies (die);
+  forget_streamed_block_dies (DECL_INITIAL (decl));
+}
+
+/* Remove the streamed function DIEs from the children of DIE.  */
+
+static void
+remove_streamed_dies (dw_die_ref die)
+{
+  dw_die_ref c;
+
+  c = die->die_child;
+  if (c) do {
+    dw_die_ref prev = c;
+    c = c->die_sib;
+    while (c->die_streamed_p)
+      {
+	remove_child_with_prev (c, prev);
+	c->die_parent = NULL;
+	/* Might have removed every child.  */
+	if (c == c->die_sib)
+	  return;
+	c = c->die_sib;
+      }
+  } while (c != die->die_child);
+}
+
 /* Traverse the limbo die list, and add parent/child links.  The only
    dies without parents that should be here are concrete instances of
    inline functions, and the comp_unit_die.  We can ignore the comp_unit_die.
@@ -27674,6 +28282,10 @@ dwarf2out_finish (const char *filename)
   /* Flush out any latecomers to the limbo party.  */
   flush_limbo_die_list ();
 
+  /* Streamed function DIEs have been output already.  */
+  if (have_streamed_dies)
+    remove_streamed_dies (comp_unit_die ());
+
   /* We shouldn't have any symbols with delayed asm names for
      DIEs generated after early finish.  */
   gcc_assert (deferred_asm_name == NULL);
@@ -28115,6 +28727,12 @@ dwarf2out_c_finalize (void)
   ranges_by_label_allocated = 0;
   ranges_by_label_in_use = 0;
   have_location_lists = false;
+  stream_dwarf = false;
+  stream_candidate_die = NULL;
+  have_streamed_dies = false;
+  streamed_die_refs = NULL;
+  streamed_str_hash = NULL;
+  streamed_abbrev_child = NULL;
   loclabel_num = 0;
   poc_label_num = 0;
   last_emitted_file = NULL;
@@ -78,6 +78,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "asan.h"
 #include "rtl-iter.h"
 #include "print-rtl.h"
+#include "compile-cache.h"
 
 #ifdef XCOFF_DEBUGGING_INFO
 #include "xcoffout.h"		/* Needed for external data declarations.  */
@@ -4720,6 +4721,12 @@ public:
   {}
 
   /* opt_pass methods: */
+  virtual bool gate (function *fun)
+    {
+      /* The function is kept until its deferred RTL passes run.  */
+      return !compile_cache_deferred_p (fun->decl);
+    }
+
   virtual unsigned int execute (function *)
     {
       return rest_of_clean_state ();
@@ -277,7 +277,14 @@ enum lto_partition_model {
   LTO_PARTITION_ONE = 1,
   LTO_PARTITION_BALANCED = 2,
   LTO_PARTITION_1TO1 = 3,
-  LTO_PARTITION_MAX = 4
+  LTO_PARTITION_MAX = 4,
+  LTO_PARTITION_LOCALITY = 5
+};
+
+/* flag_lto_compression_algorithm initialization values.  */
+enum lto_compression_algorithm {
+  LTO_COMPRESSION_ZLIB = 0,
+  LTO_COMPRESSION_LZ = 1
 };
 
 /* flag_lto_linker_output initialization values.  */
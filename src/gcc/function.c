@@ -5045,6 +5045,17 @@ init_function_start (tree subr)
     warning (OPT_Waggregate_return, "function returns an aggregate");
 }
 
+/* Initialize the static variables for generating RTL for the function
+   SUBR again, after init_function_start was called for it and then for
+   other functions before its RTL is generated.  */
+
+void
+reinit_function_start (tree subr)
+{
+  prepare_function_start ();
+  decide_function_section (subr);
+}
+
 /* Expand code to verify the stack_protect_guard.  This is invoked at
    the end of a function to be protected.  */
 
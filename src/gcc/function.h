@@ -618,6 +618,7 @@ extern void push_dummy_function (bool);
 extern void pop_dummy_function (void);
 extern void init_dummy_function_start (void);
 extern void init_function_start (tree);
+extern void reinit_function_start (tree);
 extern void stack_protect_epilogue (void);
 extern void expand_function_start (tree);
 extern void expand_dummy_function_end (void);
@@ -272,6 +272,11 @@ static enum save_temps {
 static char *save_temps_prefix = 0;
 static size_t save_temps_length = 0;
 
+/* The number of input files that -j allows to be compiled at the same
+   time.  */
+
+static int parallel_jobs = 1;
+
 /* The compiler version.  */
 
 static const char *compiler_version;
@@ -3692,6 +3697,19 @@ handle_foffload_option (const char *arg)
     }
 }
 
+/* Return the number of processors, for -j auto.  */
+
+static int
+number_of_cpus (void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+  long n = sysconf (_SC_NPROCESSORS_ONLN);
+  if (n > 0)
+    return n;
+#endif
+  return 1;
+}
+
 /* Handle a driver option; arguments and return value as for
    handle_option.  */
 
@@ -3957,6 +3975,19 @@ driver_handle_option (struct gcc_options *opts,
       do_save = false;
       break;
 
+    case OPT_j:
+      if (*arg == '\0' || strcmp (arg, "auto") == 0)
+	parallel_jobs = number_of_cpus ();
+      else
+	{
+	  parallel_jobs = integral_argument (arg);
+	  if (parallel_jobs < 1)
+	    fatal_error (input_location, "%qs is not a valid number of jobs",
+			 decoded->orig_option_with_args_text);
+	}
+      do_save = false;
+      break;
+
     case OPT_pipe:
       validated = true;
       /* These options set the variables specified in common.opt
@@ -8007,125 +8038,314 @@ driver::prepare_infiles ()
   return false;
 }
 
-/* Run the spec machinery on each input file.  */
+/* Run the spec machinery on input file I.  */
 
 void
-driver::do_spec_on_infiles () const
+driver::do_spec_on_infile (size_t i) const
 {
-  size_t i;
+  int this_file_error = 0;
 
-  for (i = 0; (int) i < n_infiles; i++)
-    {
-      int this_file_error = 0;
+  /* Tell do_spec what to substitute for %i.  */
 
-      /* Tell do_spec what to substitute for %i.  */
+  input_file_number = i;
+  set_input (infiles[i].name);
 
-      input_file_number = i;
-      set_input (infiles[i].name);
+  if (infiles[i].compiled)
+    return;
 
-      if (infiles[i].compiled)
-	continue;
+  /* Use the same thing in %o, unless cp->spec says otherwise.  */
 
-      /* Use the same thing in %o, unless cp->spec says otherwise.  */
+  outfiles[i] = gcc_input_filename;
 
-      outfiles[i] = gcc_input_filename;
+  /* Figure out which compiler from the file's suffix.  */
 
-      /* Figure out which compiler from the file's suffix.  */
+  input_file_compiler
+    = lookup_compiler (infiles[i].name, input_filename_length,
+		       infiles[i].language);
 
-      input_file_compiler
-	= lookup_compiler (infiles[i].name, input_filename_length,
-			   infiles[i].language);
+  if (input_file_compiler)
+    {
+      /* Ok, we found an applicable compiler.  Run its spec.  */
 
-      if (input_file_compiler)
+      if (input_file_compiler->spec[0] == '#')
+	{
+	  error ("%s: %s compiler not installed on this system",
+		 gcc_input_filename, &input_file_compiler->spec[1]);
+	  this_file_error = 1;
+	}
+      else
 	{
-	  /* Ok, we found an applicable compiler.  Run its spec.  */
+	  int value;
 
-	  if (input_file_compiler->spec[0] == '#')
+	  if (compare_debug)
 	    {
-	      error ("%s: %s compiler not installed on this system",
-		     gcc_input_filename, &input_file_compiler->spec[1]);
-	      this_file_error = 1;
+	      free (debug_check_temp_file[0]);
+	      debug_check_temp_file[0] = NULL;
+
+	      free (debug_check_temp_file[1]);
+	      debug_check_temp_file[1] = NULL;
 	    }
-	  else
-	    {
-	      int value;
 
-	      if (compare_debug)
-		{
-		  free (debug_check_temp_file[0]);
-		  debug_check_temp_file[0] = NULL;
+	  value = do_spec (input_file_compiler->spec);
+	  infiles[i].compiled = true;
+	  if (value < 0)
+	    this_file_error = 1;
+	  else if (compare_debug && debug_check_temp_file[0])
+	    {
+	      if (verbose_flag)
+		inform (0, "recompiling with -fcompare-debug");
 
-		  free (debug_check_temp_file[1]);
-		  debug_check_temp_file[1] = NULL;
-		}
+	      compare_debug = -compare_debug;
+	      n_switches = n_switches_debug_check[1];
+	      n_switches_alloc = n_switches_alloc_debug_check[1];
+	      switches = switches_debug_check[1];
 
 	      value = do_spec (input_file_compiler->spec);
-	      infiles[i].compiled = true;
+
+	      compare_debug = -compare_debug;
+	      n_switches = n_switches_debug_check[0];
+	      n_switches_alloc = n_switches_alloc_debug_check[0];
+	      switches = switches_debug_check[0];
+
 	      if (value < 0)
-		this_file_error = 1;
-	      else if (compare_debug && debug_check_temp_file[0])
 		{
-		  if (verbose_flag)
-		    inform (0, "recompiling with -fcompare-debug");
+		  error ("during -fcompare-debug recompilation");
+		  this_file_error = 1;
+		}
 
-		  compare_debug = -compare_debug;
-		  n_switches = n_switches_debug_check[1];
-		  n_switches_alloc = n_switches_alloc_debug_check[1];
-		  switches = switches_debug_check[1];
+	      gcc_assert (debug_check_temp_file[1]
+			  && filename_cmp (debug_check_temp_file[0],
+					   debug_check_temp_file[1]));
 
-		  value = do_spec (input_file_compiler->spec);
+	      if (verbose_flag)
+		inform (0, "comparing final insns dumps");
 
-		  compare_debug = -compare_debug;
-		  n_switches = n_switches_debug_check[0];
-		  n_switches_alloc = n_switches_alloc_debug_check[0];
-		  switches = switches_debug_check[0];
+	      if (compare_files (debug_check_temp_file))
+		this_file_error = 1;
+	    }
 
-		  if (value < 0)
-		    {
-		      error ("during -fcompare-debug recompilation");
-		      this_file_error = 1;
-		    }
+	  if (compare_debug)
+	    {
+	      free (debug_check_temp_file[0]);
+	      debug_check_temp_file[0] = NULL;
 
-		  gcc_assert (debug_check_temp_file[1]
-			      && filename_cmp (debug_check_temp_file[0],
-					       debug_check_temp_file[1]));
+	      free (debug_check_temp_file[1]);
+	      debug_check_temp_file[1] = NULL;
+	    }
+	}
+    }
 
-		  if (verbose_flag)
-		    inform (0, "comparing final insns dumps");
+  /* If this file's name does not contain a recognized suffix,
+     record it as explicit linker input.  */
 
-		  if (compare_files (debug_check_temp_file))
-		    this_file_error = 1;
-		}
+  else
+    explicit_link_files[i] = 1;
 
-	      if (compare_debug)
-		{
-		  free (debug_check_temp_file[0]);
-		  debug_check_temp_file[0] = NULL;
+  /* Clear the delete-on-failure queue, deleting the files in it
+     if this compilation failed.  */
 
-		  free (debug_check_temp_file[1]);
-		  debug_check_temp_file[1] = NULL;
-		}
-	    }
+  if (this_file_error)
+    {
+      delete_failure_queue ();
+      errorcount++;
+    }
+  /* If this compilation succeeded, don't delete those files later.  */
+  clear_failure_queue ();
+}
+
+/* Return true if the input files may be compiled by concurrent copies
+   of the driver for -j.  This is the case when every input file is
+   compiled on its own and only diagnostics go to the standard streams:
+   no link follows that would need the temporary object files, and no
+   -E or -M output goes to stdout.  */
+
+bool
+driver::can_compile_infiles_in_parallel () const
+{
+#ifdef HAVE_WORKING_FORK
+  int i, n = 0;
+
+  if (!have_c || have_E || combine_inputs || verbose_only_flag
+      || print_subprocess_help)
+    return false;
+  for (i = 0; i < n_switches; i++)
+    if (strcmp (switches[i].part1, "M") == 0
+	|| strcmp (switches[i].part1, "MM") == 0)
+      return false;
+  for (i = 0; i < n_infiles; i++)
+    if (infiles[i].incompiler && !infiles[i].compiled)
+      n++;
+  return n > 1;
+#else
+  return false;
+#endif
+}
+
+#ifdef HAVE_WORKING_FORK
+/* A compilation of an input file run by compile_infiles_in_parallel.  */
+
+struct infile_job
+{
+  /* Process running the compilation, or 0 if it is not running.  */
+  pid_t pid;
+  /* Its wait status once it has finished.  */
+  int status;
+  /* Temporary file that receives its standard error, or NULL if the
+     input file was handled without forking.  */
+  char *stderr_file;
+  /* Whether it has finished.  */
+  bool done;
+};
+
+/* Report the finished compilation JOB of input file I: copy the
+   diagnostics it wrote to our standard error and account for its exit
+   status as execute does for the commands it runs.  */
+
+static void
+finish_infile_job (struct infile_job *job, int i)
+{
+  int status = job->status;
+
+  if (job->stderr_file)
+    {
+      FILE *f = fopen (job->stderr_file, "r");
+      char buf[4096];
+      size_t n;
+
+      if (f)
+	{
+	  while ((n = fread (buf, 1, sizeof (buf), f)) > 0)
+	    fwrite (buf, 1, n, stderr);
+	  fclose (f);
 	}
+      delete_if_ordinary (job->stderr_file);
+      free (job->stderr_file);
+      job->stderr_file = NULL;
+    }
 
-      /* If this file's name does not contain a recognized suffix,
-	 record it as explicit linker input.  */
+  if (WIFSIGNALED (status))
+    {
+      error ("compilation of %s terminated by signal %d",
+	     infiles[i].name, WTERMSIG (status));
+      signal_count++;
+    }
+  else if (WIFEXITED (status) && WEXITSTATUS (status) != 0)
+    {
+      /* The driver copy exited with get_exit_code; without
+	 -pass-exit-codes, 2 means that a command was killed.  */
+      errorcount++;
+      if (pass_exit_codes)
+	greatest_status = MAX (greatest_status, WEXITSTATUS (status));
+      else if (WEXITSTATUS (status) == 2)
+	signal_count++;
+    }
+}
+#endif
 
-      else
-	explicit_link_files[i] = 1;
+/* Compile the input files with at most parallel_jobs forked copies of
+   the driver running at once, each doing what do_spec_on_infile does
+   for one file.  Their standard error goes to temporary files, which
+   are copied to ours in the order of the input files, so that the
+   diagnostics come out as they would without -j.  */
+
+void
+driver::compile_infiles_in_parallel () const
+{
+#ifdef HAVE_WORKING_FORK
+  struct infile_job *jobs = XCNEWVEC (struct infile_job, n_infiles);
+  int next = 0, next_finish = 0, running = 0;
+  int i, status;
+  pid_t pid;
+
+  while (1)
+    {
+      while (next < n_infiles && running < parallel_jobs)
+	{
+	  struct infile_job *job = &jobs[next];
+	  int fd;
+
+	  i = next++;
 
-      /* Clear the delete-on-failure queue, deleting the files in it
-	 if this compilation failed.  */
+	  /* Files that are not compiled are handled right here.  */
+	  if (!infiles[i].incompiler || infiles[i].compiled)
+	    {
+	      do_spec_on_infile (i);
+	      job->done = true;
+	      continue;
+	    }
+
+	  job->stderr_file = make_temp_file (".err");
+	  record_temp_file (job->stderr_file, 1, 0);
+	  fd = open (job->stderr_file, O_WRONLY | O_TRUNC);
+	  if (fd < 0)
+	    pfatal_with_name (job->stderr_file);
+
+	  fflush (stdout);
+	  fflush (stderr);
+	  pid = fork ();
+	  if (pid == -1)
+	    fatal_error (input_location, "fork failed: %m");
+	  if (pid == 0)
+	    {
+	      /* The temporary files recorded so far belong to the parent;
+		 the ones of this compilation are deleted when we exit.  */
+	      always_delete_queue = failure_delete_queue = NULL;
+	      dup2 (fd, STDERR_FILENO);
+	      close (fd);
+	      do_spec_on_infile (i);
+	      exit (get_exit_code ());
+	    }
+	  close (fd);
+	  job->pid = pid;
+	  running++;
+	}
+
+      /* Report the finished compilations in order.  */
+      while (next_finish < n_infiles && jobs[next_finish].done)
+	{
+	  finish_infile_job (&jobs[next_finish], next_finish);
+	  infiles[next_finish++].compiled = true;
+	}
+      if (next_finish == n_infiles)
+	break;
 
-      if (this_file_error)
+      pid = waitpid (-1, &status, 0);
+      if (pid == -1)
 	{
-	  delete_failure_queue ();
-	  errorcount++;
+	  if (errno == EINTR)
+	    continue;
+	  fatal_error (input_location, "waitpid failed: %m");
 	}
-      /* If this compilation succeeded, don't delete those files later.  */
-      clear_failure_queue ();
+      for (i = next_finish; i < next; i++)
+	if (jobs[i].pid == pid)
+	  {
+	    jobs[i].pid = 0;
+	    jobs[i].status = status;
+	    jobs[i].done = true;
+	    running--;
+	    break;
+	  }
     }
 
+  XDELETEVEC (jobs);
+#else
+  gcc_unreachable ();
+#endif
+}
+
+/* Run the spec machinery on each input file.  */
+
+void
+driver::do_spec_on_infiles () const
+{
+  size_t i;
+
+  if (parallel_jobs > 1 && can_compile_infiles_in_parallel ())
+    compile_infiles_in_parallel ();
+  else
+    for (i = 0; (int) i < n_infiles; i++)
+      do_spec_on_infile (i);
+
   /* Reset the input file name to the first compile/object file name, for use
      with %b in LINK_SPEC. We use the first input file that we can find
      a compiler to compile it instead of using infiles.language since for
@@ -9922,6 +10142,7 @@ driver::finalize ()
   save_temps_flag = SAVE_TEMPS_NONE;
   save_temps_prefix = 0;
   save_temps_length = 0;
+  parallel_jobs = 1;
   spec_machine = DEFAULT_TARGET_MACHINE;
   greatest_status = 1;
 
@@ -50,6 +50,9 @@ class driver
   void handle_unrecognized_options ();
   int maybe_print_and_exit () const;
   bool prepare_infiles ();
+  void do_spec_on_infile (size_t i) const;
+  bool can_compile_infiles_in_parallel () const;
+  void compile_infiles_in_parallel () const;
   void do_spec_on_infiles () const;
   void maybe_run_linker (const char *argv0) const;
   void final_actions () const;
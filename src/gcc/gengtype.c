@@ -2799,12 +2799,17 @@ walk_type (type_p t, struct walk_type_data *d)
 
 		if (d->fn_wants_lvalue)
 		  {
-		    oprintf (d->of, "%*s%s = ", d->indent, "",
-			     d->prev_val[2]);
+		    const char *field = d->prev_val[2];
+
+		    oprintf (d->of, "%*s%s = ", d->indent, "", field);
 		    d->prev_val[2] = d->val;
 		    output_escaped_param (d, nested_ptr_d->convert_to,
 					  "nested_ptr");
 		    oprintf (d->of, ";\n");
+		    /* OP only saw the temporary; tell the PCH writer where
+		       the pointer really lives so it can be relocated.  */
+		    oprintf (d->of, "%*sgt_pch_note_reloc (&(%s), cookie);\n",
+			     d->indent, "", field);
 		  }
 
 		d->indent -= 2;
@@ -315,6 +315,13 @@ struct traversal_state
   size_t count;
   struct ptr_data **ptrs;
   size_t ptrs_i;
+  /* The object being written, its size and its offset in the PCH image.  */
+  char *reloc_obj;
+  size_t reloc_obj_size;
+  size_t reloc_obj_offset;
+  /* Bitmap of the pointer-sized words of the PCH image that hold a pointer
+     into the image, and need adjusting if it is mapped elsewhere.  */
+  unsigned long *reloc_bitmap;
 };
 
 /* Callbacks for htab_traverse.  */
@@ -358,8 +365,7 @@ static void
 relocate_ptrs (void *ptr_p, void *state_p)
 {
   void **ptr = (void **)ptr_p;
-  struct traversal_state *state ATTRIBUTE_UNUSED
-    = (struct traversal_state *)state_p;
+  struct traversal_state *state = (struct traversal_state *)state_p;
   struct ptr_data *result;
 
   if (*ptr == NULL || *ptr == (void *)1)
@@ -369,6 +375,35 @@ relocate_ptrs (void *ptr_p, void *state_p)
     saving_htab->find_with_hash (*ptr, POINTER_HASH (*ptr));
   gcc_assert (result);
   *ptr = result->new_addr;
+  gt_pch_note_reloc (ptr_p, state);
+}
+
+/* Note that the pointer at PTR_P, which has already been relocated,
+   needs adjusting if the PCH image is mapped at another address.
+   STATE_P is the cookie passed to the gt_pch_p_* routines.  Pointers
+   outside of the object being written, such as the copies reorder
+   functions and nested_ptr fields work on, are ignored.  */
+
+void
+gt_pch_note_reloc (void *ptr_p, void *state_p)
+{
+  struct traversal_state *state = (struct traversal_state *)state_p;
+  void **ptr = (void **)ptr_p;
+
+  if (*ptr == NULL || *ptr == (void *)1)
+    return;
+
+  if ((char *) ptr_p >= state->reloc_obj
+      && (char *) ptr_p < state->reloc_obj + state->reloc_obj_size)
+    {
+      size_t offset = (state->reloc_obj_offset
+		       + ((char *) ptr_p - state->reloc_obj));
+      size_t word = offset / sizeof (void *);
+
+      gcc_checking_assert (offset % sizeof (void *) == 0);
+      state->reloc_bitmap[word / HOST_BITS_PER_LONG]
+	|= 1UL << (word % HOST_BITS_PER_LONG);
+    }
 }
 
 /* Write out, after relocation, the pointers in TAB.  */
@@ -412,6 +447,18 @@ struct mmap_info
   void *preferred_base;
 };
 
+/* Return the number of longs in the relocation bitmap of a PCH image of
+   SIZE bytes.  The bitmap follows the image and the allocator data in
+   the PCH file and has one bit for each pointer-sized word of the
+   image.  */
+
+static size_t
+pch_reloc_bitmap_length (size_t size)
+{
+  size_t words = size / sizeof (void *);
+  return (words + HOST_BITS_PER_LONG - 1) / HOST_BITS_PER_LONG;
+}
+
 /* Write out the state of the compiler to F.  */
 
 void
@@ -455,6 +502,11 @@ gt_pch_save (FILE *f)
 
   state.ptrs = XNEWVEC (struct ptr_data *, state.count);
   state.ptrs_i = 0;
+  state.reloc_obj = NULL;
+  state.reloc_obj_size = 0;
+  state.reloc_obj_offset = 0;
+  state.reloc_bitmap
+    = XCNEWVEC (unsigned long, pch_reloc_bitmap_length (mmi.size));
 
   saving_htab->traverse <traversal_state *, ggc_call_alloc> (&state);
   timevar_pop (TV_PCH_PTR_REALLOC);
@@ -549,6 +601,10 @@ gt_pch_save (FILE *f)
 	}
 #endif
       memcpy (this_object, state.ptrs[i]->obj, state.ptrs[i]->size);
+      state.reloc_obj = (char *) state.ptrs[i]->obj;
+      state.reloc_obj_size = state.ptrs[i]->size;
+      state.reloc_obj_offset = ((char *) state.ptrs[i]->new_addr
+				- (char *) mmi.preferred_base);
       if (state.ptrs[i]->reorder_fn != NULL)
 	state.ptrs[i]->reorder_fn (state.ptrs[i]->obj,
 				   state.ptrs[i]->note_ptr_cookie,
@@ -580,14 +636,89 @@ gt_pch_save (FILE *f)
 #endif
 
   ggc_pch_finish (state.d, state.f);
+
+  /* Write out the relocation bitmap, so the image can be used at any
+     address.  */
+  if (fwrite (state.reloc_bitmap, sizeof (unsigned long),
+	      pch_reloc_bitmap_length (mmi.size), state.f)
+      != pch_reloc_bitmap_length (mmi.size))
+    fatal_error (input_location, "can%'t write PCH file: %m");
+
   gt_pch_fixup_stringpool ();
 
+  XDELETE (state.reloc_bitmap);
   XDELETE (state.ptrs);
   XDELETE (this_object);
   delete saving_htab;
   saving_htab = NULL;
 }
 
+/* Map SIZE bytes of the PCH file FD at OFFSET at whatever address is
+   available, and store that address in *ADDR_P.  The file is mapped
+   privately, so pages are only read in when they are first touched.
+   Return 1 if the file was mapped, or 0 if memory was allocated instead
+   and the data needs to be read in, like the gt_pch_use_address host
+   hook.  */
+
+static int
+gt_pch_map_elsewhere (size_t size, int fd ATTRIBUTE_UNUSED,
+		      size_t offset ATTRIBUTE_UNUSED, void **addr_p)
+{
+  size_t granularity = host_hooks.gt_pch_alloc_granularity ();
+  char *addr;
+
+#if HAVE_MMAP_FILE
+  addr = (char *) mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+			fd, offset);
+  if (addr != (char *) MAP_FAILED)
+    {
+      *addr_p = addr;
+      return 1;
+    }
+#endif
+
+  /* The allocator wants the image aligned like its pages.  It is never
+     freed.  */
+  addr = XNEWVEC (char, size + granularity);
+  *addr_p = addr + ((granularity - (uintptr_t) addr % granularity)
+		    % granularity);
+  return 0;
+}
+
+/* Adjust the pointers in the PCH image now at ADDR, that was written
+   for PREFERRED_BASE.  BITMAP of BITMAP_LENGTH longs has a bit set for
+   every word holding a pointer into the image.  Only the pages holding
+   such pointers are touched.  Relocate the global roots too.  */
+
+static void
+gt_pch_relocate (void *addr, void *preferred_base,
+		 const unsigned long *bitmap, size_t bitmap_length)
+{
+  const struct ggc_root_tab *const *rt;
+  const struct ggc_root_tab *rti;
+  ptrdiff_t delta = (char *) addr - (char *) preferred_base;
+  char **words = (char **) addr;
+  size_t i, j;
+
+  for (i = 0; i < bitmap_length; i++)
+    {
+      unsigned long bits = bitmap[i];
+
+      for (j = 0; bits; j++, bits >>= 1)
+	if (bits & 1)
+	  words[i * HOST_BITS_PER_LONG + j] += delta;
+    }
+
+  for (rt = gt_ggc_rtab; *rt; rt++)
+    for (rti = *rt; rti->base != NULL; rti++)
+      for (i = 0; i < rti->nelt; i++)
+	{
+	  char **ptr = (char **) ((char *) rti->base + rti->stride * i);
+	  if (*ptr != NULL && *ptr != (char *) 1)
+	    *ptr += delta;
+	}
+}
+
 /* Read the state of the compiler back in from F.  */
 
 void
@@ -598,6 +729,8 @@ gt_pch_restore (FILE *f)
   size_t i;
   struct mmap_info mmi;
   int result;
+  void *addr;
+  size_t bitmap_length;
 
   /* Delete any deletable objects.  This makes ggc_pch_read much
      faster, as it can be sure that no GCable objects remain other
@@ -623,20 +756,44 @@ gt_pch_restore (FILE *f)
   if (fread (&mmi, sizeof (mmi), 1, f) != 1)
     fatal_error (input_location, "can%'t read PCH file: %m");
 
+  addr = mmi.preferred_base;
   result = host_hooks.gt_pch_use_address (mmi.preferred_base, mmi.size,
 					  fileno (f), mmi.offset);
   if (result < 0)
-    fatal_error (input_location, "had to relocate PCH");
+    {
+      /* The preferred address is taken, for instance because of address
+	 space randomization.  Put the image somewhere else and relocate
+	 it below.  */
+      result = gt_pch_map_elsewhere (mmi.size, fileno (f), mmi.offset,
+				     &addr);
+    }
   if (result == 0)
     {
       if (fseek (f, mmi.offset, SEEK_SET) != 0
-	  || fread (mmi.preferred_base, mmi.size, 1, f) != 1)
+	  || fread (addr, mmi.size, 1, f) != 1)
 	fatal_error (input_location, "can%'t read PCH file: %m");
     }
   else if (fseek (f, mmi.offset + mmi.size, SEEK_SET) != 0)
     fatal_error (input_location, "can%'t read PCH file: %m");
 
-  ggc_pch_read (f, mmi.preferred_base);
+  ggc_pch_read (f, addr);
+
+  bitmap_length = pch_reloc_bitmap_length (mmi.size);
+  if (addr == mmi.preferred_base)
+    {
+      if (fseek (f, bitmap_length * sizeof (unsigned long), SEEK_CUR) != 0)
+	fatal_error (input_location, "can%'t read PCH file: %m");
+    }
+  else
+    {
+      unsigned long *bitmap = XNEWVEC (unsigned long, bitmap_length);
+
+      if (fread (bitmap, sizeof (unsigned long), bitmap_length, f)
+	  != bitmap_length)
+	fatal_error (input_location, "can%'t read PCH file: %m");
+      gt_pch_relocate (addr, mmi.preferred_base, bitmap, bitmap_length);
+      XDELETE (bitmap);
+    }
 
   gt_pch_restore_stringpool ();
 }
@@ -901,6 +1058,18 @@ struct ggc_usage: public mem_usage
     free (location_string);
   }
 
+  /* Dump usage coupled to LOC location to F as a JSON object.  */
+  inline void
+  dump_json (FILE *f, mem_location *loc) const
+  {
+    fputs ("{", f);
+    loc->dump_json (f);
+    fprintf (f, ", \"garbage\": %li, \"freed\": %li, \"leak\": %li"
+	     ", \"overhead\": %li, \"times\": %li}",
+	     (long)m_collected, (long)m_freed, get_balance (),
+	     (long)m_overhead, (long)m_times);
+  }
+
   /* Dump footer.  */
   inline void
   dump_footer ()
@@ -980,6 +1149,21 @@ dump_ggc_loc_statistics (bool final)
   ggc_force_collect = false;
 }
 
+/* Dump the GGC allocations by location to F as a JSON array, or an
+   empty array if they are not tracked.  */
+
+void
+dump_ggc_loc_statistics_json (FILE *f)
+{
+  if (! GATHER_STATISTICS)
+    {
+      fputs ("[]", f);
+      return;
+    }
+
+  ggc_mem_desc.dump_json (f, GGC_ORIGIN);
+}
+
 /* Record ALLOCATED and OVERHEAD bytes to descriptor NAME:LINE (FUNCTION).  */
 void
 ggc_record_overhead (size_t allocated, size_t overhead, void *ptr MEM_STAT_DECL)
@@ -400,6 +400,9 @@ static struct ggc_globals
   /* Bytes currently allocated at the end of the last collection.  */
   size_t allocated_last_gc;
 
+  /* The most bytes allocated at the start of a collection.  */
+  size_t allocated_peak;
+
   /* Total amount of memory mapped.  */
   size_t bytes_mapped;
 
@@ -2183,6 +2186,9 @@ ggc_collect (void)
   if (GGC_DEBUG_LEVEL >= 2)
     fprintf (G.debug_file, "BEGIN COLLECTING\n");
 
+  if (G.allocated > G.allocated_peak)
+    G.allocated_peak = G.allocated;
+
   /* Zero the total allocated bytes.  This will be recalculated in the
      sweep phase.  */
   G.allocated = 0;
@@ -2237,6 +2243,17 @@ ggc_grow (void)
     fprintf (stderr, " {GC start %luk} ", (unsigned long) G.allocated / 1024);
 }
 
+/* Store the number of bytes currently allocated in *IN_USE, and the
+   most ever allocated in *PEAK.  Memory is mostly freed by collections,
+   so the peak is only checked for when one starts.  */
+
+void
+ggc_get_usage (size_t *in_use, size_t *peak)
+{
+  *in_use = G.allocated;
+  *peak = MAX (G.allocated_peak, G.allocated);
+}
+
 /* Print allocation statistics.  */
 #define SCALE(x) ((unsigned long) ((x) < 1024*10 \
 		  ? (x) \
@@ -53,6 +53,10 @@ extern int gt_pch_note_object (void *, void *, gt_note_pointers);
    function.  */
 extern void gt_pch_note_reorder (void *, void *, gt_handle_reorder);
 
+/* Used by the gt_pch_p_* routines.  Register that a pointer stored back
+   into a nested_ptr field needs relocating when the PCH is loaded.  */
+extern void gt_pch_note_reloc (void *, void *);
+
 /* generated function to clear caches in gc memory.  */
 extern void gt_clear_caches ();
 
@@ -155,6 +159,7 @@ extern void *ggc_realloc (void *, size_t CXX_MEM_STAT_INFO);
 extern void ggc_free (void *);
 
 extern void dump_ggc_loc_statistics (bool);
+extern void dump_ggc_loc_statistics_json (FILE *);
 
 /* Reallocator.  */
 #define GGC_RESIZEVEC(T, P, N) \
@@ -263,6 +268,9 @@ extern void gt_pch_restore (FILE *f);
 /* Print allocation statistics.  */
 extern void ggc_print_statistics (void);
 
+/* Get the current and the peak size of the heap.  */
+extern void ggc_get_usage (size_t *, size_t *);
+
 extern void stringpool_statistics (void);
 
 /* Heuristics.  */
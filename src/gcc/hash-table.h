@@ -77,7 +77,8 @@ along with GCC; see the file COPYING3.  If not see
          - A static member function named 'data_free'.  This function
          deallocates the data elements in the table.
 
-   Hash table are instantiated with two type arguments.
+   Hash table are instantiated with two type arguments and an optional
+   storage policy.
 
       * The descriptor type, (2) above.
 
@@ -85,6 +86,16 @@ along with GCC; see the file COPYING3.  If not see
       provide your own allocator type.  By default, hash tables will use
       the class template xcallocator, which uses malloc/free for allocation.
 
+      * The storage policy, one of enum hash_table_storage.  By default
+      the table is probed by double hashing and every probe compares keys
+      (HASH_TABLE_PROBE_KEYS).  Large tables outside of GC memory whose
+      'equal' has to dereference the entries can instead keep a control
+      byte with a few bits of hash per entry (HASH_TABLE_CONTROL_BYTES),
+      so that lookups rarely touch entries that do not match:
+
+         hash_table <some_type_hasher, xcallocator, HASH_TABLE_CONTROL_BYTES>
+           some_type_hash_table;
+
 
    DEFINING A DESCRIPTOR TYPE
 
@@ -338,6 +349,82 @@ hash_table_mod2 (hashval_t hash, unsigned int index)
   return 1 + mul_mod (hash, p->prime - 2, p->inv_m2, p->shift);
 }
 
+/* Storage policies of hash_table.  */
+
+enum hash_table_storage
+{
+  /* A table of prime size, probed by double hashing.  Every probe
+     compares the key of the entry with Descriptor::equal.  */
+  HASH_TABLE_PROBE_KEYS,
+
+  /* A table whose size is a power of 2, split into groups of
+     HASH_TABLE_GROUP_SIZE entries.  Every entry has a control byte that
+     says whether it is empty, deleted, or holds an element with 7 given
+     bits of hash.  Lookups compare the control bytes of a whole group
+     at once, and call Descriptor::equal only for the entries whose hash
+     bits match.  Groups are probed quadratically.  The control bytes
+     are malloced, so the table cannot live in GC memory.  */
+  HASH_TABLE_CONTROL_BYTES
+};
+
+/* Number of entries in a group of a HASH_TABLE_CONTROL_BYTES table.  */
+#define HASH_TABLE_GROUP_SIZE 16
+
+/* Control bytes of HASH_TABLE_CONTROL_BYTES entries that hold no
+   element.  The control byte of an element is below 0x80.  */
+#define HASH_TABLE_CTRL_EMPTY 0x80
+#define HASH_TABLE_CTRL_DELETED 0xfe
+
+/* Return the size of a HASH_TABLE_CONTROL_BYTES table with room for N
+   entries: a power of 2 of at least one group.  */
+
+inline size_t
+hash_table_control_size (size_t n)
+{
+  size_t size = HASH_TABLE_GROUP_SIZE;
+
+  while (size < n)
+    size *= 2;
+  return size;
+}
+
+/* Mix the bits of HASH, whose low bits are often poor, for a
+   HASH_TABLE_CONTROL_BYTES table: the low 7 bits of the result are the
+   control byte and the others choose the first group to probe.  */
+
+inline hashval_t
+hash_table_mix (hashval_t hash)
+{
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6b;
+  hash ^= hash >> 13;
+  hash *= 0xc2b2ae35;
+  hash ^= hash >> 16;
+  return hash;
+}
+
+/* Return a mask with bit I set for every control byte CTRL[I] of a
+   group that is equal to C.  */
+
+inline unsigned int
+hash_table_group_match (const unsigned char *ctrl, unsigned char c)
+{
+#if defined (__SSE2__) && GCC_VERSION >= 4009
+  typedef char v16qi __attribute__ ((__vector_size__ (HASH_TABLE_GROUP_SIZE)));
+  v16qi group;
+
+  memcpy (&group, ctrl, sizeof (group));
+  return __builtin_ia32_pmovmskb128 ((v16qi) (group == (char) c));
+#else
+  unsigned int mask = 0;
+
+  for (int i = 0; i < HASH_TABLE_GROUP_SIZE; i++)
+    if (ctrl[i] == c)
+      mask |= 1u << i;
+  return mask;
+#endif
+}
+
 class mem_usage;
 
 /* User-facing hash table type.
@@ -349,12 +436,16 @@ class mem_usage;
    Specify the template Allocator to allocate and free memory.
      The default is xcallocator.
 
+   Specify Storage to choose how entries are laid out and looked up.
+     The default is HASH_TABLE_PROBE_KEYS.
+
      Storage is an implementation detail and should not be used outside the
      hash table code.
 
 */
 template <typename Descriptor,
-	 template<typename Type> class Allocator = xcallocator>
+	 template<typename Type> class Allocator = xcallocator,
+	 hash_table_storage Storage = HASH_TABLE_PROBE_KEYS>
 class hash_table
 {
   typedef typename Descriptor::value_type value_type;
@@ -502,7 +593,11 @@ private:
   void empty_slow ();
 
   value_type *alloc_entries (size_t n CXX_MEM_STAT_INFO) const;
+  unsigned char *alloc_control (size_t n) const;
+  void free_control (unsigned char *, size_t n);
   value_type *find_empty_slot_for_expand (hashval_t);
+  value_type *find_in_groups (const compare_type &, hashval_t,
+			      value_type **, value_type **);
   void expand ();
   static bool is_deleted (value_type &v)
   {
@@ -527,6 +622,10 @@ private:
   /* Table itself.  */
   typename Descriptor::value_type *m_entries;
 
+  /* The control bytes of the entries of a HASH_TABLE_CONTROL_BYTES
+     table, NULL otherwise.  */
+  unsigned char *m_control;
+
   size_t m_size;
 
   /* Current number of elements including also deleted elements.  */
@@ -544,7 +643,7 @@ private:
   unsigned int m_collisions;
 
   /* Current size (in entries) of the hash table, as an index into the
-     table of primes.  */
+     table of primes.  Unused for HASH_TABLE_CONTROL_BYTES tables.  */
   unsigned int m_size_prime_index;
 
   /* if m_entries is stored in ggc memory.  */
@@ -565,33 +664,47 @@ extern mem_alloc_description<mem_usage> hash_table_usage;
 /* Support function for statistics.  */
 extern void dump_hash_table_loc_statistics (void);
 
-template<typename Descriptor, template<typename Type> class Allocator>
-hash_table<Descriptor, Allocator>::hash_table (size_t size, bool ggc, bool
-					       gather_mem_stats,
-					       mem_alloc_origin origin
-					       MEM_STAT_DECL) :
+template<typename Descriptor, template<typename Type> class Allocator,
+	 hash_table_storage Storage>
+hash_table<Descriptor, Allocator, Storage>::hash_table (size_t size,
+							bool ggc,
+							bool gather_mem_stats,
+							mem_alloc_origin origin
+							MEM_STAT_DECL) :
   m_n_elements (0), m_n_deleted (0), m_searches (0), m_collisions (0),
   m_ggc (ggc), m_gather_mem_stats (gather_mem_stats)
 {
   unsigned int size_prime_index;
 
-  size_prime_index = hash_table_higher_prime_index (size);
-  size = prime_tab[size_prime_index].prime;
+  if (Storage == HASH_TABLE_CONTROL_BYTES)
+    {
+      gcc_checking_assert (!ggc);
+      size_prime_index = 0;
+      size = hash_table_control_size (size);
+    }
+  else
+    {
+      size_prime_index = hash_table_higher_prime_index (size);
+      size = prime_tab[size_prime_index].prime;
+    }
 
   if (m_gather_mem_stats)
     hash_table_usage.register_descriptor (this, origin, ggc
 					  FINAL_PASS_MEM_STAT);
 
   m_entries = alloc_entries (size PASS_MEM_STAT);
+  m_control = alloc_control (size);
   m_size = size;
   m_size_prime_index = size_prime_index;
 }
 
-template<typename Descriptor, template<typename Type> class Allocator>
-hash_table<Descriptor, Allocator>::hash_table (const hash_table &h, bool ggc,
-					       bool gather_mem_stats,
-					       mem_alloc_origin origin
-					       MEM_STAT_DECL) :
+template<typename Descriptor, template<typename Type> class Allocator,
+	 hash_table_storage Storage>
+hash_table<Descriptor, Allocator, Storage>::hash_table (const hash_table &h,
+							bool ggc,
+							bool gather_mem_stats,
+							mem_alloc_origin origin
+							MEM_STAT_DECL) :
   m_n_elements (h.m_n_elements), m_n_deleted (h.m_n_deleted),
   m_searches (0), m_collisions (0), m_ggc (ggc),
   m_gather_mem_stats (gather_mem_stats)
@@ -612,12 +725,16 @@ hash_table<Descriptor, Allocator>::hash_table (const hash_table &h, bool ggc,
 	nentries[i] = entry;
     }
   m_entries = nentries;
+  m_control = alloc_control (size);
+  if (m_control)
+    memcpy (m_control, h.m_control, size);
   m_size = size;
   m_size_prime_index = h.m_size_prime_index;
 }
 
-template<typename Descriptor, template<typename Type> class Allocator>
-hash_table<Descriptor, Allocator>::~hash_table ()
+template<typename Descriptor, template<typename Type> class Allocator,
+	 hash_table_storage Storage>
+hash_table<Descriptor, Allocator, Storage>::~hash_table ()
 {
   for (size_t i = m_size - 1; i < m_size; i--)
     if (!is_empty (m_entries[i]) && !is_deleted (m_entries[i]))
@@ -627,6 +744,7 @@ hash_table<Descriptor, Allocator>::~hash_table ()
     Allocator <value_type> ::data_free (m_entries);
   else
     ggc_free (m_entries);
+  free_control (m_control, m_size);
 
   if (m_gather_mem_stats)
     hash_table_usage.release_instance_overhead (this,
@@ -636,9 +754,11 @@ hash_table<Descriptor, Allocator>::~hash_table ()
 
 /* This function returns an array of empty hash table elements.  */
 
-template<typename Descriptor, template<typename Type> class Allocator>
-inline typename hash_table<Descriptor, Allocator>::value_type *
-hash_table<Descriptor, Allocator>::alloc_entries (size_t n MEM_STAT_DECL) const
+template<typename Descriptor, template<typename Type> class Allocator,
+	 hash_table_storage Storage>
+inline typename hash_table<Descriptor, Allocator, Storage>::value_type *
+hash_table<Descriptor, Allocator, Storage>::alloc_entries (size_t n
+							   MEM_STAT_DECL) const
 {
   value_type *nentries;
 
@@ -657,6 +777,44 @@ hash_table<Descriptor, Allocator>::alloc_entries (size_t n MEM_STAT_DECL) const
   return nentries;
 }
 
+/* This function returns the control bytes of N empty entries of a
+   HASH_TABLE_CONTROL_BYTES table, or NULL for other tables.  */
+
+template<typename Descriptor, template<typename Type> class Allocator,
+	 hash_table_storage Storage>
+inline unsigned char *
+hash_table<Descriptor, Allocator, Storage>::alloc_control (size_t n) const
+{
+  unsigned char *control;
+
+  if (Storage != HASH_TABLE_CONTROL_BYTES)
+    return NULL;
+
+  if (m_gather_mem_stats)
+    hash_table_usage.register_instance_overhead (n, this);
+
+  control = XNEWVEC (unsigned char, n);
+  memset (control, HASH_TABLE_CTRL_EMPTY, n);
+  return control;
+}
+
+/* Free the control bytes CONTROL of N entries.  */
+
+template<typename Descriptor, template<typename Type> class Allocator,
+	 hash_table_storage Storage>
+inline void
+hash_table<Descriptor, Allocator, Storage>
+::free_control (unsigned char *control, size_t n)
+{
+  if (control == NULL)
+    return;
+
+  if (m_gather_mem_stats)
+    hash_table_usage.release_instance_overhead (this, n);
+
+  XDELETEVEC (control);
+}
+
 /* Similar to find_slot, but without several unwanted side effects:
     - Does not call equal when it finds an existing entry.
     - Does not change the count of elements/searches/collisions in the
@@ -664,10 +822,34 @@ hash_table<Descriptor, Allocator>::alloc_entries (size_t n MEM_STAT_DECL) const
    This function also assumes there are no deleted entries in the table.
    HASH is the hash value for the element to be inserted.  */
 
-template<typename Descriptor, template<typename Type> class Allocator>
-typename hash_table<Descriptor, Allocator>::value_type *
-hash_table<Descriptor, Allocator>::find_empty_slot_for_expand (hashval_t hash)
+template<typename Descriptor, template<typename Type> class Allocator,
+	 hash_table_storage Storage>
+typename hash_table<Descriptor, Allocator, Storage>::value_type *
+hash_table<Descriptor, Allocator, Storage>
+::find_empty_slot_for_expand (hashval_t hash)
 {
+  if (Storage == HASH_TABLE_CONTROL_BYTES)
+    {
+      hashval_t mixed = hash_table_mix (hash);
+      size_t mask = m_size / HASH_TABLE_GROUP_SIZE - 1;
+      size_t group = (mixed >> 7) & mask;
+
+      for (size_t step = 1; ; step++)
+	{
+	  size_t start = group * HASH_TABLE_GROUP_SIZE;
+	  unsigned int empty
+	    = hash_table_group_match (m_control + start,
+				      HASH_TABLE_CTRL_EMPTY);
+	  if (empty)
+	    {
+	      start += ctz_hwi (empty);
+	      m_control[start] = mixed & 0x7f;
+	      return m_entries + start;
+	    }
+	  group = (group + step) & mask;
+	}
+    }
+
   hashval_t index = hash_table_mod1 (hash, m_size_prime_index);
   size_t size = m_size;
   value_type *slot = m_entries + index;
@@ -698,9 +880,10 @@ hash_table<Descriptor, Allocator>::find_empty_slot_for_expand (hashval_t hash)
    table entries is changed.  If memory allocation fails, this function
    will abort.  */
 
-template<typename Descriptor, template<typename Type> class Allocator>
+template<typename Descriptor, template<typename Type> class Allocator,
+	 hash_table_storage Storage>
 void
-hash_table<Descriptor, Allocator>::expand ()
+hash_table<Descriptor, Allocator, Storage>::expand ()
 {
   value_type *oentries = m_entries;
   unsigned int oindex = m_size_prime_index;
@@ -714,8 +897,16 @@ hash_table<Descriptor, Allocator>::expand ()
   size_t nsize;
   if (elts * 2 > osize || (elts * 8 < osize && osize > 32))
     {
-      nindex = hash_table_higher_prime_index (elts * 2);
-      nsize = prime_tab[nindex].prime;
+      if (Storage == HASH_TABLE_CONTROL_BYTES)
+	{
+	  nindex = 0;
+	  nsize = hash_table_control_size (elts * 2);
+	}
+      else
+	{
+	  nindex = hash_table_higher_prime_index (elts * 2);
+	  nsize = prime_tab[nindex].prime;
+	}
     }
   else
     {
@@ -724,12 +915,15 @@ hash_table<Descriptor, Allocator>::expand ()
     }
 
   value_type *nentries = alloc_entries (nsize);
+  unsigned char *ocontrol = m_control;
 
   if (m_gather_mem_stats)
     hash_table_usage.release_instance_overhead (this, sizeof (value_type)
 						    * osize);
+  free_control (ocontrol, osize);
 
   m_entries = nentries;
+  m_control = alloc_control (nsize);
   m_size = nsize;
   m_size_prime_index = nindex;
   m_n_elements -= m_n_deleted;
@@ -759,9 +953,10 @@ hash_table<Descriptor, Allocator>::expand ()
 
 /* Implements empty() in cases where it isn't a no-op.  */
 
-template<typename Descriptor, template<typename Type> class Allocator>
+template<typename Descriptor, template<typename Type> class Allocator,
+	 hash_table_storage Storage>
 void
-hash_table<Descriptor, Allocator>::empty_slow ()
+hash_table<Descriptor, Allocator, Storage>::empty_slow ()
 {
   size_t size = m_size;
   value_type *entries = m_entries;
@@ -774,20 +969,36 @@ hash_table<Descriptor, Allocator>::empty_slow ()
   /* Instead of clearing megabyte, downsize the table.  */
   if (size > 1024*1024 / sizeof (PTR))
     {
-      int nindex = hash_table_higher_prime_index (1024 / sizeof (PTR));
-      int nsize = prime_tab[nindex].prime;
+      int nindex, nsize;
+
+      if (Storage == HASH_TABLE_CONTROL_BYTES)
+	{
+	  nindex = 0;
+	  nsize = hash_table_control_size (1024 / sizeof (PTR));
+	}
+      else
+	{
+	  nindex = hash_table_higher_prime_index (1024 / sizeof (PTR));
+	  nsize = prime_tab[nindex].prime;
+	}
 
       if (!m_ggc)
 	Allocator <value_type> ::data_free (m_entries);
       else
 	ggc_free (m_entries);
+      free_control (m_control, size);
 
       m_entries = alloc_entries (nsize);
+      m_control = alloc_control (nsize);
       m_size = nsize;
       m_size_prime_index = nindex;
     }
   else
-    memset (entries, 0, size * sizeof (value_type));
+    {
+      memset (entries, 0, size * sizeof (value_type));
+      if (m_control)
+	memset (m_control, HASH_TABLE_CTRL_EMPTY, size);
+    }
   m_n_deleted = 0;
   m_n_elements = 0;
 }
@@ -796,28 +1007,111 @@ hash_table<Descriptor, Allocator>::empty_slow ()
    useful when you've already done the lookup and don't want to do it
    again. */
 
-template<typename Descriptor, template<typename Type> class Allocator>
+template<typename Descriptor, template<typename Type> class Allocator,
+	 hash_table_storage Storage>
 void
-hash_table<Descriptor, Allocator>::clear_slot (value_type *slot)
+hash_table<Descriptor, Allocator, Storage>::clear_slot (value_type *slot)
 {
   gcc_checking_assert (!(slot < m_entries || slot >= m_entries + size ()
 		         || is_empty (*slot) || is_deleted (*slot)));
 
   Descriptor::remove (*slot);
 
+  if (Storage == HASH_TABLE_CONTROL_BYTES)
+    {
+      size_t index = slot - m_entries;
+
+      /* Lookups stop at a group with an empty entry.  If the group of
+	 SLOT still has one, none has ever gone past it, and SLOT can
+	 become empty rather than deleted.  */
+      if (hash_table_group_match (m_control
+				  + (index & -(size_t) HASH_TABLE_GROUP_SIZE),
+				  HASH_TABLE_CTRL_EMPTY))
+	{
+	  m_control[index] = HASH_TABLE_CTRL_EMPTY;
+	  mark_empty (*slot);
+	  m_n_elements--;
+	  return;
+	}
+      m_control[index] = HASH_TABLE_CTRL_DELETED;
+    }
+
   mark_deleted (*slot);
   m_n_deleted++;
 }
 
+/* Look for an entry equal to COMPARABLE with hash HASH in a
+   HASH_TABLE_CONTROL_BYTES table and return it.  If there is none,
+   return NULL and set *EMPTY_SLOT to the empty entry where the lookup
+   stopped, and *DELETED_SLOT to the first deleted entry it came across,
+   or NULL.  */
+
+template<typename Descriptor, template<typename Type> class Allocator,
+	 hash_table_storage Storage>
+typename hash_table<Descriptor, Allocator, Storage>::value_type *
+hash_table<Descriptor, Allocator, Storage>
+::find_in_groups (const compare_type &comparable, hashval_t hash,
+		  value_type **deleted_slot, value_type **empty_slot)
+{
+  hashval_t mixed = hash_table_mix (hash);
+  size_t mask = m_size / HASH_TABLE_GROUP_SIZE - 1;
+  size_t group = (mixed >> 7) & mask;
+
+  m_searches++;
+  *deleted_slot = NULL;
+  for (size_t step = 1; ; step++)
+    {
+      const unsigned char *ctrl = m_control + group * HASH_TABLE_GROUP_SIZE;
+      value_type *entries = m_entries + group * HASH_TABLE_GROUP_SIZE;
+      unsigned int match = hash_table_group_match (ctrl, mixed & 0x7f);
+
+      /* An entry handed out by find_slot_with_hash may still be empty if
+	 nothing was stored into it.  */
+      for (; match; match &= match - 1)
+	{
+	  value_type *entry = &entries[ctz_hwi (match)];
+	  if (!is_empty (*entry) && Descriptor::equal (*entry, comparable))
+	    return entry;
+	}
+
+      if (!*deleted_slot)
+	{
+	  unsigned int deleted
+	    = hash_table_group_match (ctrl, HASH_TABLE_CTRL_DELETED);
+	  if (deleted)
+	    *deleted_slot = &entries[ctz_hwi (deleted)];
+	}
+
+      unsigned int empty = hash_table_group_match (ctrl, HASH_TABLE_CTRL_EMPTY);
+      if (empty)
+	{
+	  *empty_slot = &entries[ctz_hwi (empty)];
+	  return NULL;
+	}
+
+      m_collisions++;
+      group = (group + step) & mask;
+    }
+}
+
 /* This function searches for a hash table entry equal to the given
    COMPARABLE element starting with the given HASH value.  It cannot
    be used to insert or delete an element. */
 
-template<typename Descriptor, template<typename Type> class Allocator>
-typename hash_table<Descriptor, Allocator>::value_type &
-hash_table<Descriptor, Allocator>
+template<typename Descriptor, template<typename Type> class Allocator,
+	 hash_table_storage Storage>
+typename hash_table<Descriptor, Allocator, Storage>::value_type &
+hash_table<Descriptor, Allocator, Storage>
 ::find_with_hash (const compare_type &comparable, hashval_t hash)
 {
+  if (Storage == HASH_TABLE_CONTROL_BYTES)
+    {
+      value_type *deleted_slot, *empty_slot;
+      value_type *slot = find_in_groups (comparable, hash, &deleted_slot,
+					 &empty_slot);
+      return slot ? *slot : *empty_slot;
+    }
+
   m_searches++;
   size_t size = m_size;
   hashval_t index = hash_table_mod1 (hash, m_size_prime_index);
@@ -850,15 +1144,39 @@ hash_table<Descriptor, Allocator>
    write the value you want into the returned slot.  When inserting an
    entry, NULL may be returned if memory allocation fails. */
 
-template<typename Descriptor, template<typename Type> class Allocator>
-typename hash_table<Descriptor, Allocator>::value_type *
-hash_table<Descriptor, Allocator>
+template<typename Descriptor, template<typename Type> class Allocator,
+	 hash_table_storage Storage>
+typename hash_table<Descriptor, Allocator, Storage>::value_type *
+hash_table<Descriptor, Allocator, Storage>
 ::find_slot_with_hash (const compare_type &comparable, hashval_t hash,
 		       enum insert_option insert)
 {
   if (insert == INSERT && m_size * 3 <= m_n_elements * 4)
     expand ();
 
+  if (Storage == HASH_TABLE_CONTROL_BYTES)
+    {
+      value_type *deleted_slot, *empty_slot;
+      value_type *slot = find_in_groups (comparable, hash, &deleted_slot,
+					 &empty_slot);
+      if (slot || insert == NO_INSERT)
+	return slot;
+
+      if (deleted_slot)
+	{
+	  m_n_deleted--;
+	  mark_empty (*deleted_slot);
+	  slot = deleted_slot;
+	}
+      else
+	{
+	  m_n_elements++;
+	  slot = empty_slot;
+	}
+      m_control[slot - m_entries] = hash_table_mix (hash) & 0x7f;
+      return slot;
+    }
+
   m_searches++;
 
   value_type *first_deleted_slot = NULL;
@@ -911,19 +1229,17 @@ hash_table<Descriptor, Allocator>
    from hash table starting with the given HASH.  If there is no
    matching element in the hash table, this function does nothing. */
 
-template<typename Descriptor, template<typename Type> class Allocator>
+template<typename Descriptor, template<typename Type> class Allocator,
+	 hash_table_storage Storage>
 void
-hash_table<Descriptor, Allocator>
+hash_table<Descriptor, Allocator, Storage>
 ::remove_elt_with_hash (const compare_type &comparable, hashval_t hash)
 {
   value_type *slot = find_slot_with_hash (comparable, hash, NO_INSERT);
-  if (is_empty (*slot))
+  if (slot == NULL)
     return;
 
-  Descriptor::remove (*slot);
-
-  mark_deleted (*slot);
-  m_n_deleted++;
+  clear_slot (slot);
 }
 
 /* This function scans over the entire hash table calling CALLBACK for
@@ -931,13 +1247,15 @@ hash_table<Descriptor, Allocator>
    ARGUMENT is passed as CALLBACK's second argument. */
 
 template<typename Descriptor,
-	  template<typename Type> class Allocator>
+	  template<typename Type> class Allocator,
+	  hash_table_storage Storage>
 template<typename Argument,
 	  int (*Callback)
-     (typename hash_table<Descriptor, Allocator>::value_type *slot,
+     (typename hash_table<Descriptor, Allocator, Storage>::value_type *slot,
       Argument argument)>
 void
-hash_table<Descriptor, Allocator>::traverse_noresize (Argument argument)
+hash_table<Descriptor, Allocator, Storage>
+::traverse_noresize (Argument argument)
 {
   value_type *slot = m_entries;
   value_type *limit = slot + size ();
@@ -957,13 +1275,14 @@ hash_table<Descriptor, Allocator>::traverse_noresize (Argument argument)
    to improve effectivity of subsequent calls.  */
 
 template <typename Descriptor,
-	  template <typename Type> class Allocator>
+	  template <typename Type> class Allocator,
+	  hash_table_storage Storage>
 template <typename Argument,
 	  int (*Callback)
-     (typename hash_table<Descriptor, Allocator>::value_type *slot,
+     (typename hash_table<Descriptor, Allocator, Storage>::value_type *slot,
       Argument argument)>
 void
-hash_table<Descriptor, Allocator>::traverse (Argument argument)
+hash_table<Descriptor, Allocator, Storage>::traverse (Argument argument)
 {
   size_t size = m_size;
   if (elements () * 8 < size && size > 32)
@@ -974,9 +1293,10 @@ hash_table<Descriptor, Allocator>::traverse (Argument argument)
 
 /* Slide down the iterator slots until an active entry is found.  */
 
-template<typename Descriptor, template<typename Type> class Allocator>
+template<typename Descriptor, template<typename Type> class Allocator,
+	 hash_table_storage Storage>
 void
-hash_table<Descriptor, Allocator>::iterator::slide ()
+hash_table<Descriptor, Allocator, Storage>::iterator::slide ()
 {
   for ( ; m_slot < m_limit; ++m_slot )
     {
@@ -990,9 +1310,10 @@ hash_table<Descriptor, Allocator>::iterator::slide ()
 
 /* Bump the iterator.  */
 
-template<typename Descriptor, template<typename Type> class Allocator>
-inline typename hash_table<Descriptor, Allocator>::iterator &
-hash_table<Descriptor, Allocator>::iterator::operator ++ ()
+template<typename Descriptor, template<typename Type> class Allocator,
+	 hash_table_storage Storage>
+inline typename hash_table<Descriptor, Allocator, Storage>::iterator &
+hash_table<Descriptor, Allocator, Storage>::iterator::operator ++ ()
 {
   ++m_slot;
   slide ();
@@ -887,6 +887,10 @@ dump_line_table_statistics (void)
 	   STAT_LABEL (s.adhoc_table_size));
   fprintf (stderr, "Ad-hoc table entries used:           %5ld\n",
 	   s.adhoc_table_entries_used);
+  fprintf (stderr, "Ad-hoc wide ranges used:             %5ld\n",
+	   s.adhoc_wide_ranges_used);
+  fprintf (stderr, "Ad-hoc data pointers used:           %5ld\n",
+	   s.adhoc_data_ptrs_used);
   fprintf (stderr, "optimized_ranges: %i\n",
 	   line_table->num_optimized_ranges);
   fprintf (stderr, "unoptimized_ranges: %i\n",
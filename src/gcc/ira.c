@@ -391,6 +391,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "rtl-iter.h"
 #include "shrink-wrap.h"
 #include "print-rtl.h"
+#include "params.h"
 
 struct target_ira default_target_ira;
 struct target_ira_int default_target_ira_int;
@@ -5165,6 +5166,8 @@ ira (FILE *f)
   gcc_obstack_init (&ira_obstack);
 #endif
   bitmap_obstack_initialize (&ira_bitmap_obstack);
+  bitmap_obstack_set_hybrid (&ira_bitmap_obstack,
+			     PARAM_VALUE (PARAM_HYBRID_BITMAPS));
 
   /* LRA uses its own infrastructure to handle caller save registers.  */
   if (flag_caller_saves && !ira_use_lra_p)
@@ -53,6 +53,24 @@ struct lto_compression_stream
 static const size_t Z_BUFFER_LENGTH = 4096;
 static const size_t MIN_STREAM_ALLOCATION = 1024;
 
+/* Constants for the in-tree LZ codec.  An LZ segment starts with the
+   two magic bytes below, followed by the uncompressed and the compressed
+   payload sizes as ULEB128 numbers.  The low nibble of the first magic
+   byte is not 8 (Z_DEFLATED), so a zlib stream header never matches it
+   and segments of both kinds can be told apart when reading.
+
+   The payload is a sequence of LZ4-style tokens: the high nibble of a
+   token is the literal count and the low nibble the match length minus
+   LZ_MIN_MATCH, each extended by 255-terminated bytes when it is 15.
+   The literals follow, then a little-endian 16-bit match offset.  The
+   last token of a segment carries literals only.  */
+
+static const unsigned char LZ_MAGIC0 = 'L';
+static const unsigned char LZ_MAGIC1 = 'Z';
+static const size_t LZ_MIN_MATCH = 4;
+static const size_t LZ_MAX_OFFSET = 65535;
+#define LZ_HASH_BITS 14
+
 /* For zlib, allocate SIZE count of ITEMS and return the address, OPAQUE
    is unused.  */
 
@@ -163,10 +181,10 @@ lto_compress_block (struct lto_compression_stream *stream,
   lto_stats.num_output_il_bytes += num_chars;
 }
 
-/* Finalize STREAM compression, and free stream allocations.  */
+/* Compress STREAM with zlib, passing the output to its callback.  */
 
-void
-lto_end_compression (struct lto_compression_stream *stream)
+static void
+lto_zlib_compress (struct lto_compression_stream *stream)
 {
   unsigned char *cursor = (unsigned char *) stream->buffer;
   size_t remaining = stream->bytes;
@@ -176,10 +194,6 @@ lto_end_compression (struct lto_compression_stream *stream)
   size_t compressed_bytes = 0;
   int status;
 
-  gcc_assert (stream->is_compression);
-
-  timevar_push (TV_IPA_LTO_COMPRESS);
-
   out_stream.next_out = outbuf;
   out_stream.avail_out = outbuf_length;
   out_stream.next_in = cursor;
@@ -221,8 +235,163 @@ lto_end_compression (struct lto_compression_stream *stream)
   if (status != Z_OK)
     internal_error ("compressed stream: %s", zError (status));
 
-  lto_destroy_compression_stream (stream);
   free (outbuf);
+}
+
+/* Read four bytes at P as a little-endian number, independently of the
+   host byte order so that the LZ output does not depend on the host.  */
+
+static inline unsigned
+lz_read4 (const unsigned char *p)
+{
+  return (p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned) p[3] << 24));
+}
+
+/* Return the LZ match-finder hash of the four bytes at P.  */
+
+static inline unsigned
+lz_hash (const unsigned char *p)
+{
+  return (lz_read4 (p) * 2654435761U) >> (32 - LZ_HASH_BITS);
+}
+
+/* Write VALUE as ULEB128 to OUT and return the advanced pointer.  */
+
+static unsigned char *
+lz_write_uleb128 (unsigned char *out, size_t value)
+{
+  do
+    {
+      unsigned char byte = value & 0x7f;
+      value >>= 7;
+      if (value)
+	byte |= 0x80;
+      *out++ = byte;
+    }
+  while (value);
+  return out;
+}
+
+/* Write the extension bytes of a token field of LENGTH to OUT and return
+   the advanced pointer.  LENGTH is known to be at least 15.  */
+
+static unsigned char *
+lz_write_length (unsigned char *out, size_t length)
+{
+  for (length -= 15; length >= 255; length -= 255)
+    *out++ = 255;
+  *out++ = length;
+  return out;
+}
+
+/* Write a token for NLITERALS literals starting at LITERALS followed by
+   a match of MATCH_LENGTH bytes at OFFSET to OUT, and return the advanced
+   pointer.  A zero MATCH_LENGTH terminates the segment.  */
+
+static unsigned char *
+lz_write_sequence (unsigned char *out, const unsigned char *literals,
+		   size_t nliterals, size_t offset, size_t match_length)
+{
+  size_t match_code = match_length ? match_length - LZ_MIN_MATCH : 0;
+
+  *out++ = ((MIN (nliterals, 15) << 4) | MIN (match_code, 15));
+  if (nliterals >= 15)
+    out = lz_write_length (out, nliterals);
+  memcpy (out, literals, nliterals);
+  out += nliterals;
+  if (match_length)
+    {
+      *out++ = offset & 0xff;
+      *out++ = offset >> 8;
+      if (match_code >= 15)
+	out = lz_write_length (out, match_code);
+    }
+  return out;
+}
+
+/* Compress STREAM with the in-tree LZ codec, passing the output to its
+   callback.  The codec trades compression ratio for speed; in particular
+   decompression needs no state beyond the output buffer.  */
+
+static void
+lto_lz_compress (struct lto_compression_stream *stream)
+{
+  const unsigned char *in = (const unsigned char *) stream->buffer;
+  size_t length = stream->bytes;
+  size_t bound = length + length / 255 + 16;
+  unsigned char *payload = (unsigned char *) xmalloc (bound);
+  unsigned char *out = payload;
+  unsigned char header[2 + 2 * 10];
+  unsigned char *hp = header;
+  unsigned *table = XCNEWVEC (unsigned, 1 << LZ_HASH_BITS);
+  size_t anchor = 0, pos = 0;
+
+  /* A compression level of zero asks for stored data, which for this
+     codec means literals only.  */
+  if (flag_lto_compression_level != 0)
+    while (pos + LZ_MIN_MATCH <= length)
+      {
+	unsigned hash = lz_hash (in + pos);
+	size_t candidate = table[hash];
+	size_t match_length;
+
+	table[hash] = pos;
+	if (candidate >= pos
+	    || pos - candidate > LZ_MAX_OFFSET
+	    || lz_read4 (in + candidate) != lz_read4 (in + pos))
+	  {
+	    pos++;
+	    continue;
+	  }
+
+	match_length = LZ_MIN_MATCH;
+	while (pos + match_length < length
+	       && in[candidate + match_length] == in[pos + match_length])
+	  match_length++;
+
+	out = lz_write_sequence (out, in + anchor, pos - anchor,
+				 pos - candidate, match_length);
+	pos += match_length;
+	anchor = pos;
+      }
+  out = lz_write_sequence (out, in + anchor, length - anchor, 0, 0);
+  gcc_assert ((size_t) (out - payload) <= bound);
+
+  *hp++ = LZ_MAGIC0;
+  *hp++ = LZ_MAGIC1;
+  hp = lz_write_uleb128 (hp, length);
+  hp = lz_write_uleb128 (hp, out - payload);
+
+  stream->callback ((const char *) header, hp - header, stream->opaque);
+  stream->callback ((const char *) payload, out - payload, stream->opaque);
+  lto_stats.num_compressed_il_bytes += (hp - header) + (out - payload);
+
+  free (table);
+  free (payload);
+}
+
+/* Finalize STREAM compression, and free stream allocations.  */
+
+void
+lto_end_compression (struct lto_compression_stream *stream)
+{
+  gcc_assert (stream->is_compression);
+
+  timevar_push (TV_IPA_LTO_COMPRESS);
+
+  switch (flag_lto_compression_algorithm)
+    {
+    case LTO_COMPRESSION_ZLIB:
+      lto_zlib_compress (stream);
+      break;
+    case LTO_COMPRESSION_LZ:
+      lto_lz_compress (stream);
+      break;
+    default:
+      gcc_unreachable ();
+    }
+
+  lto_destroy_compression_stream (stream);
   timevar_pop (TV_IPA_LTO_COMPRESS);
 }
 
@@ -248,11 +417,197 @@ lto_uncompress_block (struct lto_compression_stream *stream,
   lto_stats.num_input_il_bytes += num_chars;
 }
 
+/* Uncompress the zlib segment of REMAINING bytes at CURSOR, passing the
+   output to the callback of STREAM through OUTBUF of OUTBUF_LENGTH bytes.
+   Return the number of input bytes consumed.  */
+
+static size_t
+lto_zlib_uncompress_segment (struct lto_compression_stream *stream,
+			     const unsigned char *cursor, size_t remaining,
+			     unsigned char *outbuf, size_t outbuf_length)
+{
+  size_t consumed = 0;
+  z_stream in_stream;
+  size_t out_bytes;
+  int status;
+
+  in_stream.next_out = outbuf;
+  in_stream.avail_out = outbuf_length;
+  in_stream.next_in = CONST_CAST (unsigned char *, cursor);
+  in_stream.avail_in = remaining;
+  in_stream.zalloc = lto_zalloc;
+  in_stream.zfree = lto_zfree;
+  in_stream.opaque = Z_NULL;
+
+  status = inflateInit (&in_stream);
+  if (status != Z_OK)
+    internal_error ("compressed stream: %s", zError (status));
+
+  do
+    {
+      size_t in_bytes;
+
+      status = inflate (&in_stream, Z_SYNC_FLUSH);
+      if (status != Z_OK && status != Z_STREAM_END)
+	internal_error ("compressed stream: %s", zError (status));
+
+      in_bytes = remaining - in_stream.avail_in;
+      out_bytes = outbuf_length - in_stream.avail_out;
+
+      stream->callback ((const char *) outbuf, out_bytes, stream->opaque);
+      lto_stats.num_uncompressed_il_bytes += out_bytes;
+
+      cursor += in_bytes;
+      remaining -= in_bytes;
+      consumed += in_bytes;
+
+      in_stream.next_out = outbuf;
+      in_stream.avail_out = outbuf_length;
+      in_stream.next_in = CONST_CAST (unsigned char *, cursor);
+      in_stream.avail_in = remaining;
+    }
+  while (!(status == Z_STREAM_END && out_bytes == 0));
+
+  status = inflateEnd (&in_stream);
+  if (status != Z_OK)
+    internal_error ("compressed stream: %s", zError (status));
+
+  return consumed;
+}
+
+/* Read a ULEB128 number from *CURSOR, which has *REMAINING bytes left,
+   into *VALUE and advance both.  Return false on truncated input.  */
+
+static bool
+lz_read_uleb128 (const unsigned char **cursor, size_t *remaining,
+		 size_t *value)
+{
+  unsigned shift = 0;
+
+  *value = 0;
+  while (*remaining > 0 && shift < sizeof (size_t) * 8)
+    {
+      unsigned char byte = *(*cursor)++;
+      (*remaining)--;
+      *value |= (size_t) (byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+	return true;
+      shift += 7;
+    }
+  return false;
+}
+
+/* Read the extension bytes of a token field from IN, which ends at END,
+   and add them to *LENGTH.  Return the advanced pointer, or NULL on
+   truncated input.  */
+
+static const unsigned char *
+lz_read_length (const unsigned char *in, const unsigned char *end,
+		size_t *length)
+{
+  unsigned char byte;
+
+  do
+    {
+      if (in == end)
+	return NULL;
+      byte = *in++;
+      *length += byte;
+    }
+  while (byte == 255);
+  return in;
+}
+
+/* Uncompress the LZ segment of REMAINING bytes at CURSOR, passing the
+   output to the callback of STREAM.  Return the number of input bytes
+   consumed.  */
+
+static size_t
+lto_lz_uncompress_segment (struct lto_compression_stream *stream,
+			   const unsigned char *cursor, size_t remaining)
+{
+  const unsigned char *start = cursor;
+  const unsigned char *in, *end;
+  unsigned char *outbuf, *out, *out_end;
+  size_t length, payload_length;
+
+  cursor += 2;
+  remaining -= 2;
+  if (!lz_read_uleb128 (&cursor, &remaining, &length)
+      || !lz_read_uleb128 (&cursor, &remaining, &payload_length)
+      || payload_length > remaining)
+    internal_error ("compressed stream: truncated LZ segment header");
+
+  in = cursor;
+  end = cursor + payload_length;
+  outbuf = out = (unsigned char *) xmalloc (length ? length : 1);
+  out_end = outbuf + length;
+
+  while (1)
+    {
+      size_t nliterals, match_length, offset;
+      unsigned char token;
+
+      if (in == end)
+	goto corrupt;
+      token = *in++;
+
+      nliterals = token >> 4;
+      if (nliterals == 15 && !(in = lz_read_length (in, end, &nliterals)))
+	goto corrupt;
+      if (nliterals > (size_t) (end - in)
+	  || nliterals > (size_t) (out_end - out))
+	goto corrupt;
+      memcpy (out, in, nliterals);
+      in += nliterals;
+      out += nliterals;
+
+      /* The literal-only token ends the segment.  */
+      if (in == end)
+	break;
+
+      if (end - in < 2)
+	goto corrupt;
+      offset = in[0] | (in[1] << 8);
+      in += 2;
+      match_length = token & 15;
+      if (match_length == 15
+	  && !(in = lz_read_length (in, end, &match_length)))
+	goto corrupt;
+      match_length += LZ_MIN_MATCH;
+      if (offset == 0
+	  || offset > (size_t) (out - outbuf)
+	  || match_length > (size_t) (out_end - out))
+	goto corrupt;
+
+      if (offset >= match_length)
+	memcpy (out, out - offset, match_length);
+      else
+	/* Overlapping copy replicating the last OFFSET bytes.  */
+	for (size_t i = 0; i < match_length; i++)
+	  out[i] = out[i - offset];
+      out += match_length;
+    }
+
+  if (out != out_end)
+    goto corrupt;
+
+  stream->callback ((const char *) outbuf, length, stream->opaque);
+  lto_stats.num_uncompressed_il_bytes += length;
+  free (outbuf);
+  return end - start;
+
+ corrupt:
+  internal_error ("compressed stream: corrupt LZ segment");
+}
+
 /* Finalize STREAM uncompression, and free stream allocations.
 
    Because of the way LTO IL streams are compressed, there may be several
    concatenated compressed segments in the accumulated data, so for this
-   function we iterate decompressions until no data remains.  */
+   function we iterate decompressions until no data remains.  Each segment
+   may have been written by either codec; LZ segments are recognized by
+   their magic bytes.  */
 
 void
 lto_end_uncompression (struct lto_compression_stream *stream)
@@ -261,57 +616,21 @@ lto_end_uncompression (struct lto_compression_stream *stream)
   size_t remaining = stream->bytes;
   const size_t outbuf_length = Z_BUFFER_LENGTH;
   unsigned char *outbuf = (unsigned char *) xmalloc (outbuf_length);
-  size_t uncompressed_bytes = 0;
 
   gcc_assert (!stream->is_compression);
   timevar_push (TV_IPA_LTO_DECOMPRESS);
 
   while (remaining > 0)
     {
-      z_stream in_stream;
-      size_t out_bytes;
-      int status;
+      size_t in_bytes;
 
-      in_stream.next_out = outbuf;
-      in_stream.avail_out = outbuf_length;
-      in_stream.next_in = cursor;
-      in_stream.avail_in = remaining;
-      in_stream.zalloc = lto_zalloc;
-      in_stream.zfree = lto_zfree;
-      in_stream.opaque = Z_NULL;
-
-      status = inflateInit (&in_stream);
-      if (status != Z_OK)
-	internal_error ("compressed stream: %s", zError (status));
-
-      do
-	{
-	  size_t in_bytes;
-
-	  status = inflate (&in_stream, Z_SYNC_FLUSH);
-	  if (status != Z_OK && status != Z_STREAM_END)
-	    internal_error ("compressed stream: %s", zError (status));
-
-	  in_bytes = remaining - in_stream.avail_in;
-	  out_bytes = outbuf_length - in_stream.avail_out;
-
-	  stream->callback ((const char *) outbuf, out_bytes, stream->opaque);
-	  lto_stats.num_uncompressed_il_bytes += out_bytes;
-	  uncompressed_bytes += out_bytes;
-
-	  cursor += in_bytes;
-	  remaining -= in_bytes;
-
-	  in_stream.next_out = outbuf;
-	  in_stream.avail_out = outbuf_length;
-	  in_stream.next_in = cursor;
-	  in_stream.avail_in = remaining;
-	}
-      while (!(status == Z_STREAM_END && out_bytes == 0));
-
-      status = inflateEnd (&in_stream);
-      if (status != Z_OK)
-	internal_error ("compressed stream: %s", zError (status));
+      if (remaining >= 2 && cursor[0] == LZ_MAGIC0 && cursor[1] == LZ_MAGIC1)
+	in_bytes = lto_lz_uncompress_segment (stream, cursor, remaining);
+      else
+	in_bytes = lto_zlib_uncompress_segment (stream, cursor, remaining,
+						outbuf, outbuf_length);
+      cursor += in_bytes;
+      remaining -= in_bytes;
     }
 
   lto_destroy_compression_stream (stream);
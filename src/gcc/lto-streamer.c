@@ -237,6 +237,18 @@ print_lto_report (const char *s)
 	       HOST_WIDE_INT_PRINT_UNSIGNED "\n", s,
 	       lto_stats.num_cgraph_partitions);
 
+      fprintf (stderr, "[%s] # of cut call edges: "
+	       HOST_WIDE_INT_PRINT_UNSIGNED "\n", s,
+	       lto_stats.num_cut_call_edges);
+
+      fprintf (stderr, "[%s] # of cut references: "
+	       HOST_WIDE_INT_PRINT_UNSIGNED "\n", s,
+	       lto_stats.num_cut_references);
+
+      fprintf (stderr, "[%s] # of partition boundary symbols: "
+	       HOST_WIDE_INT_PRINT_UNSIGNED "\n", s,
+	       lto_stats.num_boundary_symbols);
+
       fprintf (stderr, "[%s] Compression: "
 	       HOST_WIDE_INT_PRINT_UNSIGNED " input bytes, "
 	       HOST_WIDE_INT_PRINT_UNSIGNED " uncompressed bytes", s,
@@ -439,6 +439,9 @@ struct lto_stats_d
   unsigned HOST_WIDE_INT num_input_files;
   unsigned HOST_WIDE_INT num_output_files;
   unsigned HOST_WIDE_INT num_cgraph_partitions;
+  unsigned HOST_WIDE_INT num_cut_call_edges;
+  unsigned HOST_WIDE_INT num_cut_references;
+  unsigned HOST_WIDE_INT num_boundary_symbols;
   unsigned HOST_WIDE_INT section_size[LTO_N_SECTION_TYPES];
   unsigned HOST_WIDE_INT num_function_bodies;
   unsigned HOST_WIDE_INT num_trees[NUM_TREE_CODES];
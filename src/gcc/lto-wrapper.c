@@ -48,6 +48,13 @@ along with GCC; see the file COPYING3.  If not see
 #include "simple-object.h"
 #include "lto-section-names.h"
 #include "collect-utils.h"
+#include "md5.h"
+#include "version.h"
+#include <dirent.h>
+
+#ifdef HAVE_WORKING_FORK
+#include <poll.h>
+#endif
 
 /* Environment variable, used for passing the names of offload targets from GCC
    driver to lto-wrapper.  */
@@ -71,8 +78,29 @@ static char **offload_names;
 static char *offload_objects_file_name;
 static char *makefile;
 
+/* File descriptors of the GNU make jobserver pipe, or -1 if we are not
+   talking to a jobserver.  */
+static int jobserver_rfd = -1;
+static int jobserver_wfd = -1;
+/* Number of jobserver tokens currently held by the LTRANS scheduler.  */
+static unsigned jobserver_tokens;
+/* True in the forked helper that runs a single LTRANS job.  */
+static bool ltrans_job_child;
+
+/* Directory of the LTRANS object cache, or NULL if it is not used.  */
+static const char *ltrans_cache_dir;
+/* Maximum number of objects kept in the LTRANS object cache.  */
+static unsigned ltrans_cache_size = 2048;
+/* Cache keys of the LTRANS partitions, indexed like input_names.  NULL
+   for partitions that need not be stored in the cache.  */
+static char **ltrans_cache_keys;
+/* Number of LTRANS objects taken from and added to the cache.  */
+static unsigned ltrans_cache_hits, ltrans_cache_misses;
+
 const char tool_name[] = "lto-wrapper";
 
+static void jobserver_release (void);
+
 /* Delete tempfiles.  Called from utils_cleanup.  */
 
 void
@@ -80,6 +108,13 @@ tool_cleanup (bool)
 {
   unsigned int i;
 
+  /* The temporary files and the jobserver tokens are owned by the
+     parent lto-wrapper; a failing LTRANS job leaves them alone.  */
+  if (ltrans_job_child)
+    return;
+
+  while (jobserver_tokens)
+    jobserver_release ();
   if (ltrans_output_file)
     maybe_unlink (ltrans_output_file);
   if (flto_out)
@@ -594,6 +629,8 @@ append_linker_options (obstack *argv_obstack, struct cl_decoded_option *opts,
 	case OPT_o:
 	case OPT_flto_:
 	case OPT_flto:
+	case OPT_flto_incremental_:
+	case OPT_flto_incremental_cache_size_:
 	  /* We've handled these LTO options, do not pass them on.  */
 	  continue;
 
@@ -828,6 +865,10 @@ copy_file (const char *dest, const char *src)
   FILE *d = fopen (dest, "wb");
   FILE *s = fopen (src, "rb");
   char buffer[512];
+  if (d == NULL)
+    fatal_error (input_location, "cannot open %s: %m", dest);
+  if (s == NULL)
+    fatal_error (input_location, "cannot open %s: %m", src);
   while (!feof (s))
     {
       size_t len = fread (buffer, 1, 512, s);
@@ -840,6 +881,9 @@ copy_file (const char *dest, const char *src)
 	    fatal_error (input_location, "writing output file");
 	}
     }
+  fclose (s);
+  if (fclose (d) != 0)
+    fatal_error (input_location, "writing output file");
 }
 
 /* Find the crtoffloadtable.o file in LIBRARY_PATH, make copy and pass name of
@@ -940,6 +984,524 @@ find_and_merge_options (int fd, off_t file_offset, const char *prefix,
   return true;
 }
 
+/* Set up the LTRANS object cache in DIR, creating the directory if
+   needed.  Leave the cache disabled if DIR cannot be used.  */
+
+static void
+ltrans_cache_init (const char *dir)
+{
+  struct stat st;
+
+  if (stat (dir, &st) != 0 && mkdir (dir, 0777) != 0 && errno != EEXIST)
+    {
+      warning (0, "cannot create LTRANS cache directory %s: %m", dir);
+      return;
+    }
+  if (stat (dir, &st) != 0 || !S_ISDIR (st.st_mode)
+      || access (dir, R_OK | W_OK | X_OK) != 0)
+    {
+      warning (0, "LTRANS cache %s is not a writable directory", dir);
+      return;
+    }
+  ltrans_cache_dir = dir;
+}
+
+/* Return the cache key of LTRANS partition I compiled with the command
+   line NEW_ARGV.  The key covers the compiler version, the first
+   HEAD_ARGC arguments, which are the same for all partitions, and the
+   contents of the streamed partition.  */
+
+static char *
+ltrans_cache_key (const char **new_argv, int head_argc, unsigned i)
+{
+  struct md5_ctx ctx;
+  unsigned char digest[16];
+  char buffer[4096];
+  char *key;
+  size_t len;
+  FILE *f;
+  int j;
+
+  md5_init_ctx (&ctx);
+  md5_process_bytes (version_string, strlen (version_string) + 1, &ctx);
+  for (j = 0; j < head_argc; j++)
+    {
+      /* Where the dumps go does not change the generated code.  */
+      if (strcmp (new_argv[j], "-dumpdir") == 0)
+	{
+	  j++;
+	  continue;
+	}
+      md5_process_bytes (new_argv[j], strlen (new_argv[j]) + 1, &ctx);
+    }
+
+  f = fopen (input_names[i], "rb");
+  if (f == NULL)
+    fatal_error (input_location, "cannot open %s: %m", input_names[i]);
+  while ((len = fread (buffer, 1, sizeof (buffer), f)) > 0)
+    md5_process_bytes (buffer, len, &ctx);
+  if (ferror (f))
+    fatal_error (input_location, "reading %s: %m", input_names[i]);
+  fclose (f);
+  md5_finish_ctx (&ctx, digest);
+
+  key = XNEWVEC (char, 2 * sizeof (digest) + 1);
+  for (j = 0; j < (int) sizeof (digest); j++)
+    sprintf (key + 2 * j, "%02x", digest[j]);
+  return key;
+}
+
+/* Return the file name of the cache entry for KEY.  */
+
+static char *
+ltrans_cache_entry (const char *key)
+{
+  return concat (ltrans_cache_dir, "/", key, ".o", NULL);
+}
+
+/* Store the LTRANS object OUTPUT in the cache under KEY.  The object is
+   copied to a temporary file first and then renamed, so that concurrent
+   links never see a partially written entry.  */
+
+static void
+ltrans_cache_store (const char *key, const char *output)
+{
+  char *entry = ltrans_cache_entry (key);
+  char suffix[32];
+  char *tmp;
+
+  snprintf (suffix, sizeof (suffix), ".%ld.tmp", (long) getpid ());
+  tmp = concat (entry, suffix, NULL);
+  copy_file (tmp, output);
+  if (rename (tmp, entry) != 0)
+    unlink (tmp);
+  free (tmp);
+  free (entry);
+}
+
+/* If the cache holds an object for KEY, copy it to OUTPUT and return
+   true.  */
+
+static bool
+ltrans_cache_lookup (const char *key, const char *output)
+{
+  char *entry = ltrans_cache_entry (key);
+  bool found = access (entry, R_OK) == 0;
+
+  if (found)
+    {
+      copy_file (output, entry);
+      /* Store the object again to mark it as recently used.  */
+      ltrans_cache_store (key, output);
+    }
+  free (entry);
+  return found;
+}
+
+/* An entry of the LTRANS object cache, used when trimming it.  */
+
+struct ltrans_cache_file
+{
+  char *name;
+  time_t mtime;
+};
+
+/* Order cache entries from the least to the most recently used.  */
+
+static int
+cmp_ltrans_cache_file (const void *pa, const void *pb)
+{
+  const struct ltrans_cache_file *a = (const struct ltrans_cache_file *) pa;
+  const struct ltrans_cache_file *b = (const struct ltrans_cache_file *) pb;
+
+  if (a->mtime != b->mtime)
+    return a->mtime < b->mtime ? -1 : 1;
+  return strcmp (a->name, b->name);
+}
+
+/* Remove the least recently used objects from the cache until no more
+   than ltrans_cache_size of them remain.  */
+
+static void
+ltrans_cache_trim (void)
+{
+  struct ltrans_cache_file *files = NULL;
+  unsigned nfiles = 0, allocated = 0, i;
+  struct dirent *de;
+  DIR *dir;
+
+  dir = opendir (ltrans_cache_dir);
+  if (dir == NULL)
+    return;
+  while ((de = readdir (dir)) != NULL)
+    {
+      size_t len = strlen (de->d_name);
+      struct stat st;
+      char *name;
+
+      /* Only look at finished entries; leave files of concurrent links
+	 that are still being written alone.  */
+      if (len != 2 * 16 + 2 || strcmp (de->d_name + 2 * 16, ".o") != 0)
+	continue;
+      name = concat (ltrans_cache_dir, "/", de->d_name, NULL);
+      if (stat (name, &st) != 0)
+	{
+	  free (name);
+	  continue;
+	}
+      if (nfiles == allocated)
+	{
+	  allocated = allocated ? 2 * allocated : 64;
+	  files = XRESIZEVEC (struct ltrans_cache_file, files, allocated);
+	}
+      files[nfiles].name = name;
+      files[nfiles].mtime = st.st_mtime;
+      nfiles++;
+    }
+  closedir (dir);
+
+  if (nfiles > ltrans_cache_size)
+    {
+      qsort (files, nfiles, sizeof (struct ltrans_cache_file),
+	     cmp_ltrans_cache_file);
+      for (i = 0; i < nfiles - ltrans_cache_size; i++)
+	unlink (files[i].name);
+    }
+  for (i = 0; i < nfiles; i++)
+    free (files[i].name);
+  free (files);
+}
+
+/* Return the number of processors that can run LTRANS jobs.  */
+
+static int
+number_of_cpus (void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+  long n = sysconf (_SC_NPROCESSORS_ONLN);
+  if (n > 0)
+    return n;
+#endif
+  return 1;
+}
+
+/* Return the current wall clock time in seconds.  */
+
+static double
+wall_time (void)
+{
+#ifdef HAVE_GETTIMEOFDAY
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+#else
+  return time (NULL);
+#endif
+}
+
+/* Tokens read from the jobserver, written back in reverse order.  */
+static char *jobserver_token_chars;
+
+/* Give the most recently acquired jobserver token back to make.  */
+
+static void
+jobserver_release (void)
+{
+  char c = jobserver_token_chars[--jobserver_tokens];
+  if (write (jobserver_wfd, &c, 1) != 1)
+    fatal_error (input_location, "cannot release jobserver token: %m");
+}
+
+#ifdef HAVE_WORKING_FORK
+/* Look for the GNU make jobserver in MAKEFLAGS.  If one is present and
+   was passed down to us, set up jobserver_rfd and jobserver_wfd and
+   return true.  */
+
+static bool
+jobserver_init (void)
+{
+  const char *makeflags = getenv ("MAKEFLAGS");
+  const char *p;
+  char buf[32];
+  int rfd, wfd, fd;
+
+  if (!makeflags)
+    return false;
+
+  /* GNU make 4.4 and later use a named pipe.  */
+  if ((p = strstr (makeflags, "--jobserver-auth=fifo:")) != NULL)
+    {
+      char *path = xstrdup (p + sizeof ("--jobserver-auth=fifo:") - 1);
+      path[strcspn (path, " ")] = '\0';
+      fd = open (path, O_RDWR | O_NONBLOCK);
+      free (path);
+      if (fd < 0)
+	return false;
+      jobserver_rfd = jobserver_wfd = fd;
+      return true;
+    }
+
+  if ((p = strstr (makeflags, "--jobserver-auth=")) == NULL
+      && (p = strstr (makeflags, "--jobserver-fds=")) == NULL)
+    return false;
+  if (sscanf (strchr (p, '=') + 1, "%d,%d", &rfd, &wfd) != 2
+      || rfd < 0 || wfd < 0)
+    return false;
+
+  /* Make closes the pipe for commands it does not consider recursive.  */
+  if (fcntl (rfd, F_GETFD) < 0 || fcntl (wfd, F_GETFD) < 0)
+    return false;
+
+  /* Reopen the read end so that we can poll it without blocking and
+     without changing the file status flags make and its other children
+     see.  If the reopened descriptor turns out to be shared, fall back
+     to the inherited one.  */
+  snprintf (buf, sizeof (buf), "/dev/fd/%d", rfd);
+  fd = open (buf, O_RDONLY | O_NONBLOCK);
+  if (fd >= 0
+      && (fcntl (fd, F_GETFL) & O_NONBLOCK) != 0
+      && (fcntl (rfd, F_GETFL) & O_NONBLOCK) == 0)
+    jobserver_rfd = fd;
+  else
+    {
+      if (fd >= 0)
+	{
+	  fcntl (rfd, F_SETFL, fcntl (rfd, F_GETFL) & ~O_NONBLOCK);
+	  close (fd);
+	}
+      jobserver_rfd = rfd;
+    }
+  jobserver_wfd = wfd;
+  return true;
+}
+
+/* Try to take a token from the jobserver without blocking.  */
+
+static bool
+jobserver_acquire (void)
+{
+  struct pollfd pfd;
+  char c;
+
+  pfd.fd = jobserver_rfd;
+  pfd.events = POLLIN;
+  if (poll (&pfd, 1, 0) <= 0
+      || read (jobserver_rfd, &c, 1) != 1)
+    return false;
+  jobserver_token_chars[jobserver_tokens++] = c;
+  return true;
+}
+
+/* Wait at most TIMEOUT milliseconds for a jobserver token to show up.  */
+
+static void
+jobserver_wait (int timeout)
+{
+  struct pollfd pfd;
+
+  pfd.fd = jobserver_rfd;
+  pfd.events = POLLIN;
+  poll (&pfd, 1, timeout);
+}
+#endif
+
+/* Set up the partition specific tail ARGV_PTR of the LTRANS command
+   line for partition I.  LINKER_OUTPUT, if non-NULL, is used to build
+   the dump base.  */
+
+static void
+set_ltrans_argv (const char **argv_ptr, const char *linker_output,
+		 unsigned i)
+{
+  if (linker_output)
+    {
+      char *dumpbase
+	  = (char *) xmalloc (strlen (linker_output)
+			      + sizeof (DUMPBASE_SUFFIX) + 1);
+      snprintf (dumpbase,
+		strlen (linker_output) + sizeof (DUMPBASE_SUFFIX),
+		"%s.ltrans%u", linker_output, i);
+      argv_ptr[0] = dumpbase;
+    }
+
+  argv_ptr[1] = "-fltrans";
+  argv_ptr[2] = "-o";
+  argv_ptr[3] = output_names[i];
+  argv_ptr[4] = input_names[i];
+  argv_ptr[5] = NULL;
+}
+
+/* Return the size of the streamed LTRANS partition I.  */
+
+static off_t
+ltrans_partition_size (unsigned i)
+{
+  struct stat st;
+
+  if (stat (input_names[i], &st) != 0)
+    return 0;
+  return st.st_size;
+}
+
+/* Print the time spent on LTRANS partition I of SIZE bytes that was
+   started at wall time START.  */
+
+static void
+report_ltrans_time (unsigned i, off_t size, double start)
+{
+  fprintf (stderr, "[LTRANS partition %u (%s, %ld bytes): %.3f s]\n",
+	   i, input_names[i], (long) size, wall_time () - start);
+}
+
+#ifdef HAVE_WORKING_FORK
+/* An LTRANS job run by the built-in scheduler.  */
+
+struct ltrans_job
+{
+  /* Index of the partition in input_names and output_names.  */
+  unsigned partition;
+  /* Size of the streamed partition in bytes.  */
+  off_t size;
+  /* Process running the job, or 0 if it is not running.  */
+  pid_t pid;
+  /* Whether the job runs on a token taken from the jobserver.  */
+  bool token;
+  /* Wall clock time the job was started at.  */
+  double start;
+};
+
+/* Order LTRANS jobs by decreasing partition size.  */
+
+static int
+cmp_ltrans_job_size (const void *pa, const void *pb)
+{
+  const struct ltrans_job *a = (const struct ltrans_job *) pa;
+  const struct ltrans_job *b = (const struct ltrans_job *) pb;
+
+  if (a->size != b->size)
+    return a->size > b->size ? -1 : 1;
+  return a->partition < b->partition ? -1 : 1;
+}
+
+/* Fork a helper that compiles the partition of JOB with the command
+   line NEW_ARGV, whose partition specific tail is ARGV_PTR.  */
+
+static void
+start_ltrans_job (struct ltrans_job *job, const char **new_argv,
+		  const char **argv_ptr, const char *linker_output)
+{
+  pid_t pid;
+
+  fflush (stdout);
+  fflush (stderr);
+  job->start = wall_time ();
+  pid = fork ();
+  if (pid == -1)
+    fatal_error (input_location, "fork failed: %m");
+  if (pid == 0)
+    {
+      ltrans_job_child = true;
+      set_ltrans_argv (argv_ptr, linker_output, job->partition);
+      fork_execute (new_argv[0], CONST_CAST (char **, new_argv), true);
+      exit (0);
+    }
+  job->pid = pid;
+}
+
+/* Run the NJOBS LTRANS jobs in JOBS, largest partition first.  At most
+   MAX_JOBS of them run at once; if MAX_JOBS is zero the limit is set by
+   the tokens we get from the jobserver.  NEW_ARGV, ARGV_PTR and
+   LINKER_OUTPUT are as for start_ltrans_job.  If REPORT, print the wall
+   time spent on each partition.  */
+
+static void
+run_ltrans_jobs (struct ltrans_job *jobs, unsigned njobs, unsigned max_jobs,
+		 const char **new_argv, const char **argv_ptr,
+		 const char *linker_output, bool report)
+{
+  unsigned next = 0, running = 0, i;
+
+  qsort (jobs, njobs, sizeof (struct ltrans_job), cmp_ltrans_job_size);
+  if (jobserver_rfd >= 0)
+    jobserver_token_chars = XNEWVEC (char, njobs);
+
+  while (next < njobs || running)
+    {
+      struct ltrans_job *job = NULL;
+      int status;
+      pid_t pid;
+
+      while (next < njobs && (max_jobs == 0 || running < max_jobs))
+	{
+	  /* We may always run one job on the token make has given to the
+	     link; every further job needs a token of its own.  */
+	  if (jobserver_rfd >= 0 && running > jobserver_tokens)
+	    {
+	      if (!jobserver_acquire ())
+		break;
+	      jobs[next].token = true;
+	    }
+	  start_ltrans_job (&jobs[next], new_argv, argv_ptr, linker_output);
+	  next++;
+	  running++;
+	}
+
+      /* While jobs are waiting for a token, keep an eye on the jobserver
+	 as well as on the running jobs.  */
+      if (jobserver_rfd >= 0 && next < njobs)
+	{
+	  pid = waitpid (-1, &status, WNOHANG);
+	  if (pid == 0)
+	    {
+	      jobserver_wait (50);
+	      continue;
+	    }
+	}
+      else
+	pid = waitpid (-1, &status, 0);
+      if (pid == -1)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  fatal_error (input_location, "waitpid failed: %m");
+	}
+
+      for (i = 0; i < next; i++)
+	if (jobs[i].pid == pid)
+	  {
+	    job = &jobs[i];
+	    break;
+	  }
+      if (!job)
+	continue;
+
+      job->pid = 0;
+      running--;
+      if (job->token)
+	{
+	  jobserver_release ();
+	  job->token = false;
+	}
+      if (WIFSIGNALED (status))
+	fatal_error (input_location,
+		     "LTRANS of %s was killed by signal %d",
+		     input_names[job->partition], WTERMSIG (status));
+      if (WIFEXITED (status) && WEXITSTATUS (status))
+	fatal_error (input_location, "LTRANS of %s failed",
+		     input_names[job->partition]);
+      if (report)
+	report_ltrans_time (job->partition, job->size, job->start);
+      if (ltrans_cache_keys && ltrans_cache_keys[job->partition])
+	ltrans_cache_store (ltrans_cache_keys[job->partition],
+			    output_names[job->partition]);
+      maybe_unlink (input_names[job->partition]);
+    }
+
+  XDELETEVEC (jobserver_token_chars);
+  jobserver_token_chars = NULL;
+}
+#endif
+
 /* Execute gcc. ARGC is the number of arguments. ARGV contains the arguments. */
 
 static void
@@ -953,7 +1515,11 @@ run_gcc (unsigned argc, char *argv[])
   const char *collect_gcc, *collect_gcc_options;
   int parallel = 0;
   int jobserver = 0;
+  bool auto_parallel = false;
   bool no_partition = false;
+  bool report = false;
+  bool random_seed = false;
+  const char *cache_dir = NULL;
   struct cl_decoded_option *fdecoded_options = NULL;
   struct cl_decoded_option *offload_fdecoded_options = NULL;
   unsigned int fdecoded_options_count = 0;
@@ -1059,6 +1625,23 @@ run_gcc (unsigned argc, char *argv[])
 	  verbose = 1;
 	  break;
 
+	case OPT_flto_report:
+	  report = true;
+	  break;
+
+	case OPT_flto_incremental_:
+	  cache_dir = option->arg;
+	  break;
+
+	case OPT_flto_incremental_cache_size_:
+	  ltrans_cache_size = option->value;
+	  break;
+
+	case OPT_frandom_seed:
+	case OPT_frandom_seed_:
+	  random_seed = true;
+	  break;
+
 	case OPT_flto_partition_:
 	  if (strcmp (option->arg, "none") == 0)
 	    no_partition = true;
@@ -1070,6 +1653,8 @@ run_gcc (unsigned argc, char *argv[])
 	      jobserver = 1;
 	      parallel = 1;
 	    }
+	  else if (strcmp (option->arg, "auto") == 0)
+	    auto_parallel = true;
 	  else
 	    {
 	      parallel = atoi (option->arg);
@@ -1091,9 +1676,39 @@ run_gcc (unsigned argc, char *argv[])
     {
       lto_mode = LTO_MODE_LTO;
       jobserver = 0;
+      auto_parallel = false;
       parallel = 0;
     }
 
+  /* Use the jobserver of an enclosing GNU make if there is one, and
+     otherwise one job per processor.  Without fork we leave talking to
+     the jobserver to make.  */
+  if (auto_parallel || jobserver)
+    {
+#ifdef HAVE_WORKING_FORK
+      jobserver = jobserver_init ();
+#endif
+      if (jobserver)
+	parallel = 1;
+      else
+	{
+	  parallel = number_of_cpus ();
+	  if (parallel <= 1)
+	    parallel = 0;
+	}
+      if (verbose)
+	{
+	  if (jobserver)
+	    fprintf (stderr, "[Using the jobserver for LTRANS]\n");
+	  else
+	    fprintf (stderr, "[Using %d parallel LTRANS jobs]\n",
+		     parallel ? parallel : 1);
+	}
+    }
+
+  if (cache_dir && lto_mode == LTO_MODE_WHOPR)
+    ltrans_cache_init (cache_dir);
+
   if (linker_output)
     {
       char *output_dir, *base, *name;
@@ -1274,6 +1889,11 @@ cont1:
 	}
       else
         obstack_ptr_grow (&argv_obstack, "-fwpa");
+
+      /* The streamed partitions must not depend on the random seed for
+	 the cache to find them again.  */
+      if (ltrans_cache_dir && !random_seed)
+	obstack_ptr_grow (&argv_obstack, "-frandom-seed=lto-incremental");
     }
 
   /* Append the input objects and possible preceding arguments.  */
@@ -1294,8 +1914,13 @@ cont1:
   else
     {
       FILE *stream = fopen (ltrans_output_file, "r");
-      FILE *mstream = NULL;
       struct obstack env_obstack;
+#ifdef HAVE_WORKING_FORK
+      struct ltrans_job *jobs = NULL;
+      unsigned njobs = 0;
+#else
+      FILE *mstream = NULL;
+#endif
 
       if (!stream)
 	fatal_error (input_location, "fopen: %s: %m", ltrans_output_file);
@@ -1336,14 +1961,21 @@ cont:
       maybe_unlink (ltrans_output_file);
       ltrans_output_file = NULL;
 
+      if (ltrans_cache_dir)
+	ltrans_cache_keys = XCNEWVEC (char *, nr);
+
       if (parallel)
 	{
+#ifdef HAVE_WORKING_FORK
+	  jobs = XCNEWVEC (struct ltrans_job, nr);
+#else
 	  makefile = make_temp_file (".mk");
 	  mstream = fopen (makefile, "w");
+#endif
 	}
 
-      /* Execute the LTRANS stage for each input file (or prepare a
-	 makefile to invoke this in parallel).  */
+      /* Execute the LTRANS stage for each input file (or queue it to
+	 be run in parallel).  */
       for (i = 0; i < nr; ++i)
 	{
 	  char *output_name;
@@ -1357,26 +1989,34 @@ cont:
 	  obstack_grow (&env_obstack, input_name, strlen (input_name) - 2);
 	  obstack_grow (&env_obstack, ".ltrans.o", sizeof (".ltrans.o"));
 	  output_name = XOBFINISH (&env_obstack, char *);
+	  output_names[i] = output_name;
 
-	  /* Adjust the dumpbase if the linker output file was seen.  */
-	  if (linker_output)
+	  /* Reuse the object of an identical partition from the cache.  */
+	  if (ltrans_cache_dir)
 	    {
-	      char *dumpbase
-		  = (char *) xmalloc (strlen (linker_output)
-				      + sizeof (DUMPBASE_SUFFIX) + 1);
-	      snprintf (dumpbase,
-			strlen (linker_output) + sizeof (DUMPBASE_SUFFIX),
-			"%s.ltrans%u", linker_output, i);
-	      argv_ptr[0] = dumpbase;
+	      char *key = ltrans_cache_key (new_argv, new_head_argc, i);
+	      if (ltrans_cache_lookup (key, output_name))
+		{
+		  if (verbose)
+		    fprintf (stderr, "[Reusing cached LTRANS object for %s]\n",
+			     input_name);
+		  ltrans_cache_hits++;
+		  free (key);
+		  maybe_unlink (input_name);
+		  continue;
+		}
+	      ltrans_cache_keys[i] = key;
+	      ltrans_cache_misses++;
 	    }
 
-	  argv_ptr[1] = "-fltrans";
-	  argv_ptr[2] = "-o";
-	  argv_ptr[3] = output_name;
-	  argv_ptr[4] = input_name;
-	  argv_ptr[5] = NULL;
 	  if (parallel)
 	    {
+#ifdef HAVE_WORKING_FORK
+	      jobs[njobs].partition = i;
+	      jobs[njobs].size = ltrans_partition_size (i);
+	      njobs++;
+#else
+	      set_ltrans_argv (argv_ptr, linker_output, i);
 	      fprintf (mstream, "%s:\n\t@%s ", output_name, new_argv[0]);
 	      for (j = 1; new_argv[j] != NULL; ++j)
 		fprintf (mstream, " '%s'", new_argv[j]);
@@ -1388,18 +2028,30 @@ cont:
 		fprintf (mstream, "\t@-touch -r %s %s.tem > /dev/null 2>&1 "
 			 "&& mv %s.tem %s\n",
 			 input_name, input_name, input_name, input_name); 
+#endif
 	    }
 	  else
 	    {
+	      off_t size = report ? ltrans_partition_size (i) : 0;
+	      double start = wall_time ();
+
+	      set_ltrans_argv (argv_ptr, linker_output, i);
 	      fork_execute (new_argv[0], CONST_CAST (char **, new_argv),
 			    true);
+	      if (report)
+		report_ltrans_time (i, size, start);
+	      if (ltrans_cache_keys && ltrans_cache_keys[i])
+		ltrans_cache_store (ltrans_cache_keys[i], output_name);
 	      maybe_unlink (input_name);
 	    }
-
-	  output_names[i] = output_name;
 	}
       if (parallel)
 	{
+#ifdef HAVE_WORKING_FORK
+	  run_ltrans_jobs (jobs, njobs, jobserver ? 0 : parallel,
+			   new_argv, argv_ptr, linker_output, report);
+	  XDELETEVEC (jobs);
+#else
 	  struct pex_obj *pex;
 	  char jobs[32];
 
@@ -1434,7 +2086,23 @@ cont:
 	  maybe_unlink (makefile);
 	  makefile = NULL;
 	  for (i = 0; i < nr; ++i)
-	    maybe_unlink (input_names[i]);
+	    {
+	      if (ltrans_cache_keys && ltrans_cache_keys[i])
+		ltrans_cache_store (ltrans_cache_keys[i], output_names[i]);
+	      maybe_unlink (input_names[i]);
+	    }
+#endif
+	}
+      if (ltrans_cache_dir)
+	{
+	  ltrans_cache_trim ();
+	  if (report)
+	    fprintf (stderr, "[LTRANS cache %s: %u hits, %u misses]\n",
+		     ltrans_cache_dir, ltrans_cache_hits, ltrans_cache_misses);
+	  for (i = 0; i < nr; ++i)
+	    free (ltrans_cache_keys[i]);
+	  XDELETEVEC (ltrans_cache_keys);
+	  ltrans_cache_keys = NULL;
 	}
       for (i = 0; i < nr; ++i)
 	{
@@ -797,6 +797,384 @@ lto_balanced_map (int n_lto_partitions)
     }
 }
 
+/* Edge of the graph used by lto_locality_map.  */
+
+struct locality_edge
+{
+  int src, dest;
+  int weight;
+};
+
+/* Helper function for qsort; sort locality edges by decreasing weight.  */
+
+static int
+locality_edge_cmp (const void *pa, const void *pb)
+{
+  const struct locality_edge *a = (const struct locality_edge *) pa;
+  const struct locality_edge *b = (const struct locality_edge *) pb;
+
+  if (a->weight != b->weight)
+    return b->weight - a->weight;
+  if (a->src != b->src)
+    return a->src - b->src;
+  return a->dest - b->dest;
+}
+
+/* Return the representative of cluster of graph node I in union-find
+   forest PARENT, compressing the path on the way.  */
+
+static int
+locality_cluster (vec<int> &parent, int i)
+{
+  int root = i;
+
+  while (parent[root] != root)
+    root = parent[root];
+  while (parent[i] != root)
+    {
+      int next = parent[i];
+      parent[i] = root;
+      i = next;
+    }
+  return root;
+}
+
+/* Cluster of symbols built by lto_locality_map.  */
+
+struct locality_cluster_info
+{
+  int id;
+  int size;
+};
+
+/* Helper function for qsort; sort clusters by decreasing size.  */
+
+static int
+locality_cluster_cmp (const void *pa, const void *pb)
+{
+  const struct locality_cluster_info *a
+    = (const struct locality_cluster_info *) pa;
+  const struct locality_cluster_info *b
+    = (const struct locality_cluster_info *) pb;
+
+  if (a->size != b->size)
+    return b->size - a->size;
+  return a->id - b->id;
+}
+
+/* Map from symbols to their index in the graph of lto_locality_map.  */
+
+typedef hash_map<symtab_node *, int> locality_index_map;
+
+/* Return the graph node of lto_locality_map for NODE, or -1 if NODE is
+   not partitioned on its own.  INDEX maps the symbols to graph nodes.  */
+
+static int
+locality_node_index (locality_index_map &index, symtab_node *node)
+{
+  symtab_node *node1;
+  int *slot;
+
+  while ((node1 = contained_in_symbol (node)) != node)
+    node = node1;
+  slot = index.get (node);
+  return slot ? *slot : -1;
+}
+
+/* Record edges of graph node SRC to the symbols called by CNODE, looking
+   through its inline clones, into EDGES.  */
+
+static void
+locality_add_call_edges (locality_index_map &index,
+			 vec<locality_edge> &edges, int src,
+			 cgraph_node *cnode)
+{
+  struct cgraph_edge *e;
+
+  for (e = cnode->callees; e; e = e->next_callee)
+    if (!e->inline_failed)
+      locality_add_call_edges (index, edges, src, e->callee);
+    else if (e->callee->definition)
+      {
+	int dest = locality_node_index (index, e->callee);
+	if (dest >= 0 && dest != src)
+	  {
+	    locality_edge edge = { src, dest, MAX (e->frequency, 1) };
+	    edges.safe_push (edge);
+	  }
+      }
+}
+
+/* Group symbols into partitions so that the weight of the call graph and
+   IPA reference edges crossing partition boundaries is small, while the
+   partitions stay within 5/4 of the expected partition size, computed as
+   for lto_balanced_map.
+
+   Every symbol is first put in a cluster of its own.  Edges are visited
+   in the order of decreasing weight (call frequency) and the clusters of
+   their ends are merged as long as the result does not exceed the
+   expected partition size, as in heavy-edge matching.  The clusters are
+   then packed into partitions, largest first; each goes into the
+   partition it has the most edges into, or into the smallest partition
+   if it has none or no partition has room for it.
+
+   This is O(E log E) in the number of edges, somewhat slower than
+   lto_balanced_map, but it keeps callers with their hot callees and
+   variables with their users regardless of the symbol order, so fewer
+   symbols need to be promoted and streamed into the boundary of other
+   partitions.  */
+
+void
+lto_locality_map (int n_lto_partitions)
+{
+  locality_index_map index;
+  auto_vec<symtab_node *> nodes;
+  auto_vec<int> sizes;
+  auto_vec<locality_edge> edges;
+  auto_vec<int> parent;
+  symtab_node *snode;
+  cgraph_node *node;
+  int total_size = 0, partition_size, npartitions;
+  unsigned i, j;
+
+  /* The clustering does not preserve the order of symbols; leave
+     -fno-toplevel-reorder and no_reorder symbols to the balanced map.  */
+  if (!flag_toplevel_reorder)
+    {
+      lto_balanced_map (n_lto_partitions);
+      return;
+    }
+  FOR_EACH_SYMBOL (snode)
+    if (snode->no_reorder
+	&& snode->get_partitioning_class () == SYMBOL_PARTITION)
+      {
+	lto_balanced_map (n_lto_partitions);
+	return;
+      }
+
+  /* Collect the graph nodes: the symbols that are partitioned on their
+     own rather than as part of another symbol.  */
+  FOR_EACH_SYMBOL (snode)
+    if (snode->get_partitioning_class () == SYMBOL_PARTITION
+	&& contained_in_symbol (snode) == snode)
+      {
+	int size = 0;
+
+	if ((node = dyn_cast <cgraph_node *> (snode)) && !node->alias)
+	  size = inline_summaries->get (node)->size;
+	index.put (snode, nodes.length ());
+	nodes.safe_push (snode);
+	sizes.safe_push (size);
+	parent.safe_push (parent.length ());
+	total_size += size;
+      }
+
+  /* Collect the edges.  */
+  FOR_EACH_VEC_ELT (nodes, i, snode)
+    {
+      struct ipa_ref *ref;
+
+      if ((node = dyn_cast <cgraph_node *> (snode)))
+	locality_add_call_edges (index, edges, i, node);
+      for (j = 0; snode->iterate_reference (j, ref); j++)
+	if (ref->referred->definition)
+	  {
+	    int dest = locality_node_index (index, ref->referred);
+	    if (dest >= 0 && dest != (int) i)
+	      {
+		locality_edge edge = { (int) i, dest, 1 };
+		edges.safe_push (edge);
+	      }
+	  }
+    }
+  edges.qsort (locality_edge_cmp);
+
+  partition_size = total_size / n_lto_partitions;
+  if (partition_size < PARAM_VALUE (MIN_PARTITION_SIZE))
+    partition_size = PARAM_VALUE (MIN_PARTITION_SIZE);
+  npartitions = MAX (1, MIN (n_lto_partitions,
+			     (total_size + partition_size - 1)
+			     / partition_size));
+  if (symtab->dump_file)
+    fprintf (symtab->dump_file,
+	     "Locality map: %u symbols, %u edges, total unit size %i, "
+	     "partition size %i, %i partitions\n",
+	     nodes.length (), edges.length (), total_size, partition_size,
+	     npartitions);
+
+  /* Merge the clusters along the heaviest edges first.  */
+  locality_edge *edge;
+  FOR_EACH_VEC_ELT (edges, i, edge)
+    {
+      int a = locality_cluster (parent, edge->src);
+      int b = locality_cluster (parent, edge->dest);
+
+      if (a == b || sizes[a] + sizes[b] > partition_size)
+	continue;
+      if (b < a)
+	std::swap (a, b);
+      parent[b] = a;
+      sizes[a] += sizes[b];
+    }
+
+  /* Collect the clusters with the edges between them.  */
+  auto_vec<locality_cluster_info> clusters;
+  auto_vec<vec<locality_edge> > cluster_edges;
+  cluster_edges.safe_grow_cleared (nodes.length ());
+  for (i = 0; i < nodes.length (); i++)
+    if (locality_cluster (parent, i) == (int) i)
+      {
+	locality_cluster_info info = { (int) i, sizes[i] };
+	clusters.safe_push (info);
+      }
+  FOR_EACH_VEC_ELT (edges, i, edge)
+    {
+      int a = locality_cluster (parent, edge->src);
+      int b = locality_cluster (parent, edge->dest);
+
+      if (a != b)
+	{
+	  locality_edge e1 = { a, b, edge->weight };
+	  locality_edge e2 = { b, a, edge->weight };
+	  cluster_edges[a].safe_push (e1);
+	  cluster_edges[b].safe_push (e2);
+	}
+    }
+
+  clusters.qsort (locality_cluster_cmp);
+
+  /* Pack the clusters into partitions.  */
+  auto_vec<int> assignment;
+  auto_vec<int> partition_sizes;
+  auto_vec<HOST_WIDE_INT> connection;
+  int capacity = partition_size + partition_size / 4;
+  assignment.safe_grow (nodes.length ());
+  for (i = 0; i < nodes.length (); i++)
+    assignment[i] = -1;
+  partition_sizes.safe_grow_cleared (npartitions);
+  connection.safe_grow_cleared (npartitions);
+  locality_cluster_info *info;
+  FOR_EACH_VEC_ELT (clusters, i, info)
+    {
+      int cluster = info->id;
+      int best = -1, smallest = 0;
+      int p;
+
+      FOR_EACH_VEC_ELT (cluster_edges[cluster], j, edge)
+	{
+	  int dest_cluster = edge->dest;
+	  if (assignment[dest_cluster] >= 0)
+	    connection[assignment[dest_cluster]] += edge->weight;
+	}
+      for (p = 0; p < npartitions; p++)
+	{
+	  if (partition_sizes[p] < partition_sizes[smallest])
+	    smallest = p;
+	  if (connection[p]
+	      && partition_sizes[p] + sizes[cluster] <= capacity
+	      && (best < 0 || connection[p] > connection[best]))
+	    best = p;
+	}
+      if (best < 0)
+	best = smallest;
+      assignment[cluster] = best;
+      partition_sizes[best] += sizes[cluster];
+      for (p = 0; p < npartitions; p++)
+	connection[p] = 0;
+    }
+
+  /* Create the partitions and add the symbols to them.  */
+  auto_vec<ltrans_partition> partitions;
+  partitions.safe_grow_cleared (npartitions);
+  FOR_EACH_VEC_ELT (nodes, i, snode)
+    if (!symbol_partitioned_p (snode))
+      {
+	int p = assignment[locality_cluster (parent, i)];
+
+	if (!partitions[p])
+	  partitions[p] = new_partition ("");
+	add_symbol_to_partition (partitions[p], snode);
+      }
+  if (!ltrans_partitions.length ())
+    new_partition ("empty");
+
+  for (i = 0; i < nodes.length (); i++)
+    cluster_edges[i].release ();
+
+  if (symtab->dump_file)
+    {
+      fprintf (symtab->dump_file, "\nPartition sizes:\n");
+      for (i = 0; i < ltrans_partitions.length (); i++)
+	{
+	  ltrans_partition p = ltrans_partitions[i];
+	  fprintf (symtab->dump_file, "partition %d contains %d symbols and "
+		   "%d (%2.2f%%) insns\n", i, p->symbols, p->insns,
+		   total_size ? 100.0 * p->insns / total_size : 0.0);
+	}
+      fprintf (symtab->dump_file, "\n");
+    }
+}
+
+/* Compute the boundary of the partitions in LTRANS_PARTITIONS: the
+   call graph edges and IPA references from symbols in a partition to
+   symbols defined in another one, and the number of distinct symbols
+   each partition refers to in others.  These end up in the boundary of
+   the partition and cost streaming time and promotion of statics.
+   Record the totals in lto_stats and dump the per-partition numbers.  */
+
+void
+lto_partition_boundary_statistics (void)
+{
+  ltrans_partition part;
+  unsigned i;
+
+  FOR_EACH_VEC_ELT (ltrans_partitions, i, part)
+    {
+      hash_set<symtab_node *> boundary;
+      unsigned HOST_WIDE_INT cut_calls = 0, cut_frequency = 0, cut_refs = 0;
+      lto_symtab_encoder_iterator lsei;
+
+      for (lsei = lsei_start_in_partition (part->encoder); !lsei_end_p (lsei);
+	   lsei_next_in_partition (&lsei))
+	{
+	  symtab_node *node = lsei_node (lsei);
+	  struct ipa_ref *ref;
+	  int j;
+
+	  if (cgraph_node *cnode = dyn_cast <cgraph_node *> (node))
+	    for (cgraph_edge *e = cnode->callees; e; e = e->next_callee)
+	      if (e->inline_failed
+		  && e->callee->get_partitioning_class () == SYMBOL_PARTITION
+		  && !lto_symtab_encoder_in_partition_p (part->encoder,
+							 e->callee))
+		{
+		  cut_calls++;
+		  cut_frequency += MAX (e->frequency, 1);
+		  boundary.add (e->callee);
+		}
+	  for (j = 0; node->iterate_reference (j, ref); j++)
+	    if (ref->referred->get_partitioning_class () == SYMBOL_PARTITION
+		&& !lto_symtab_encoder_in_partition_p (part->encoder,
+						       ref->referred))
+	      {
+		cut_refs++;
+		boundary.add (ref->referred);
+	      }
+	}
+
+      lto_stats.num_cut_call_edges += cut_calls;
+      lto_stats.num_cut_references += cut_refs;
+      lto_stats.num_boundary_symbols += boundary.elements ();
+      if (symtab->dump_file)
+	fprintf (symtab->dump_file, "Boundary of partition %u: "
+		 HOST_WIDE_INT_PRINT_UNSIGNED " cut calls (frequency "
+		 HOST_WIDE_INT_PRINT_UNSIGNED "), "
+		 HOST_WIDE_INT_PRINT_UNSIGNED " cut references, "
+		 "%u boundary symbols\n", i, cut_calls, cut_frequency,
+		 cut_refs, (unsigned) boundary.elements ());
+    }
+}
+
 /* Return true if we must not change the name of the NODE.  The name as
    extracted from the corresponding decl should be passed in NAME.  */
 
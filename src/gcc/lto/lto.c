@@ -959,7 +959,15 @@ tree_scc_hasher::equal (const tree_scc *scc1, const tree_scc *scc2)
   return true;
 }
 
-static hash_table<tree_scc_hasher> *tree_scc_hash;
+/* The SCCs of all the object files are unified in this table, which is
+   the largest one of a WPA link; it uses the control-byte storage, which
+   probes the hashes of a group of entries at once.  */
+typedef hash_table<tree_scc_hasher, xcallocator, HASH_TABLE_CONTROL_BYTES>
+  tree_scc_hash_type;
+static tree_scc_hash_type *tree_scc_hash;
+/* With -fscc-hash-trace=, the file the lookups in TREE_SCC_HASH are
+   written to.  */
+static FILE *tree_scc_hash_trace;
 static struct obstack tree_scc_hash_obstack;
 
 static unsigned long num_merged_types;
@@ -1565,6 +1573,9 @@ unify_scc (struct data_in *data_in, unsigned from,
 
   /* Look for the list of candidate SCCs to compare against.  */
   tree_scc **slot;
+  if (tree_scc_hash_trace)
+    fprintf (tree_scc_hash_trace, "%08x %u %u\n",
+	     scc_hash, len, scc_entry_len);
   slot = tree_scc_hash->find_slot_with_hash (scc, scc_hash, INSERT);
   if (*slot)
     {
@@ -2766,7 +2777,14 @@ read_cgraph_and_symbols (unsigned nfiles, const char **fnames)
   gimple_canonical_types = htab_create (16381, gimple_canonical_type_hash,
 					gimple_canonical_type_eq, NULL);
   gcc_obstack_init (&tree_scc_hash_obstack);
-  tree_scc_hash = new hash_table<tree_scc_hasher> (4096);
+  tree_scc_hash = new tree_scc_hash_type (4096);
+  if (lto_scc_hash_trace && !flag_ltrans)
+    {
+      tree_scc_hash_trace = fopen (lto_scc_hash_trace, "w");
+      if (!tree_scc_hash_trace)
+	fatal_error (input_location, "cannot open %s: %m",
+		     lto_scc_hash_trace);
+    }
 
   /* Register the common node types with the canonical type machinery so
      we properly share alias-sets across languages and TUs.  Do not
@@ -2834,6 +2852,11 @@ read_cgraph_and_symbols (unsigned nfiles, const char **fnames)
   /* Free gimple type merging datastructures.  */
   delete tree_scc_hash;
   tree_scc_hash = NULL;
+  if (tree_scc_hash_trace)
+    {
+      fclose (tree_scc_hash_trace);
+      tree_scc_hash_trace = NULL;
+    }
   obstack_free (&tree_scc_hash_obstack, NULL);
   htab_delete (gimple_canonical_types);
   gimple_canonical_types = NULL;
@@ -3014,7 +3037,7 @@ print_lto_report_1 (void)
 	       (long) tree_scc_hash->size (),
 	       (long) tree_scc_hash->elements (),
 	       tree_scc_hash->collisions ());
-      hash_table<tree_scc_hasher>::iterator hiter;
+      tree_scc_hash_type::iterator hiter;
       tree_scc *scc, *max_scc = NULL;
       unsigned max_length = 0;
       FOR_EACH_HASH_TABLE_ELEMENT (*tree_scc_hash, scc, x, hiter)
@@ -3126,9 +3149,14 @@ do_whole_program_analysis (void)
     lto_balanced_map (1);
   else if (flag_lto_partition == LTO_PARTITION_BALANCED)
     lto_balanced_map (PARAM_VALUE (PARAM_LTO_PARTITIONS));
+  else if (flag_lto_partition == LTO_PARTITION_LOCALITY)
+    lto_locality_map (PARAM_VALUE (PARAM_LTO_PARTITIONS));
   else
     gcc_unreachable ();
 
+  if (symtab->dump_file || flag_lto_report || flag_lto_report_wpa)
+    lto_partition_boundary_statistics ();
+
   /* Inline summaries are needed for balanced partitioning.  Free them now so
      the memory can be used for streamer caches.  */
   inline_free_summary ();
@@ -30,6 +30,35 @@ class hash_map;
 #define LOCATION_LINE_EXTRA_SPACE 30
 #define LOCATION_LINE_WIDTH	  48
 
+/* Print S to F as a JSON string.  */
+
+static inline void
+print_json_string (FILE *f, const char *s)
+{
+  fputc ('"', f);
+  for (; *s; s++)
+    switch (*s)
+      {
+      case '"':
+      case '\\':
+	fputc ('\\', f);
+	fputc (*s, f);
+	break;
+      case '\n':
+	fputs ("\\n", f);
+	break;
+      case '\t':
+	fputs ("\\t", f);
+	break;
+      default:
+	if ((unsigned char) *s < ' ')
+	  fprintf (f, "\\u%04x", (unsigned char) *s);
+	else
+	  fputc (*s, f);
+      }
+  fputc ('"', f);
+}
+
 /* Memory allocation location.  */
 struct mem_location
 {
@@ -103,6 +132,16 @@ struct mem_location
     return s;
   }
 
+  /* Print the location to F as members of a JSON object.  */
+  inline void
+  dump_json (FILE *f)
+  {
+    fputs ("\"file\": ", f);
+    print_json_string (f, get_trimmed_filename ());
+    fprintf (f, ", \"line\": %i, \"function\": ", m_line);
+    print_json_string (f, m_function);
+  }
+
   /* Return display name associated to ORIGIN type.  */
   static const char *
   get_origin_name (mem_alloc_origin origin)
@@ -200,6 +239,18 @@ struct mem_usage
     free (location_string);
   }
 
+  /* Dump usage coupled to LOC location to F as a JSON object.  */
+  inline void
+  dump_json (FILE *f, mem_location *loc) const
+  {
+    fputs ("{", f);
+    loc->dump_json (f);
+    fprintf (f, ", \"leak\": %" PRIu64 ", \"peak\": %" PRIu64
+	     ", \"times\": %" PRIu64 ", \"ggc\": %s}",
+	     (uint64_t)m_allocated, (uint64_t)m_peak, (uint64_t)m_times,
+	     loc->m_ggc ? "true" : "false");
+  }
+
   /* Dump footer.  */
   inline void
   dump_footer () const
@@ -357,6 +408,9 @@ public:
   void dump (mem_alloc_origin origin,
 	     int (*cmp) (const void *first, const void *second) = NULL);
 
+  /* Dump all tracked instances of type ORIGIN to F as a JSON array.  */
+  void dump_json (FILE *f, mem_alloc_origin origin);
+
   /* Reverse object map used for every object allocation mapping.  */
   reverse_object_map_t *m_reverse_object_map;
 
@@ -633,4 +687,26 @@ mem_alloc_description<T>::dump (mem_alloc_origin origin,
   fprintf (stderr, "\n");
 }
 
+/* Dump all tracked instances of type ORIGIN to F as a JSON array, in
+   the order of dump.  */
+
+template <class T>
+inline void
+mem_alloc_description<T>::dump_json (FILE *f, mem_alloc_origin origin)
+{
+  unsigned length;
+
+  mem_list_t *list = get_list (origin, &length);
+
+  fputs ("[", f);
+  for (int i = length - 1; i >= 0; i--)
+    {
+      fputs (i == (int) length - 1 ? "\n    " : ",\n    ", f);
+      list[i].second->dump_json (f, list[i].first);
+    }
+  fputs ("]", f);
+
+  XDELETEVEC (list);
+}
+
 #endif // GCC_MEM_STATS_H
@@ -191,6 +191,11 @@ extern void assemble_start_function (tree, const char *);
    function.  DECL describes the function.  NAME is the function's name.  */
 extern void assemble_end_function (tree, const char *);
 
+/* Record the effects of assemble_start_function on the rest of the
+   output file for a function whose assembly was written by other
+   means.  */
+extern void note_function_assembled (tree);
+
 /* Assemble everything that is needed for a variable or function declaration.
    Not used for automatic variables, and not used for function definitions.
    Should not be called for variables of incomplete structure type.
@@ -526,9 +531,12 @@ extern section *get_unnamed_section (unsigned int, void (*) (const void *),
 extern section *get_section (const char *, unsigned int, tree);
 extern section *get_named_section (tree, const char *, int);
 extern section *get_variable_section (tree, bool);
+extern int object_block_changes;
 extern void place_block_symbol (rtx);
 extern rtx get_section_anchor (struct object_block *, HOST_WIDE_INT,
 			       enum tls_model);
+extern void place_variables_in_object_blocks (vec<rtx> *);
+extern void forget_output_constants (void);
 extern section *mergeable_constant_section (machine_mode,
 					    unsigned HOST_WIDE_INT,
 					    unsigned int);
@@ -542,6 +550,8 @@ extern section *get_cdtor_priority_section (int, bool);
 
 extern bool unlikely_text_section_p (section *);
 extern void switch_to_section (section *);
+extern void begin_standalone_sections (void);
+extern void end_standalone_sections (void);
 extern void output_section_asm_op (const void *);
 
 extern void record_tm_clone_pair (tree, tree);
@@ -58,6 +58,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "cfgrtl.h"
 #include "tree-ssa-live.h"  /* For remove_unused_locals.  */
 #include "tree-cfgcleanup.h"
+#include "compile-cache.h"
 
 using namespace gcc;
 
@@ -639,11 +640,13 @@ public:
   {}
 
   /* opt_pass methods: */
-  virtual bool gate (function *)
+  virtual bool gate (function *fun)
     {
       /* Early return if there were errors.  We can run afoul of our
 	 consistency checks, and there's not really much point in fixing them.  */
-      return !(rtl_dump_and_exit || flag_syntax_only || seen_error ());
+      return !(rtl_dump_and_exit || flag_syntax_only || seen_error ()
+	       || compile_cache_hit_p ()
+	       || compile_cache_deferred_p (fun->decl));
     }
 
 }; // class pass_rest_of_compilation
@@ -2332,9 +2335,19 @@ execute_one_pass (opt_pass *pass)
   if (pass->tv_id != TV_NONE)
     timevar_push (pass->tv_id);
 
+  /* Time the run on this function for -ftime-report-functions.  */
+  bool time_function = g_timer && time_report_functions && cfun;
+  timevar_time_def start_time;
+  if (time_function)
+    timer::get_precise_time (&start_time);
+
   /* Do it!  */
   todo_after = pass->execute (cfun);
 
+  if (time_function)
+    g_timer->note_function_pass (pass->name, function_name (cfun),
+				 &start_time);
+
   if (todo_after & TODO_discard_function)
     {
       pass_fini_dump_file (pass);
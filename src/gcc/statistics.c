@@ -252,6 +252,16 @@ statistics_fini (void)
   dump_end (statistics_dump_nr, statistics_dump_file);
 }
 
+/* Stop dumping statistics without writing out what was collected, in
+   a forked process that must not write to the dump file of its
+   parent.  */
+
+void
+statistics_disable (void)
+{
+  statistics_dump_file = NULL;
+}
+
 /* Register the statistics dump file.  */
 
 void
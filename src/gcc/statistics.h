@@ -64,6 +64,7 @@ struct function;
 extern void statistics_early_init (void);
 extern void statistics_init (void);
 extern void statistics_fini (void);
+extern void statistics_disable (void);
 extern void statistics_fini_pass (void);
 extern void statistics_counter_event (struct function *, const char *, int);
 extern void statistics_histogram_event (struct function *, const char *, int);
@@ -0,0 +1,59 @@
+/* Test -fcompile-cache: the functions are compiled as usual and their
+   assembly is stored for compile-cache-2.c.  */
+/* { dg-do run } */
+/* { dg-options "-O2 -fno-asynchronous-unwind-tables -fno-section-anchors -fcompile-cache=compile-cache.dir -fdump-tree-compcache" } */
+
+extern void abort (void);
+
+struct point { int x, y; };
+
+static const int table[] = { 3, 1, 4, 1, 5, 9, 2, 6 };
+int counter;
+
+__attribute__ ((noinline)) int
+sum (const struct point *p, int n)
+{
+  int s = 0, i;
+
+  for (i = 0; i < n; i++)
+    s += p[i].x * p[i].y;
+  return s;
+}
+
+__attribute__ ((noinline)) int
+classify (int v)
+{
+  switch (v)
+    {
+    case 0: return 10;
+    case 1: return 20;
+    case 2: return 35;
+    case 5: return 7;
+    case 7: return 12;
+    default: return table[v & 7];
+    }
+}
+
+__attribute__ ((noinline)) void
+bump (int n)
+{
+  while (n-- > 0)
+    counter += classify (n);
+}
+
+int
+main (void)
+{
+  struct point pts[3] = { { 1, 2 }, { 3, 4 }, { 5, 6 } };
+
+  if (sum (pts, 3) != 44)
+    abort ();
+  if (classify (2) != 35 || classify (12) != 5)
+    abort ();
+  bump (4);
+  if (counter != 66)
+    abort ();
+  return 0;
+}
+
+/* { dg-final { scan-tree-dump-times "Compile cache key" 4 "compcache" } } */
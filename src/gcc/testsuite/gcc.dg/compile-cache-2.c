@@ -0,0 +1,10 @@
+/* Test that the assembly stored by compile-cache-1.c is reused.  */
+/* { dg-do run } */
+/* { dg-options "-O2 -fno-asynchronous-unwind-tables -fno-section-anchors -fcompile-cache=compile-cache.dir -fdump-tree-compcache" } */
+
+#include "compile-cache-1.c"
+
+/* { dg-final { scan-tree-dump-times "Replayed from the compile cache" 4 "compcache" } } */
+/* { dg-final { remove-build-file "compile-cache.dir/??/?*" } } */
+/* { dg-final { remove-build-file "compile-cache.dir/??" } } */
+/* { dg-final { remove-build-file "compile-cache.dir" } } */
@@ -0,0 +1,22 @@
+/* Test header lookup with -finclude-cache: headers are still found,
+   including with #include_next, and missing ones are not.  */
+/* { dg-do compile } */
+/* { dg-options "-finclude-cache=include-cache-1.cache -I$srcdir/gcc.dg/cpp -I$srcdir/gcc.dg/cpp/inc" } */
+
+#include <pr20356-aux.h>
+
+#ifndef PR20356_H
+# error PR20356_H not defined
+#endif
+#ifndef INC_PR20356_H
+# error INC_PR20356_H not defined
+#endif
+
+#if !__has_include (<pr20348.h>)
+# error pr20348.h not found
+#endif
+#if __has_include (<include-cache-1-missing.h>)
+# error include-cache-1-missing.h found
+#endif
+
+int i;
@@ -0,0 +1,18 @@
+/* Test that the cache written by include-cache-1.c is used correctly
+   by a second compilation.  */
+/* { dg-do compile } */
+/* { dg-options "-finclude-cache=include-cache-1.cache -I$srcdir/gcc.dg/cpp -I$srcdir/gcc.dg/cpp/inc" } */
+
+#include <pr20356-aux.h>
+#include "inc/foo.h"
+
+#ifndef PR20356_H
+# error PR20356_H not defined
+#endif
+#if __has_include (<include-cache-1-missing.h>)
+# error include-cache-1-missing.h found
+#endif
+
+int i;
+
+/* { dg-final { remove-build-file "include-cache-1.cache" } } */
@@ -0,0 +1,28 @@
+/* { dg-do compile { target elf } } */
+/* { dg-options "-O2 -gdwarf -fstream-dwarf2 -dA" } */
+
+/* The DIEs of each function are output after its code, into the second
+   subsection of .debug_info, and refer to the types of the main
+   compilation unit by DW_FORM_ref_addr.  */
+
+struct point { int x, y; };
+
+int
+norm1 (struct point *p)
+{
+  int x = p->x < 0 ? -p->x : p->x;
+  int y = p->y < 0 ? -p->y : p->y;
+  return x + y;
+}
+
+int
+sum (struct point *p, int n)
+{
+  int i, s = 0;
+  for (i = 0; i < n; i++)
+    s += norm1 (&p[i]);
+  return s;
+}
+
+/* { dg-final { scan-assembler "\\.subsection\[ \t\]+1" } } */
+/* { dg-final { scan-assembler "DW_FORM_ref_addr" } } */
@@ -0,0 +1,41 @@
+/* Test that liveness and register allocation give the same code with
+   dense bitmaps, on a function with many registers live across many
+   blocks.  */
+/* { dg-do run } */
+/* { dg-options "-O2 --param hybrid-bitmaps=1" } */
+
+extern void abort (void);
+
+#define V4(M, N) M (N##0) M (N##1) M (N##2) M (N##3)
+#define V16(M, N) V4 (M, N##0) V4 (M, N##1) V4 (M, N##2) V4 (M, N##3)
+#define V64(M) V16 (M, 0) V16 (M, 1) V16 (M, 2) V16 (M, 3)
+
+#define DECL(N) int v##N = p[0x##N % 61] + 0x##N;
+#define STEP(N) if (v##N & 1) v##N = v##N * 3 + i; else v##N >>= 1;
+#define SUM(N) s += v##N;
+
+__attribute__ ((noinline, noclone)) int
+f (const int *p, int n)
+{
+  int i, s = 0;
+  V64 (DECL)
+
+  for (i = 0; i < n; i++)
+    {
+      V64 (STEP)
+    }
+  V64 (SUM)
+  return s;
+}
+
+int
+main (void)
+{
+  int p[61], i;
+
+  for (i = 0; i < 61; i++)
+    p[i] = i * 7;
+  if (f (p, 0) != 39291 || f (p, 20) != 1072871)
+    abort ();
+  return 0;
+}
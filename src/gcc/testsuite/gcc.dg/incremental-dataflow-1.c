@@ -0,0 +1,54 @@
+/* Test that the register liveness problems re-solved from the blocks
+   RTL passes changed agree with a full recompute, on a function whose
+   CFG the if-conversion, jump threading and loop passes rewrite.  */
+/* { dg-do run } */
+/* { dg-options "-O2 -funroll-loops -fincremental-dataflow -fincremental-dataflow-check" } */
+
+extern void abort (void);
+
+__attribute__ ((noinline, noclone)) unsigned int
+f (const int *p, int n, int k)
+{
+  unsigned int s = 0, t = 1;
+  int i, j;
+
+  for (i = 0; i < n; i++)
+    {
+      int x = p[i];
+
+      if (x > k)
+	x -= k;
+      else if (x < -k)
+	x += k;
+      switch (x & 7)
+	{
+	case 0: s += x; break;
+	case 1: s -= t; break;
+	case 2: t ^= x; break;
+	case 5: s *= 3; break;
+	default: t += s & 15; break;
+	}
+      for (j = 0; j < (x & 3); j++)
+	{
+	  if (t & 1)
+	    s += j;
+	  t = t * 5 + 1;
+	}
+      if (s > 100000)
+	s >>= 3;
+    }
+  return s + t;
+}
+
+int
+main (void)
+{
+  int p[50], i;
+
+  for (i = 0; i < 50; i++)
+    p[i] = (i * 37) % 23 - 11;
+  if (f (p, 0, 3) != 1 || f (p, 50, 4) != 218945597
+      || f (p, 37, 9) != 1164553446)
+    abort ();
+  return 0;
+}
@@ -0,0 +1,29 @@
+/* { dg-lto-do run } */
+/* { dg-lto-options {{-O2 -flto -flto-partition=locality} {-O1 -flto -flto-partition=locality --param lto-partitions=3 --param lto-min-partition=1 -fno-inline}} } */
+
+extern int walk_a (int);
+extern int walk_b (int);
+extern void abort (void);
+
+int counter;
+
+static int __attribute__ ((noinline))
+step (int x)
+{
+  counter++;
+  return x + 1;
+}
+
+int
+walk_main (int x)
+{
+  return step (walk_a (x)) + step (walk_b (x));
+}
+
+int
+main (void)
+{
+  if (walk_main (1) != 10 || counter != 4)
+    abort ();
+  return 0;
+}
@@ -0,0 +1,20 @@
+extern int counter;
+
+static int __attribute__ ((noinline))
+twice (int x)
+{
+  counter++;
+  return 2 * x;
+}
+
+int
+walk_a (int x)
+{
+  return twice (x) + 1;
+}
+
+int
+walk_b (int x)
+{
+  return twice (x + 1) + 1;
+}
@@ -0,0 +1,17 @@
+/* { dg-lto-do run } */
+/* Objects compressed with different algorithms are linked together.  */
+/* { dg-lto-options {{-O2 -flto -flto-compression-algorithm=lz} {-O2 -flto -flto-compression-algorithm=lz -flto-compression-level=0}} } */
+
+extern int scale (int, int);
+extern void abort (void);
+
+int
+main (void)
+{
+  int i;
+
+  for (i = 0; i < 8; i++)
+    if (scale (i, 3) != i * 3 + (i & 1))
+      abort ();
+  return 0;
+}
@@ -0,0 +1,17 @@
+/* { dg-options "-flto-compression-algorithm=zlib" } */
+
+int
+scale (int x, int k)
+{
+  switch (x)
+    {
+    case 0: return 0 * k + 0;
+    case 1: return 1 * k + 1;
+    case 2: return 2 * k + 0;
+    case 3: return 3 * k + 1;
+    case 4: return 4 * k + 0;
+    case 5: return 5 * k + 1;
+    case 6: return 6 * k + 0;
+    default: return x * k + (x & 1);
+    }
+}
@@ -0,0 +1,16 @@
+/* { dg-lto-do run } */
+/* The second link reuses the LTRANS objects cached by the first.  */
+/* { dg-lto-options {{-O2 -flto -flto-partition=1to1 -flto-incremental=ltrans-cache} {-O2 -flto -flto-partition=1to1 -flto-incremental=ltrans-cache}} } */
+
+extern int checksum (const unsigned char *, int);
+extern void abort (void);
+
+static const unsigned char data[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+int
+main (void)
+{
+  if (checksum (data, sizeof (data)) != 36)
+    abort ();
+  return 0;
+}
@@ -0,0 +1,8 @@
+int
+checksum (const unsigned char *p, int n)
+{
+  int i, s = 0;
+  for (i = 0; i < n; i++)
+    s += p[i];
+  return s;
+}
@@ -0,0 +1,16 @@
+/* { dg-lto-do run } */
+/* { dg-lto-options {{-O2 -flto=auto -flto-partition=1to1} {-O2 -flto=2 -flto-partition=max -flto-report}} } */
+
+extern int sum_squares (int);
+extern int sum_cubes (int);
+extern void abort (void);
+
+int
+main (void)
+{
+  if (sum_squares (10) != 385)
+    abort ();
+  if (sum_cubes (10) != 3025)
+    abort ();
+  return 0;
+}
@@ -0,0 +1,17 @@
+int
+sum_squares (int n)
+{
+  int i, s = 0;
+  for (i = 1; i <= n; i++)
+    s += i * i;
+  return s;
+}
+
+int
+sum_cubes (int n)
+{
+  int i, s = 0;
+  for (i = 1; i <= n; i++)
+    s += i * i * i;
+  return s;
+}
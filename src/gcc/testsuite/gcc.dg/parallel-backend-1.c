@@ -0,0 +1,81 @@
+/* Test -fparallel-backend: the functions of the second partition are
+   compiled by a forked worker and its assembly is replayed.  */
+/* { dg-do run } */
+/* { dg-options "-O2 -fno-asynchronous-unwind-tables -fparallel-backend=2 --param parallel-backend-min-partition=1 -fdump-tree-compcache" } */
+
+extern void abort (void);
+extern int strcmp (const char *, const char *);
+
+struct point { int x, y; };
+
+static const int table[] = { 3, 1, 4, 1, 5, 9, 2, 6 };
+static int history[16];
+int counter;
+
+__attribute__ ((noinline)) int
+sum (const struct point *p, int n)
+{
+  int s = 0, i;
+
+  for (i = 0; i < n; i++)
+    s += p[i].x * p[i].y;
+  return s;
+}
+
+__attribute__ ((noinline)) int
+classify (int v)
+{
+  switch (v)
+    {
+    case 0: return 10;
+    case 1: return 20;
+    case 2: return 35;
+    case 5: return 7;
+    case 7: return 12;
+    default: return table[v & 7];
+    }
+}
+
+__attribute__ ((noinline)) void
+bump (int n)
+{
+  while (n-- > 0)
+    {
+      history[n & 15] = classify (n);
+      counter += history[n & 15];
+    }
+}
+
+__attribute__ ((noinline)) const char *
+name (int v)
+{
+  return v > 10 ? "large" : v > 5 ? "medium" : "small";
+}
+
+__attribute__ ((noinline)) int
+check_names (void)
+{
+  return (strcmp (name (12), "large") == 0
+	  && strcmp (name (6), "medium") == 0
+	  && strcmp (name (1), "small") == 0);
+}
+
+int
+main (void)
+{
+  struct point pts[3] = { { 1, 2 }, { 3, 4 }, { 5, 6 } };
+
+  if (sum (pts, 3) != 44)
+    abort ();
+  if (classify (2) != 35 || classify (12) != 5)
+    abort ();
+  bump (4);
+  if (counter != 66 || history[3] != 1)
+    abort ();
+  if (!check_names ())
+    abort ();
+  return 0;
+}
+
+/* { dg-final { scan-tree-dump "RTL passes deferred for the parallel back end" "compcache" } } */
+/* { dg-final { scan-tree-dump "Replayed from a parallel back end worker" "compcache" } } */
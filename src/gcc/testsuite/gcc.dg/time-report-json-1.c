@@ -0,0 +1,18 @@
+/* Test -ftime-report-json= and -ftime-report-functions=.  */
+/* { dg-do compile } */
+/* { dg-options "-O2 -ftime-report-json=time-report-json-1.json -ftime-report-functions=3" } */
+
+int
+f (int *p, int n)
+{
+  int i, s = 0;
+
+  for (i = 0; i < n; i++)
+    s += p[i];
+  return s;
+}
+
+/* { dg-final { scan-file time-report-json-1.json "\"timevars\": \\\[" } }
+   { dg-final { scan-file time-report-json-1.json "\"pass\": \"\[^\"\]*\", \"function\": \"f\"" } }
+   { dg-final { scan-file time-report-json-1.json "\"ggc_peak\": \[0-9\]+" } }
+   { dg-final { remote_file build delete time-report-json-1.json } } */
@@ -0,0 +1,32 @@
+/* { dg-do compile } */
+/* { dg-options "-O2 --param pta-wave-solver=1 -fdump-tree-alias" } */
+
+/* A table of function pointers reached through a chain of pointers:
+   the wave solver reports its statistics and finds the callees.  */
+
+extern void h0 (void);
+extern void h1 (void);
+extern void h2 (void);
+
+typedef void (*handler) (void);
+
+void
+dispatch (int n, int k)
+{
+  handler table[3];
+  handler *p, *q, *r;
+
+  table[0] = h0;
+  table[1] = h1;
+  table[2] = h2;
+  p = table;
+  q = p + n;
+  r = q;
+  if (k)
+    r = p;
+  (*r) ();
+}
+
+/* { dg-final { scan-tree-dump "Wave solver: \[0-9\]+ iterations, \[0-9\]+ of \[0-9\]+ propagated sets shared" "alias" } } */
+/* { dg-final { scan-tree-dump "r_\[0-9\]+ = { table }" "alias" } } */
+/* { dg-final { scan-tree-dump "_\[0-9\]+ = { h0 h1 h2 }" "alias" } } */
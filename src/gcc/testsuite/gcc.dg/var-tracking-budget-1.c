@@ -0,0 +1,49 @@
+/* { dg-do compile } */
+/* { dg-options "-O2 -g -fdump-rtl-vartrack --param max-vartrack-size=100" } */
+
+/* Exceeding the size limit of variable tracking drops the variables
+   that take the most space, rather than the whole function.  The
+   variables of the inlined copies of step are only tracked where their
+   scope may still be reached.  */
+
+extern int in (int);
+extern void out (int, int);
+
+static inline int
+step (int a, int b)
+{
+  int t = a * 3 + b;
+  int u = t ^ (a >> 2);
+  return u + in (t);
+}
+
+int
+machine (int state)
+{
+  int x = in (0), y = in (1), z = in (2);
+
+  for (;;)
+    switch (state)
+      {
+      case 0:
+	x = step (x, y);
+	state = in (x) ? 1 : 2;
+	break;
+      case 1:
+	y = step (y, z);
+	state = in (y) ? 2 : 0;
+	break;
+      case 2:
+	z = step (z, x);
+	if (in (z))
+	  return x + y + z;
+	state = 0;
+	break;
+      default:
+	out (x, y);
+	return z;
+      }
+}
+
+/* { dg-final { scan-rtl-dump "variables of nested scopes, live at" "vartrack" } } */
+/* { dg-final { scan-rtl-dump "Not tracking \[a-z\]+ \\(\[0-9\]+ entries\\)" "vartrack" } } */
@@ -23,6 +23,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "coretypes.h"
 #include "timevar.h"
 #include "options.h"
+#include "mem-stats.h"
 
 #ifndef HAVE_CLOCK_T
 typedef int clock_t;
@@ -259,7 +260,9 @@ timer::timer () :
   m_stack (NULL),
   m_unused_stack_instances (NULL),
   m_start_time (),
-  m_jit_client_items (NULL)
+  m_jit_client_items (NULL),
+  m_slowest_function_passes (NULL),
+  m_n_slowest_function_passes (0)
 {
   /* Zero all elapsed times.  */
   memset (m_timevars, 0, sizeof (m_timevars));
@@ -298,6 +301,10 @@ timer::~timer ()
     }
 
   delete m_jit_client_items;
+
+  for (unsigned i = 0; i < m_n_slowest_function_passes; i++)
+    free (m_slowest_function_passes[i].function_name);
+  XDELETEVEC (m_slowest_function_passes);
 }
 
 /* Initialize timing variables.  */
@@ -563,6 +570,82 @@ timer::pop_client_item ()
   m_jit_client_items->pop ();
 }
 
+/* Fill the current times into NOW, like get_time but with the best
+   resolution the host offers, for timing short intervals.  */
+
+void
+timer::get_precise_time (timevar_time_def *now)
+{
+  get_time (now);
+
+#ifdef HAVE_GETRUSAGE
+  struct rusage rusage;
+  getrusage (RUSAGE_SELF, &rusage);
+  now->user = rusage.ru_utime.tv_sec + rusage.ru_utime.tv_usec * 1e-6;
+  now->sys  = rusage.ru_stime.tv_sec + rusage.ru_stime.tv_usec * 1e-6;
+#endif
+#ifdef HAVE_GETTIMEOFDAY
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  now->wall = tv.tv_sec + tv.tv_usec * 1e-6;
+#endif
+}
+
+/* Return the time spent by the pass run RUN.  */
+
+static inline double
+function_pass_time (const timevar_time_def *elapsed)
+{
+  return elapsed->user + elapsed->sys;
+}
+
+/* Note that pass PASS_NAME ran on function FUNCTION_NAME from
+   START_TIME, as given by get_precise_time, until now.  Keep it if it
+   is one of the -ftime-report-functions slowest such runs.  */
+
+void
+timer::note_function_pass (const char *pass_name, const char *function_name,
+			   const timevar_time_def *start_time)
+{
+  unsigned max = time_report_functions;
+  timevar_time_def now, elapsed;
+  unsigned i;
+
+  if (max == 0)
+    return;
+
+  get_precise_time (&now);
+  memset (&elapsed, 0, sizeof (elapsed));
+  timevar_accumulate (&elapsed, const_cast <timevar_time_def *> (start_time),
+		      &now);
+
+  if (m_slowest_function_passes == NULL)
+    m_slowest_function_passes = XNEWVEC (function_pass_def, max);
+
+  i = m_n_slowest_function_passes;
+  if (i == max)
+    {
+      if (function_pass_time (&elapsed)
+	  <= function_pass_time (&m_slowest_function_passes[i - 1].elapsed))
+	return;
+      free (m_slowest_function_passes[--i].function_name);
+    }
+  else
+    m_n_slowest_function_passes++;
+
+  /* Insertion sort, the array is short.  */
+  for (; i > 0; i--)
+    {
+      if (function_pass_time (&m_slowest_function_passes[i - 1].elapsed)
+	  >= function_pass_time (&elapsed))
+	break;
+      m_slowest_function_passes[i] = m_slowest_function_passes[i - 1];
+    }
+  m_slowest_function_passes[i].pass_name = pass_name;
+  m_slowest_function_passes[i].function_name = xstrdup (function_name);
+  m_slowest_function_passes[i].elapsed = elapsed;
+}
+
 /* Validate that phase times are consistent.  */
 
 void
@@ -743,6 +826,75 @@ timer::print (FILE *fp)
   validate_phases (fp);
 }
 
+/* Helper function for timer::print_json.  Print the members of a JSON
+   object for ELAPSED.  */
+
+void
+timer::print_json_times (FILE *fp, const timevar_time_def *elapsed)
+{
+  fprintf (fp, "\"user\": %.6f, \"sys\": %.6f, \"wall\": %.6f, "
+	   "\"ggc_mem\": %lu",
+	   elapsed->user, elapsed->sys, elapsed->wall,
+	   (unsigned long) elapsed->ggc_mem);
+}
+
+/* Summarize timing variables to FP as a JSON object: the times and
+   GGC memory allocated for every timing variable that was used, the
+   total, and the slowest runs of a pass on a single function noted by
+   note_function_pass.  Unlike print, rows of zeroes are kept, so that
+   reports for different compilations have the same fields.  */
+
+void
+timer::print_json (FILE *fp)
+{
+  unsigned int /* timevar_id_t */ id;
+  const timevar_time_def *total = &m_timevars[TV_TOTAL].elapsed;
+  struct timevar_time_def now;
+  bool first = true;
+  unsigned i;
+
+  /* Update timing information for the running timing variable, as
+     print does.  */
+  get_time (&now);
+  if (m_stack)
+    timevar_accumulate (&m_stack->timevar->elapsed, &m_start_time, &now);
+  m_start_time = now;
+
+  fputs ("{\n    \"timevars\": [", fp);
+  for (id = 0; id < (unsigned int) TIMEVAR_LAST; ++id)
+    {
+      const timevar_def *tv = &m_timevars[(timevar_id_t) id];
+
+      if ((timevar_id_t) id == TV_TOTAL || !tv->used)
+	continue;
+
+      fputs (first ? "\n      {\"name\": " : ",\n      {\"name\": ", fp);
+      print_json_string (fp, tv->name);
+      fputs (", ", fp);
+      print_json_times (fp, &tv->elapsed);
+      fputs ("}", fp);
+      first = false;
+    }
+
+  fputs ("],\n    \"total\": {", fp);
+  print_json_times (fp, total);
+
+  fputs ("},\n    \"slowest_function_passes\": [", fp);
+  for (i = 0; i < m_n_slowest_function_passes; i++)
+    {
+      const function_pass_def *run = &m_slowest_function_passes[i];
+
+      fputs (i == 0 ? "\n      {\"pass\": " : ",\n      {\"pass\": ", fp);
+      print_json_string (fp, run->pass_name);
+      fputs (", \"function\": ", fp);
+      print_json_string (fp, run->function_name);
+      fputs (", ", fp);
+      print_json_times (fp, &run->elapsed);
+      fputs ("}", fp);
+    }
+  fputs ("]\n  }", fp);
+}
+
 /* Get the name of the topmost item.  For use by jit for validating
    inputs to gcc_jit_timer_pop.  */
 const char *
@@ -119,6 +119,11 @@ class timer
   void pop_client_item ();
 
   void print (FILE *fp);
+  void print_json (FILE *fp);
+
+  static void get_precise_time (timevar_time_def *now);
+  void note_function_pass (const char *pass_name, const char *function_name,
+			   const timevar_time_def *start_time);
 
   const char *get_topmost_item_name () const;
 
@@ -132,6 +137,7 @@ class timer
   static void print_row (FILE *fp,
 			 const timevar_time_def *total,
 			 const timevar_def *tv);
+  static void print_json_times (FILE *fp, const timevar_time_def *elapsed);
 
  private:
 
@@ -169,6 +175,14 @@ class timer
     struct timevar_stack_def *next;
   };
 
+  /* Private type: the time taken by a pass on a single function.  */
+  struct function_pass_def
+  {
+    const char *pass_name;
+    char *function_name;
+    struct timevar_time_def elapsed;
+  };
+
   /* A class for managing a collection of named timing items, for use
      e.g. by libgccjit for timing client code.  This class is declared
      inside timevar.c to avoid everything using timevar.h
@@ -198,6 +212,11 @@ class timer
   /* If non-NULL, for use when timing libgccjit's client code.  */
   named_items *m_jit_client_items;
 
+  /* The slowest runs of a pass on a single function, slowest first, for
+     -ftime-report-functions.  */
+  function_pass_def *m_slowest_function_passes;
+  unsigned m_n_slowest_function_passes;
+
   friend class named_items;
 };
 
@@ -2032,12 +2032,59 @@ toplev::toplev (timer *external_timer,
     g_timer = external_timer;
 }
 
+/* The file requested with -ftime-report-json=.  It is opened when the
+   timevars are started, while errors can still be diagnosed, and
+   written once TV_TOTAL has been stopped.  */
+
+static FILE *time_report_json_file;
+
+/* Write the JSON time report to time_report_json_file: the times
+   recorded by g_timer and the GGC memory usage, together with the GGC
+   allocation sites when -fmem-report and detailed memory statistics
+   are enabled.  */
+
+static void
+dump_time_report_json (void)
+{
+  FILE *f = time_report_json_file;
+  size_t in_use, peak;
+
+  fputs ("{\n  \"version\": 1,\n  \"main_input_filename\": ", f);
+  print_json_string (f, main_input_filename ? main_input_filename : "");
+  fputs (",\n  \"time\": ", f);
+  g_timer->print_json (f);
+
+  ggc_get_usage (&in_use, &peak);
+  fprintf (f, ",\n  \"memory\": {\n    \"ggc_allocated\": %lu,\n"
+	   "    \"ggc_in_use\": %lu,\n    \"ggc_peak\": %lu",
+	   (unsigned long) timevar_ggc_mem_total, (unsigned long) in_use,
+	   (unsigned long) peak);
+#ifdef HAVE_GETRUSAGE
+  struct rusage rusage;
+  getrusage (RUSAGE_SELF, &rusage);
+  fprintf (f, ",\n    \"peak_rss\": %lu",
+	   (unsigned long) rusage.ru_maxrss * 1024);
+#endif
+  if (mem_report)
+    {
+      fputs (",\n    \"ggc_allocation_sites\": ", f);
+      dump_ggc_loc_statistics_json (f);
+    }
+  fputs ("\n  }\n}\n", f);
+
+  fclose (f);
+  time_report_json_file = NULL;
+}
+
 toplev::~toplev ()
 {
   if (g_timer && m_use_TV_TOTAL)
     {
       g_timer->stop (TV_TOTAL);
-      g_timer->print (stderr);
+      if (time_report_json_file)
+	dump_time_report_json ();
+      if (time_report || !quiet_flag || flag_detailed_statistics)
+	g_timer->print (stderr);
       delete g_timer;
       g_timer = NULL;
     }
@@ -2049,9 +2096,17 @@ toplev::~toplev ()
 void
 toplev::start_timevars ()
 {
-  if (time_report || !quiet_flag  || flag_detailed_statistics)
+  if (time_report || !quiet_flag  || flag_detailed_statistics
+      || time_report_json)
     timevar_init ();
 
+  if (time_report_json)
+    {
+      time_report_json_file = fopen (time_report_json, "w");
+      if (time_report_json_file == NULL)
+	error ("cannot open time report file %s: %m", time_report_json);
+    }
+
   timevar_start (TV_TOTAL);
 }
 
@@ -230,6 +230,9 @@ static struct constraint_stats
   unsigned int num_edges;
   unsigned int num_implicit_edges;
   unsigned int points_to_sets_created;
+  unsigned int propagated_sets;
+  unsigned int propagated_sets_shared;
+  unsigned long propagated_bytes_saved;
 } stats;
 
 struct variable_info
@@ -1474,6 +1477,111 @@ scc_visit (constraint_graph_t graph, struct scc_info *si, unsigned int n)
     si->scc_stack.safe_push (n);
 }
 
+/* The wave solver (see solve_graph_wave) keeps the oldsolution of a
+   variable, the part of its solution it has already propagated, in a
+   set shared with every variable that has propagated the same bits.
+   The variables along a chain of copies end up with the same set, so a
+   large set such as that of an array of function pointers is stored
+   only once.  */
+
+struct shared_pts
+{
+  /* The set, pointed to by the oldsolution of the variables.  This must
+     be the first member.  */
+  bitmap_head pts;
+  hashval_t hashcode;
+  /* The number of variables that use the set.  */
+  unsigned int refs;
+};
+
+/* Shared_pts hashtable helpers.  */
+
+struct shared_pts_hasher : nofree_ptr_hash <shared_pts>
+{
+  static inline hashval_t hash (const shared_pts *);
+  static inline bool equal (const shared_pts *, const shared_pts *);
+};
+
+/* Hash function for a shared_pts.  */
+
+inline hashval_t
+shared_pts_hasher::hash (const shared_pts *sp)
+{
+  return sp->hashcode;
+}
+
+/* Equality function for two shared_pts.  */
+
+inline bool
+shared_pts_hasher::equal (const shared_pts *sp1, const shared_pts *sp2)
+{
+  return bitmap_equal_p (&sp1->pts, &sp2->pts);
+}
+
+/* The shared oldsolutions while the wave solver runs, NULL otherwise.  */
+
+static hash_table<shared_pts_hasher> *shared_pts_table;
+
+/* Free the oldsolution of VI.  */
+
+static void
+free_oldsolution (varinfo_t vi)
+{
+  struct shared_pts *sp;
+
+  if (!vi->oldsolution)
+    return;
+
+  if (!shared_pts_table)
+    {
+      BITMAP_FREE (vi->oldsolution);
+      return;
+    }
+
+  sp = (struct shared_pts *) vi->oldsolution;
+  vi->oldsolution = NULL;
+  if (--sp->refs == 0)
+    {
+      shared_pts_table->remove_elt_with_hash (sp, sp->hashcode);
+      bitmap_clear (&sp->pts);
+      free (sp);
+    }
+}
+
+/* Add the bits in DELTA to the oldsolution of VI, sharing the result
+   with any variable that has the same oldsolution.  */
+
+static void
+add_to_shared_oldsolution (varinfo_t vi, bitmap delta)
+{
+  struct shared_pts *sp = XNEW (struct shared_pts);
+  struct shared_pts **slot;
+
+  bitmap_initialize (&sp->pts, &oldpta_obstack);
+  if (vi->oldsolution)
+    bitmap_ior (&sp->pts, vi->oldsolution, delta);
+  else
+    bitmap_copy (&sp->pts, delta);
+  sp->hashcode = bitmap_hash (&sp->pts);
+  sp->refs = 0;
+
+  stats.propagated_sets++;
+  slot = shared_pts_table->find_slot_with_hash (sp, sp->hashcode, INSERT);
+  if (*slot)
+    {
+      bitmap_clear (&sp->pts);
+      free (sp);
+      sp = *slot;
+      stats.propagated_sets_shared++;
+    }
+  else
+    *slot = sp;
+  sp->refs++;
+
+  free_oldsolution (vi);
+  vi->oldsolution = &sp->pts;
+}
+
 /* Unify node FROM into node TO, updating the changed count if
    necessary when UPDATE_CHANGED is true.  */
 
@@ -1519,12 +1627,10 @@ unify_nodes (constraint_graph_t graph, unsigned int to, unsigned int from,
 	}
 
       BITMAP_FREE (fromvi->solution);
-      if (fromvi->oldsolution)
-	BITMAP_FREE (fromvi->oldsolution);
+      free_oldsolution (fromvi);
 
-      if (stats.iterations > 0
-	  && tovi->oldsolution)
-	BITMAP_FREE (tovi->oldsolution);
+      if (stats.iterations > 0)
+	free_oldsolution (tovi);
     }
   if (graph->succs[to])
     bitmap_clear_bit (graph->succs[to], to);
@@ -2800,6 +2906,211 @@ solve_graph (constraint_graph_t graph)
   bitmap_obstack_release (&oldpta_obstack);
 }
 
+/* Return the number of bytes the elements of bitmap B take.  */
+
+static unsigned long
+bitmap_elements_size (bitmap b)
+{
+  unsigned long n = 0;
+  bitmap_element *elt;
+
+  for (elt = b->first; elt; elt = elt->next)
+    n += sizeof (bitmap_element);
+  return n;
+}
+
+/* Solve the constraint graph GRAPH by wave propagation.  Each iteration
+   first propagates the new bits of the solutions along the copy edges,
+   visiting the nodes in topological order so that the bits travel the
+   whole acyclic part of the graph in one wave, then processes the
+   complex constraints of the nodes that received bits, which may add
+   edges and bits for the next iteration.  The propagated part of each
+   solution is shared between the variables, see shared_pts.  The result
+   is the same as that of solve_graph.  */
+
+static void
+solve_graph_wave (constraint_graph_t graph)
+{
+  unsigned int size = graph->size;
+  unsigned int i;
+  bitmap pts;
+
+  changed = BITMAP_ALLOC (NULL);
+  shared_pts_table = new hash_table<shared_pts_hasher> (511);
+
+  /* Mark all initial non-collapsed nodes as changed.  */
+  for (i = 1; i < size; i++)
+    {
+      varinfo_t ivi = get_varinfo (i);
+      if (find (i) == i && !bitmap_empty_p (ivi->solution)
+	  && ((graph->succs[i] && !bitmap_empty_p (graph->succs[i]))
+	      || graph->complex[i].length () > 0))
+	bitmap_set_bit (changed, i);
+    }
+
+  /* Allocate a bitmap to be used to store the changed bits.  */
+  pts = BITMAP_ALLOC (&pta_obstack);
+
+  while (!bitmap_empty_p (changed))
+    {
+      struct topo_info *ti = init_topo_info ();
+      /* The bits each node with complex constraints received in this
+	 iteration, and those nodes.  */
+      bitmap *deltas = XCNEWVEC (bitmap, size);
+      auto_vec<unsigned> complex_nodes;
+      unsigned int k;
+
+      stats.iterations++;
+
+      bitmap_obstack_initialize (&iteration_obstack);
+
+      compute_topo_order (graph, ti);
+
+      /* The wave.  */
+      while (ti->topo_order.length () != 0)
+	{
+	  varinfo_t vi;
+	  unsigned int j;
+	  bitmap_iterator bi;
+	  unsigned eff_escaped_id;
+
+	  i = ti->topo_order.pop ();
+
+	  /* If this variable is not a representative, skip it.  */
+	  if (find (i) != i)
+	    continue;
+
+	  /* In certain indirect cycle cases, we may merge this
+	     variable to another.  */
+	  if (eliminate_indirect_cycles (i) && find (i) != i)
+	    continue;
+
+	  if (!bitmap_clear_bit (changed, i))
+	    continue;
+
+	  /* Compute the changed set of solution bits.  If anything
+	     is in the solution just propagate that.  */
+	  vi = get_varinfo (i);
+	  if (bitmap_bit_p (vi->solution, anything_id))
+	    {
+	      if (vi->oldsolution
+		  && bitmap_bit_p (vi->oldsolution, anything_id))
+		continue;
+	      bitmap_copy (pts, get_varinfo (find (anything_id))->solution);
+	    }
+	  else if (vi->oldsolution)
+	    bitmap_and_compl (pts, vi->solution, vi->oldsolution);
+	  else
+	    bitmap_copy (pts, vi->solution);
+
+	  if (bitmap_empty_p (pts))
+	    continue;
+
+	  add_to_shared_oldsolution (vi, pts);
+
+	  if (graph->complex[i].length () > 0)
+	    {
+	      if (!deltas[i])
+		{
+		  deltas[i] = BITMAP_ALLOC (&iteration_obstack);
+		  complex_nodes.safe_push (i);
+		}
+	      bitmap_ior_into (deltas[i], pts);
+	    }
+
+	  /* Propagate the new bits to all successors.  */
+	  eff_escaped_id = find (escaped_id);
+	  EXECUTE_IF_IN_NONNULL_BITMAP (graph->succs[i], 0, j, bi)
+	    {
+	      unsigned int to = find (j);
+	      bool flag;
+
+	      /* Don't try to propagate to ourselves.  */
+	      if (to == i)
+		continue;
+
+	      /* If we propagate from ESCAPED use ESCAPED as
+		 placeholder.  */
+	      if (i == eff_escaped_id)
+		flag = bitmap_set_bit (get_varinfo (to)->solution, escaped_id);
+	      else
+		flag = bitmap_ior_into (get_varinfo (to)->solution, pts);
+
+	      if (flag)
+		bitmap_set_bit (changed, to);
+	    }
+	}
+
+      /* The complex constraints of the nodes the wave reached.  Those
+	 of a node merged into another one meanwhile now belong to its
+	 representative, which propagates its whole solution again.  */
+      FOR_EACH_VEC_ELT (complex_nodes, k, i)
+	{
+	  bitmap delta = deltas[i];
+	  bitmap expanded_delta = NULL;
+	  bitmap solution;
+	  bool solution_empty;
+	  unsigned int j;
+	  constraint_t c;
+
+	  if (find (i) != i)
+	    {
+	      free_oldsolution (get_varinfo (find (i)));
+	      bitmap_set_bit (changed, find (i));
+	      continue;
+	    }
+
+	  solution = get_varinfo (i)->solution;
+	  solution_empty = bitmap_empty_p (solution);
+	  FOR_EACH_VEC_ELT (graph->complex[i], j, c)
+	    {
+	      c->lhs.var = find (c->lhs.var);
+	      c->rhs.var = find (c->rhs.var);
+
+	      /* The only complex constraint that can change our
+		 solution to non-empty, given an empty solution,
+		 is a constraint where the lhs side is receiving
+		 some set from elsewhere.  */
+	      if (!solution_empty || c->lhs.type != DEREF)
+		do_complex_constraint (graph, c, delta, &expanded_delta);
+	    }
+	  BITMAP_FREE (expanded_delta);
+	}
+
+      free (deltas);
+      free_topo_info (ti);
+      bitmap_obstack_release (&iteration_obstack);
+    }
+
+  /* Account for the memory the sharing saved, as it is at the end.  */
+  stats.propagated_bytes_saved = 0;
+  for (hash_table<shared_pts_hasher>::iterator iter
+	 = shared_pts_table->begin ();
+       iter != shared_pts_table->end (); ++iter)
+    stats.propagated_bytes_saved
+      += (*iter)->refs > 1
+	 ? ((*iter)->refs - 1) * bitmap_elements_size (&(*iter)->pts) : 0;
+
+  if (dump_file)
+    fprintf (dump_file, "Wave solver: %u iterations, %u of %u propagated "
+	     "sets shared, %lu bytes saved\n", stats.iterations,
+	     stats.propagated_sets_shared, stats.propagated_sets,
+	     stats.propagated_bytes_saved);
+
+  for (i = 1; i < size; i++)
+    get_varinfo (i)->oldsolution = NULL;
+  for (hash_table<shared_pts_hasher>::iterator iter
+	 = shared_pts_table->begin ();
+       iter != shared_pts_table->end (); ++iter)
+    free (*iter);
+  delete shared_pts_table;
+  shared_pts_table = NULL;
+
+  BITMAP_FREE (pts);
+  BITMAP_FREE (changed);
+  bitmap_obstack_release (&oldpta_obstack);
+}
+
 /* Map from trees to variable infos.  */
 static hash_map<tree, varinfo_t> *vi_for_tree;
 
@@ -6754,6 +7065,12 @@ dump_sa_points_to_info (FILE *outfile)
       fprintf (outfile, "Number of edges:          %d\n", stats.num_edges);
       fprintf (outfile, "Number of implicit edges: %d\n",
 	       stats.num_implicit_edges);
+      fprintf (outfile, "Propagated sets:          %d\n",
+	       stats.propagated_sets);
+      fprintf (outfile, "Propagated sets shared:   %d\n",
+	       stats.propagated_sets_shared);
+      fprintf (outfile, "Bytes saved by sharing:   %lu\n",
+	       stats.propagated_bytes_saved);
     }
 
   for (i = 1; i < varmap.length (); i++)
@@ -7058,7 +7375,10 @@ solve_constraints (void)
   if (dump_file)
     fprintf (dump_file, "Solving graph\n");
 
-  solve_graph (graph);
+  if (PARAM_VALUE (PARAM_PTA_WAVE_SOLVER))
+    solve_graph_wave (graph);
+  else
+    solve_graph (graph);
 
   if (dump_file && (dump_flags & TDF_GRAPH))
     {
@@ -607,6 +607,30 @@ static shared_hash *empty_shared_hash;
 /* Scratch register bitmap used by cselib_expand_value_rtx.  */
 static bitmap scratch_regs = NULL;
 
+/* The DECL_UIDs of the variables whose locations are no longer tracked
+   in the current function, because the dataflow analysis exceeded its
+   budget, or NULL if all variables are tracked.  */
+static bitmap untracked_decls;
+
+/* Set when vt_find_locations exceeded its budget and stopped tracking
+   more variables, so that it should be run again.  */
+static bool untracked_more_decls;
+
+/* Set when the budget exceeded last was the size of the hash tables,
+   rather than the work done.  */
+static bool vt_size_limit_exceeded;
+
+/* Return true if DV is a variable that is no longer tracked.  */
+
+static inline bool
+untracked_dv_p (decl_or_value dv)
+{
+  return (untracked_decls
+	  && dv_as_opaque (dv)
+	  && dv_is_decl_p (dv)
+	  && bitmap_bit_p (untracked_decls, DECL_UID (dv_as_decl (dv))));
+}
+
 #ifdef HAVE_window_save
 struct GTY(()) parm_reg {
   rtx outgoing;
@@ -1836,6 +1860,9 @@ var_reg_decl_set (dataflow_set *set, rtx loc, enum var_init_status initialized,
   if (decl_p)
     dv = dv_from_decl (var_debug_decl (dv_as_decl (dv)));
 
+  if (untracked_dv_p (dv))
+    return;
+
   for (node = set->regs[REGNO (loc)]; node; node = node->next)
     if (dv_as_opaque (node->dv) == dv_as_opaque (dv)
 	&& node->offset == offset)
@@ -6994,6 +7021,315 @@ compute_bb_dataflow (basic_block bb)
   return changed;
 }
 
+/* The IN set of a basic block only needs the locations of the variables
+   that may be looked at on some path from the start of the block.  For
+   a variable declared in a lexical block nested in the function, this is
+   the case if the path reaches a real insn in the scope of the variable
+   before a debug bind of the whole variable.  Dropping the other ones
+   keeps the sets of functions that inline many small functions, or that
+   have many scopes, from growing with the number of scopes they pass
+   through.  */
+
+/* Obstack for the bitmaps below.  */
+static bitmap_obstack scope_obstack;
+
+/* The DECL_UIDs of the variables declared in the nested lexical blocks
+   of the current function that a real insn is in the scope of.  */
+static bitmap scoped_decls;
+
+/* For each basic block, the DECL_UIDs of the variables in SCOPED_DECLS
+   whose locations may be needed on some path from its start, or NULL
+   if the IN sets are not filtered.  */
+static bitmap_head *scope_live_in;
+
+/* Return the DECL_UIDs of the variables declared in BLOCK and in the
+   blocks enclosing it, up to but excluding the outermost block of the
+   function, or NULL if there are none.  CACHE holds the sets that have
+   been computed already.  */
+
+static bitmap
+block_scoped_decls (tree block, hash_map<tree, bitmap> *cache)
+{
+  bitmap *cached, outer, decls;
+  tree var;
+
+  if (!block || TREE_CODE (block) != BLOCK)
+    return NULL;
+  if (BLOCK_FRAGMENT_ORIGIN (block))
+    block = BLOCK_FRAGMENT_ORIGIN (block);
+  if (block == DECL_INITIAL (current_function_decl))
+    return NULL;
+
+  cached = cache->get (block);
+  if (cached)
+    return *cached;
+
+  outer = block_scoped_decls (BLOCK_SUPERCONTEXT (block), cache);
+  decls = BITMAP_ALLOC (&scope_obstack);
+  if (outer)
+    bitmap_copy (decls, outer);
+  for (var = BLOCK_VARS (block); var; var = DECL_CHAIN (var))
+    if (TREE_CODE (var) == VAR_DECL)
+      bitmap_set_bit (decls, DECL_UID (var));
+  cache->put (block, decls);
+  return decls;
+}
+
+/* Compute SCOPED_DECLS and SCOPE_LIVE_IN for the current function.  */
+
+static void
+vt_compute_scope_liveness (void)
+{
+  hash_map<tree, bitmap> block_decls;
+  bitmap_head *gen, *kill;
+  bitmap live_out;
+  basic_block bb;
+  tree scope = NULL_TREE;
+  int *postorder;
+  int i, n;
+  bool changed;
+
+  bitmap_obstack_initialize (&scope_obstack);
+  scoped_decls = BITMAP_ALLOC (&scope_obstack);
+  scope_live_in = XNEWVEC (bitmap_head, last_basic_block_for_fn (cfun));
+  gen = XNEWVEC (bitmap_head, last_basic_block_for_fn (cfun));
+  kill = XNEWVEC (bitmap_head, last_basic_block_for_fn (cfun));
+
+  /* As in reemit_insn_block_notes, insns without a location are in the
+     scope of the insns before them, so walk the blocks in the order in
+     which they are output.  */
+  FOR_EACH_BB_FN (bb, cfun)
+    {
+      tree last_block = NULL_TREE;
+      rtx_insn *insn;
+
+      bitmap_initialize (&scope_live_in[bb->index], &scope_obstack);
+      bitmap_initialize (&gen[bb->index], &scope_obstack);
+      bitmap_initialize (&kill[bb->index], &scope_obstack);
+
+      FOR_BB_INSNS (bb, insn)
+	if (DEBUG_INSN_P (insn))
+	  {
+	    tree decl = INSN_VAR_LOCATION_DECL (insn);
+
+	    /* A bind of the whole variable sets its location, so its
+	       location at the start of the block is not needed past
+	       this point.  */
+	    if (TREE_CODE (decl) == VAR_DECL
+		&& var_debug_decl (decl) == decl
+		&& dv_onepart_p (dv_from_decl (decl))
+		&& !bitmap_bit_p (&gen[bb->index], DECL_UID (decl)))
+	      bitmap_set_bit (&kill[bb->index], DECL_UID (decl));
+	  }
+	else if (active_insn_p (insn) && !JUMP_TABLE_DATA_P (insn))
+	  {
+	    tree block = insn_scope (insn);
+	    bitmap decls;
+
+	    if (block)
+	      scope = block;
+	    else if (INSN_LOCATION (insn) != UNKNOWN_LOCATION)
+	      scope = DECL_INITIAL (current_function_decl);
+	    if (scope == last_block)
+	      continue;
+
+	    last_block = scope;
+	    decls = block_scoped_decls (last_block, &block_decls);
+	    if (decls)
+	      {
+		bitmap_ior_into (scoped_decls, decls);
+		bitmap_ior_and_compl_into (&gen[bb->index], decls,
+					   &kill[bb->index]);
+	      }
+	  }
+
+      bitmap_copy (&scope_live_in[bb->index], &gen[bb->index]);
+    }
+
+  /* Solve the backward problem LIVE_IN = GEN | (LIVE_OUT & ~KILL).  */
+  live_out = BITMAP_ALLOC (&scope_obstack);
+  postorder = XNEWVEC (int, n_basic_blocks_for_fn (cfun));
+  n = post_order_compute (postorder, false, false);
+  do
+    {
+      changed = false;
+      for (i = 0; i < n; i++)
+	{
+	  edge e;
+	  edge_iterator ei;
+
+	  bb = BASIC_BLOCK_FOR_FN (cfun, postorder[i]);
+	  bitmap_clear (live_out);
+	  FOR_EACH_EDGE (e, ei, bb->succs)
+	    if (e->dest != EXIT_BLOCK_PTR_FOR_FN (cfun))
+	      bitmap_ior_into (live_out, &scope_live_in[e->dest->index]);
+	  if (bitmap_ior_and_compl (&scope_live_in[bb->index],
+				    &gen[bb->index], live_out,
+				    &kill[bb->index]))
+	    changed = true;
+	}
+    }
+  while (changed);
+
+  if (dump_file)
+    {
+      unsigned long live = 0;
+
+      FOR_EACH_BB_FN (bb, cfun)
+	live += bitmap_count_bits (&scope_live_in[bb->index]);
+      fprintf (dump_file, "%lu variables of nested scopes, live at %lu "
+	       "block starts in total\n",
+	       bitmap_count_bits (scoped_decls), live);
+    }
+
+  free (postorder);
+  BITMAP_FREE (live_out);
+  FOR_EACH_BB_FN (bb, cfun)
+    {
+      bitmap_clear (&gen[bb->index]);
+      bitmap_clear (&kill[bb->index]);
+    }
+  free (gen);
+  free (kill);
+}
+
+/* Release SCOPED_DECLS and SCOPE_LIVE_IN.  */
+
+static void
+vt_free_scope_liveness (void)
+{
+  bitmap_obstack_release (&scope_obstack);
+  free (scope_live_in);
+  scope_live_in = NULL;
+  scoped_decls = NULL;
+}
+
+/* Delete all the locations of the variable DV from dataflow set SET.  */
+
+static void
+delete_dv_locations (dataflow_set *set, decl_or_value dv)
+{
+  variable **slot;
+
+  while ((slot = shared_hash_find_slot_noinsert (set->vars, dv))
+	 && (*slot)->n_var_parts)
+    {
+      variable *var = *slot;
+      int pos = var->n_var_parts - 1;
+
+      clobber_slot_part (set, NULL, slot,
+			 var->onepart ? 0 : VAR_PART_OFFSET (var, pos),
+			 NULL);
+    }
+}
+
+/* Delete from dataflow set SET the locations of the variables in
+   SCOPED_DECLS that are not in LIVE.  */
+
+static void
+dataflow_set_drop_dead_scoped (dataflow_set *set, bitmap live)
+{
+  auto_vec<decl_or_value, 32> dead;
+  variable_iterator_type hi;
+  variable *var;
+  unsigned i;
+  decl_or_value dv;
+
+  FOR_EACH_HASH_TABLE_ELEMENT (*shared_hash_htab (set->vars), var,
+			       variable, hi)
+    if (dv_is_decl_p (var->dv)
+	&& TREE_CODE (dv_as_decl (var->dv)) == VAR_DECL
+	&& bitmap_bit_p (scoped_decls, DECL_UID (dv_as_decl (var->dv)))
+	&& !bitmap_bit_p (live, DECL_UID (dv_as_decl (var->dv))))
+      dead.safe_push (var->dv);
+
+  FOR_EACH_VEC_ELT (dead, i, dv)
+    delete_dv_locations (set, dv);
+}
+
+/* A variable and the number of entries for it in the dataflow sets.  */
+
+struct decl_weight
+{
+  tree decl;
+  int weight;
+};
+
+/* Compare decl_weights, heaviest first.  */
+
+static int
+decl_weight_cmp (const void *p1, const void *p2)
+{
+  const decl_weight *w1 = (const decl_weight *) p1;
+  const decl_weight *w2 = (const decl_weight *) p2;
+
+  if (w1->weight != w2->weight)
+    return w2->weight - w1->weight;
+  return DECL_UID (w1->decl) - DECL_UID (w2->decl);
+}
+
+/* Stop tracking the variables with the most entries in the IN and OUT
+   sets, until at least half of the entries for variables are gone.  The
+   parameters of the function are always tracked.  Return the number of
+   variables that are no longer tracked.  */
+
+static int
+vt_untrack_heavy_decls (void)
+{
+  hash_map<tree, int> index;
+  auto_vec<decl_weight> weights;
+  decl_weight *w;
+  basic_block bb;
+  int total = 0, dropped = 0, n = 0;
+  unsigned i;
+
+  FOR_EACH_BB_FN (bb, cfun)
+    for (i = 0; i < 2; i++)
+      {
+	dataflow_set *set = i ? &VTI (bb)->out : &VTI (bb)->in;
+	variable_iterator_type hi;
+	variable *var;
+
+	FOR_EACH_HASH_TABLE_ELEMENT (*shared_hash_htab (set->vars), var,
+				     variable, hi)
+	  if (dv_is_decl_p (var->dv)
+	      && TREE_CODE (dv_as_decl (var->dv)) == VAR_DECL)
+	    {
+	      bool existed;
+	      int &ix = index.get_or_insert (dv_as_decl (var->dv), &existed);
+
+	      if (!existed)
+		{
+		  decl_weight nw = { dv_as_decl (var->dv), 0 };
+		  ix = weights.length ();
+		  weights.safe_push (nw);
+		}
+	      weights[ix].weight++;
+	      total++;
+	    }
+      }
+
+  weights.qsort (decl_weight_cmp);
+  if (!untracked_decls)
+    untracked_decls = BITMAP_ALLOC (NULL);
+  FOR_EACH_VEC_ELT (weights, i, w)
+    {
+      if (2 * dropped >= total)
+	break;
+      bitmap_set_bit (untracked_decls, DECL_UID (w->decl));
+      dropped += w->weight;
+      n++;
+      if (dump_file)
+	{
+	  fprintf (dump_file, "Not tracking ");
+	  print_generic_expr (dump_file, w->decl, 0);
+	  fprintf (dump_file, " (%i entries)\n", w->weight);
+	}
+    }
+
+  return n;
+}
+
 /* Find the locations of variables in the whole function.  */
 
 static bool
@@ -7009,6 +7345,10 @@ vt_find_locations (void)
   int i;
   int htabsz = 0;
   int htabmax = PARAM_VALUE (PARAM_MAX_VARTRACK_SIZE);
+  HOST_WIDE_INT work = 0;
+  HOST_WIDE_INT maxwork
+    = ((HOST_WIDE_INT) PARAM_VALUE (PARAM_MAX_VARTRACK_WORK)
+       * n_basic_blocks_for_fn (cfun));
   bool success = true;
 
   timevar_push (TV_VAR_TRACKING_DATAFLOW);
@@ -7030,6 +7370,11 @@ vt_find_locations (void)
     pending->insert (bb_order[bb->index], bb);
   bitmap_ones (in_pending);
 
+  if (PARAM_VALUE (PARAM_VARTRACK_SPARSE))
+    vt_compute_scope_liveness ();
+
+  untracked_more_decls = false;
+
   while (success && !pending->empty ())
     {
       std::swap (worklist, pending);
@@ -7117,20 +7462,43 @@ vt_find_locations (void)
 		    dataflow_set_union (&VTI (bb)->in, &VTI (e->src)->out);
 		}
 
+	      if (scope_live_in)
+		dataflow_set_drop_dead_scoped (&VTI (bb)->in,
+					       &scope_live_in[bb->index]);
+
 	      changed = compute_bb_dataflow (bb);
 	      htabsz += shared_hash_htab (VTI (bb)->in.vars)->size ()
 			 + shared_hash_htab (VTI (bb)->out.vars)->size ();
+	      work += shared_hash_htab (VTI (bb)->in.vars)->elements ()
+		      + shared_hash_htab (VTI (bb)->out.vars)->elements ();
 
-	      if (htabmax && htabsz > htabmax)
+	      if ((htabmax && htabsz > htabmax)
+		  || (maxwork && work > maxwork))
 		{
-		  if (MAY_HAVE_DEBUG_INSNS)
+		  vt_size_limit_exceeded = htabmax && htabsz > htabmax;
+
+		  /* Rather than giving up on the whole function, stop
+		     tracking the variables that take the most space and
+		     let the caller start over.  */
+		  success = false;
+		  untracked_more_decls = vt_untrack_heavy_decls () > 0;
+		  if (untracked_more_decls)
+		    break;
+
+		  if (MAY_HAVE_DEBUG_INSNS && vt_size_limit_exceeded)
 		    inform (DECL_SOURCE_LOCATION (cfun->decl),
 			    "variable tracking size limit exceeded with "
 			    "-fvar-tracking-assignments, retrying without");
-		  else
+		  else if (MAY_HAVE_DEBUG_INSNS)
+		    inform (DECL_SOURCE_LOCATION (cfun->decl),
+			    "variable tracking work limit exceeded with "
+			    "-fvar-tracking-assignments, retrying without");
+		  else if (vt_size_limit_exceeded)
 		    inform (DECL_SOURCE_LOCATION (cfun->decl),
 			    "variable tracking size limit exceeded");
-		  success = false;
+		  else
+		    inform (DECL_SOURCE_LOCATION (cfun->decl),
+			    "variable tracking work limit exceeded");
 		  break;
 		}
 
@@ -7187,6 +7555,9 @@ vt_find_locations (void)
     FOR_EACH_BB_FN (bb, cfun)
       gcc_assert (VTI (bb)->flooded);
 
+  if (scope_live_in)
+    vt_free_scope_liveness ();
+
   free (bb_order);
   delete worklist;
   delete pending;
@@ -7809,6 +8180,9 @@ set_variable_part (dataflow_set *set, rtx loc,
 {
   variable **slot;
 
+  if (untracked_dv_p (dv))
+    return;
+
   if (iopt == NO_INSERT)
     slot = shared_hash_find_slot_noinsert (set->vars, dv);
   else
@@ -10233,6 +10607,31 @@ delete_debug_insns (void)
     }
 }
 
+/* Delete the debug insns that bind the variables that are no longer
+   tracked, so that the values they use are not tracked either.  */
+
+static void
+delete_untracked_debug_insns (void)
+{
+  basic_block bb;
+  rtx_insn *insn, *next;
+
+  if (!MAY_HAVE_DEBUG_INSNS || !untracked_decls)
+    return;
+
+  FOR_EACH_BB_FN (bb, cfun)
+    {
+      FOR_BB_INSNS_SAFE (bb, insn, next)
+	if (DEBUG_INSN_P (insn))
+	  {
+	    tree decl = INSN_VAR_LOCATION_DECL (insn);
+	    if (TREE_CODE (decl) == VAR_DECL
+		&& untracked_dv_p (dv_from_decl (var_debug_decl (decl))))
+	      delete_insn (insn);
+	  }
+    }
+}
+
 /* Run a fast, BB-local only version of var tracking, to take care of
    information that we don't do global analysis on, such that not all
    information is lost.  If SKIPPED holds, we're skipping the global
@@ -10301,6 +10700,35 @@ vt_finalize (void)
   vui_allocated = 0;
 }
 
+/* Find the locations of variables in the whole function, and whenever
+   that exceeds the budget of the dataflow analysis, start over without
+   the variables it stopped tracking.  */
+
+static bool
+vt_find_locations_within_budget (void)
+{
+  bool success = vt_find_locations ();
+
+  while (!success && untracked_more_decls)
+    {
+      vt_finalize ();
+      delete_untracked_debug_insns ();
+      success = vt_initialize ();
+      gcc_assert (success);
+      success = vt_find_locations ();
+    }
+
+  if (success && untracked_decls && vt_size_limit_exceeded)
+    inform (DECL_SOURCE_LOCATION (cfun->decl),
+	    "variable tracking size limit exceeded, not tracking %u variables",
+	    (unsigned) bitmap_count_bits (untracked_decls));
+  else if (success && untracked_decls)
+    inform (DECL_SOURCE_LOCATION (cfun->decl),
+	    "variable tracking work limit exceeded, not tracking %u variables",
+	    (unsigned) bitmap_count_bits (untracked_decls));
+  return success;
+}
+
 /* The entry point to variable tracking pass.  */
 
 static inline unsigned int
@@ -10332,7 +10760,7 @@ variable_tracking_main_1 (void)
       return 0;
     }
 
-  success = vt_find_locations ();
+  success = vt_find_locations_within_budget ();
 
   if (!success && flag_var_tracking_assignments > 0)
     {
@@ -10342,17 +10770,19 @@ variable_tracking_main_1 (void)
 
       /* This is later restored by our caller.  */
       flag_var_tracking_assignments = 0;
+      BITMAP_FREE (untracked_decls);
 
       success = vt_initialize ();
       gcc_assert (success);
 
-      success = vt_find_locations ();
+      success = vt_find_locations_within_budget ();
     }
 
   if (!success)
     {
       vt_finalize ();
       vt_debug_insns_local (false);
+      BITMAP_FREE (untracked_decls);
       return 0;
     }
 
@@ -10369,6 +10799,7 @@ variable_tracking_main_1 (void)
 
   vt_finalize ();
   vt_debug_insns_local (false);
+  BITMAP_FREE (untracked_decls);
   return 0;
 }
 
@@ -154,6 +154,11 @@ section *eh_frame_section;
    been selected or if we lose track of what the current section is.  */
 section *in_section;
 
+/* While a block of assembly that must not depend on the sections output
+   before it is being written, the named sections switched to since the
+   start of the block; see begin_standalone_sections.  */
+static hash_set<section *> *standalone_sections;
+
 /* True if code for the current function is currently being directed
    at the cold section.  */
 bool in_cold_section_p;
@@ -1821,6 +1826,19 @@ assemble_start_function (tree decl, const char *fnname)
     saw_no_split_stack = true;
 }
 
+/* Record the effects that assemble_start_function has on the rest of
+   the output file for function DECL, whose assembly was written by
+   other means.  */
+
+void
+note_function_assembled (tree decl)
+{
+  if (TREE_PUBLIC (decl))
+    notice_global_symbol (decl);
+  if (lookup_attribute ("no_split_stack", DECL_ATTRIBUTES (decl)))
+    saw_no_split_stack = true;
+}
+
 /* Output assembler code associated with defining the size of the
    function.  DECL describes the function.  NAME is the function's name.  */
 
@@ -7144,6 +7162,8 @@ output_section_asm_op (const void *directive)
 void
 switch_to_section (section *new_section)
 {
+  unsigned int flags;
+
   if (in_section == new_section)
     return;
 
@@ -7155,8 +7175,12 @@ switch_to_section (section *new_section)
   switch (SECTION_STYLE (new_section))
     {
     case SECTION_NAMED:
-      targetm.asm_out.named_section (new_section->named.name,
-				     new_section->named.common.flags,
+      flags = new_section->named.common.flags;
+      /* Declare the section in full, as if it had not been used before
+	 the block.  */
+      if (standalone_sections && !standalone_sections->add (new_section))
+	flags &= ~SECTION_DECLARED;
+      targetm.asm_out.named_section (new_section->named.name, flags,
 				     new_section->named.decl);
       break;
 
@@ -7172,6 +7196,31 @@ switch_to_section (section *new_section)
   new_section->common.flags |= SECTION_DECLARED;
 }
 
+/* Begin a block of assembly that does not depend on the sections output
+   before it, so that it can be copied to any point of another output
+   file.  The current section is forgotten, and the first switch to each
+   named section within the block declares that section in full.  */
+
+void
+begin_standalone_sections (void)
+{
+  in_section = NULL;
+  standalone_sections = new hash_set<section *>;
+}
+
+/* End the block started by begin_standalone_sections.  */
+
+void
+end_standalone_sections (void)
+{
+  delete standalone_sections;
+  standalone_sections = NULL;
+}
+
+/* The number of symbols placed in object blocks and of section anchors
+   created so far.  */
+int object_block_changes;
+
 /* If block symbol SYMBOL has not yet been assigned an offset, place
    it at the end of its block.  */
 
@@ -7246,6 +7295,7 @@ place_block_symbol (rtx symbol)
   block->size = offset + size;
 
   vec_safe_push (block->objects, symbol);
+  object_block_changes++;
 }
 
 /* Return the anchor that should be used to address byte offset OFFSET
@@ -7329,9 +7379,68 @@ get_section_anchor (struct object_block *block, HOST_WIDE_INT offset,
 
   /* Insert it at index BEGIN.  */
   vec_safe_insert (block->anchors, begin, anchor);
+  object_block_changes++;
   return anchor;
 }
 
+/* Place the variables that will be output in object blocks, and create
+   the section anchors needed to address them, which are added to
+   ANCHORS.  Code generated after this refers to them without changing
+   the layout of the blocks, unless it uses other variables or constants
+   that live in blocks.  */
+
+void
+place_variables_in_object_blocks (vec<rtx> *anchors)
+{
+  unsigned HOST_WIDE_INT range, offset, start, end;
+  varpool_node *node;
+  rtx rtl, symbol;
+  tree decl;
+
+  range = ((unsigned HOST_WIDE_INT) targetm.max_anchor_offset
+	   - (unsigned HOST_WIDE_INT) targetm.min_anchor_offset + 1);
+  FOR_EACH_DEFINED_VARIABLE (node)
+    {
+      decl = node->decl;
+      if (node->alias
+	  || TREE_ASM_WRITTEN (decl)
+	  || DECL_HAS_VALUE_EXPR_P (decl)
+	  || DECL_HARD_REGISTER (decl)
+	  || !use_blocks_for_decl_p (decl))
+	continue;
+      rtl = DECL_RTL (decl);
+      if (!MEM_P (rtl) || GET_CODE (XEXP (rtl, 0)) != SYMBOL_REF)
+	continue;
+      symbol = XEXP (rtl, 0);
+      if (!SYMBOL_REF_HAS_BLOCK_INFO_P (symbol) || !SYMBOL_REF_BLOCK (symbol))
+	continue;
+      place_block_symbol (symbol);
+      if (!flag_section_anchors)
+	continue;
+
+      /* Create the anchors for every offset within the variable.  */
+      start = SYMBOL_REF_BLOCK_OFFSET (symbol);
+      end = start + tree_to_uhwi (DECL_SIZE_UNIT (decl));
+      for (offset = start; ; offset += range)
+	{
+	  anchors->safe_push (get_section_anchor (SYMBOL_REF_BLOCK (symbol),
+						  MIN (offset, end),
+						  SYMBOL_REF_TLS_MODEL (symbol)));
+	  if (range == 0 || offset >= end)
+	    break;
+	}
+    }
+}
+
+/* Forget the tree constants output so far, so that the next function
+   outputs its own copy of the constants it refers to.  */
+
+void
+forget_output_constants (void)
+{
+  const_desc_htab->empty ();
+}
+
 /* Output the objects in BLOCK.  */
 
 static void
@@ -167,6 +167,36 @@ struct file_hash_entry_pool
   struct cpp_file_hash_entry pool[FILE_HASH_POOL_SIZE];
 };
 
+/* The listing of a directory searched for headers, as kept in the
+   include cache.  The cache maps the names of directories to these.  */
+struct include_dir_listing
+{
+  /* The name of the directory.  */
+  const char *name;
+
+  /* Its modification time when the listing was made.  */
+  time_t mtime;
+
+  /* The names of the entries of the directory.  */
+  char **names;
+  size_t count;
+
+  /* The same names hashed, once the listing has been checked against
+     the directory in this compilation.  NULL until then.  */
+  struct htab *entries;
+
+  /* True if the directory does not exist.  Such listings are not
+     written out.  */
+  bool missing;
+
+  /* True if the listing is to be written out.  It is not if the
+     directory may have changed within its timestamp granularity.  */
+  bool persist;
+};
+
+/* The first line of the include cache file.  */
+static const char include_cache_magic[] = "GCC include cache 1";
+
 static bool open_file (_cpp_file *file);
 static bool pch_open_file (cpp_reader *pfile, _cpp_file *file,
 			   bool *invalid_pch);
@@ -197,6 +227,18 @@ static bool validate_pch (cpp_reader *, _cpp_file *file, const char *pchname);
 static int pchf_save_compare (const void *e1, const void *e2);
 static int pchf_compare (const void *d_p, const void *e_p);
 static bool check_file_against_entries (cpp_reader *, _cpp_file *, bool);
+static hashval_t include_dir_listing_hash (const void *p);
+static int include_dir_listing_eq (const void *p, const void *q);
+static char *include_cache_read_line (FILE *f, struct obstack *ob);
+static void include_cache_load (cpp_reader *pfile);
+static bool include_cache_read_dir (cpp_reader *pfile,
+				    struct include_dir_listing *listing);
+static struct include_dir_listing *include_cache_listing (cpp_reader *pfile,
+							  const char *dir);
+static bool include_cache_may_exist (cpp_reader *pfile, const char *path);
+static int include_cache_write_listing (void **slot, void *f);
+static int include_cache_free_listing (void **slot, void *data);
+static void include_cache_free (cpp_reader *pfile);
 
 /* Given a filename in FILE->PATH, with the empty string interpreted
    as <stdin>, open it.
@@ -416,17 +458,23 @@ find_file_in_dir (cpp_reader *pfile, _cpp_file *file, bool *invalid_pch)
 	}
 
       file->path = path;
-      if (pch_open_file (pfile, file, invalid_pch))
-	return true;
+      if (CPP_OPTION (pfile, include_cache) == NULL
+	  || include_cache_may_exist (pfile, path))
+	{
+	  if (pch_open_file (pfile, file, invalid_pch))
+	    return true;
 
-      if (open_file (file))
-	return true;
+	  if (open_file (file))
+	    return true;
 
-      if (file->err_no != ENOENT)
-	{
-	  open_file_failed (pfile, file, 0);
-	  return true;
+	  if (file->err_no != ENOENT)
+	    {
+	      open_file_failed (pfile, file, 0);
+	      return true;
+	    }
 	}
+      else
+	file->err_no = ENOENT;
 
       /* We copy the path name onto an obstack partly so that we don't
 	 leak the memory, but mostly so that we don't fragment the
@@ -1306,6 +1354,7 @@ _cpp_cleanup_files (cpp_reader *pfile)
   obstack_free (&pfile->nonexistent_file_ob, 0);
   free_file_hash_entries (pfile);
   destroy_all_cpp_files (pfile);
+  include_cache_free (pfile);
 }
 
 /* Make the parser forget about files it has seen.  This can be useful
@@ -1690,6 +1739,366 @@ remap_filename (cpp_reader *pfile, _cpp_file *file)
     }
 }
 
+/* The include cache.
+
+   With -finclude-cache=FILE, the first time a directory is searched
+   for a header its entries are read and kept in PFILE->include_cache,
+   and the directory is not probed again for headers it does not
+   contain.  With long include paths this saves most of the failed
+   opens and stats done for each #include.
+
+   The listings are also written to FILE at the end of the compilation
+   and read back by the next one, which only has to stat each directory
+   it searches to check that its modification time has not changed
+   since the listing was made.  Listings of other directories are kept,
+   so the same FILE can be shared by the compilations of a project that
+   use different include paths.  The file holds a line with
+   include_cache_magic, then for each directory a line with its
+   modification time, number of entries and name, followed by a line
+   for each entry.  */
+
+/* Hash and compare include_dir_listings, by their directory names.  */
+
+static hashval_t
+include_dir_listing_hash (const void *p)
+{
+  return filename_hash (((const struct include_dir_listing *) p)->name);
+}
+
+static int
+include_dir_listing_eq (const void *p, const void *q)
+{
+  return filename_cmp (((const struct include_dir_listing *) p)->name,
+		       (const char *) q) == 0;
+}
+
+/* Read a line of F onto the obstack OB, and return it without the
+   newline.  Return NULL at the end of the file.  */
+
+static char *
+include_cache_read_line (FILE *f, struct obstack *ob)
+{
+  int ch;
+
+  while ((ch = getc (f)) != EOF && ch != '\n')
+    obstack_1grow (ob, ch);
+  if (ch == EOF)
+    {
+      obstack_free (ob, obstack_finish (ob));
+      return NULL;
+    }
+  obstack_1grow (ob, '\0');
+  return (char *) obstack_finish (ob);
+}
+
+/* Create the include cache of PFILE, and fill it from the cache file,
+   if there is one.  A cache file that cannot be read or is corrupt is
+   silently ignored, and overwritten at the end of the compilation.  */
+
+static void
+include_cache_load (cpp_reader *pfile)
+{
+  FILE *f;
+  char *line;
+
+  pfile->include_cache = htab_create_alloc (127, include_dir_listing_hash,
+					    include_dir_listing_eq,
+					    NULL, xcalloc, free);
+  obstack_specify_allocation (&pfile->include_cache_ob, 0, 0,
+			      xmalloc, free);
+  pfile->include_cache_dirty = false;
+
+  f = fopen (CPP_OPTION (pfile, include_cache), "r");
+  if (f == NULL)
+    return;
+
+  line = include_cache_read_line (f, &pfile->include_cache_ob);
+  if (line != NULL && strcmp (line, include_cache_magic) == 0)
+    while ((line = include_cache_read_line (f, &pfile->include_cache_ob)))
+      {
+	struct include_dir_listing *listing;
+	unsigned long count;
+	long mtime;
+	int pos;
+	size_t i;
+	void **slot;
+
+	if (sscanf (line, "%ld %lu %n", &mtime, &count, &pos) != 2
+	    || line[pos] == '\0')
+	  break;
+
+	listing = XOBNEW (&pfile->include_cache_ob,
+			  struct include_dir_listing);
+	listing->name = line + pos;
+	listing->mtime = (time_t) mtime;
+	listing->count = count;
+	listing->names = XNEWVEC (char *, count);
+	listing->entries = NULL;
+	listing->missing = false;
+	listing->persist = true;
+	for (i = 0; i < count; i++)
+	  if ((listing->names[i]
+	       = include_cache_read_line (f, &pfile->include_cache_ob))
+	      == NULL)
+	    break;
+	if (i < count)
+	  {
+	    free (listing->names);
+	    break;
+	  }
+
+	slot = htab_find_slot_with_hash (pfile->include_cache, listing->name,
+					 filename_hash (listing->name),
+					 INSERT);
+	if (*slot != NULL)
+	  free (((struct include_dir_listing *) *slot)->names);
+	*slot = listing;
+      }
+
+  fclose (f);
+}
+
+/* Read the entries of the directory of LISTING into it, replacing any
+   it has.  Return false if the directory cannot be read.  */
+
+static bool
+include_cache_read_dir (cpp_reader *pfile,
+			struct include_dir_listing *listing)
+{
+  DIR *dir;
+  struct dirent *d;
+  size_t room = 16;
+
+  dir = opendir (listing->name);
+  if (dir == NULL)
+    return false;
+
+  listing->names = XRESIZEVEC (char *, listing->names, room);
+  listing->count = 0;
+  listing->persist = true;
+  while ((d = readdir (dir)) != NULL)
+    {
+      if (strcmp (d->d_name, ".") == 0 || strcmp (d->d_name, "..") == 0)
+	continue;
+      /* The file format cannot represent such names.  */
+      if (strchr (d->d_name, '\n') != NULL)
+	listing->persist = false;
+      if (listing->count == room)
+	{
+	  room *= 2;
+	  listing->names = XRESIZEVEC (char *, listing->names, room);
+	}
+      listing->names[listing->count++]
+	= (char *) obstack_copy0 (&pfile->include_cache_ob, d->d_name,
+					strlen (d->d_name));
+    }
+  closedir (dir);
+
+  return true;
+}
+
+/* Return the listing of the directory DIR, checked against the
+   directory, reading it if the include cache does not have it or it is
+   out of date.  Return NULL if the directory cannot be read.  */
+
+static struct include_dir_listing *
+include_cache_listing (cpp_reader *pfile, const char *dir)
+{
+  struct include_dir_listing *listing;
+  struct stat st;
+  hashval_t hash;
+  void **slot;
+  size_t i;
+
+  if (pfile->include_cache == NULL)
+    include_cache_load (pfile);
+
+  hash = filename_hash (dir);
+  slot = htab_find_slot_with_hash (pfile->include_cache, dir, hash, INSERT);
+  listing = (struct include_dir_listing *) *slot;
+  if (listing != NULL && listing->entries != NULL)
+    return listing;
+  if (listing == NULL)
+    {
+      listing = XOBNEW (&pfile->include_cache_ob,
+			struct include_dir_listing);
+      listing->name
+	= (const char *) obstack_copy0 (&pfile->include_cache_ob, dir,
+					strlen (dir));
+      listing->mtime = 0;
+      listing->names = NULL;
+      listing->count = 0;
+      listing->entries = NULL;
+      listing->missing = false;
+      listing->persist = false;
+      *slot = listing;
+    }
+
+  if (stat (dir, &st) != 0)
+    {
+      if (errno != ENOENT && errno != ENOTDIR)
+	return NULL;
+      /* Nothing can be found in a directory that does not exist.  */
+      listing->missing = true;
+      listing->persist = false;
+      listing->count = 0;
+    }
+  else if (!S_ISDIR (st.st_mode))
+    return NULL;
+  else if (listing->names == NULL || listing->mtime != st.st_mtime)
+    {
+      if (!include_cache_read_dir (pfile, listing))
+	return NULL;
+      listing->mtime = st.st_mtime;
+      /* A file added later in the same second would not change the
+	 modification time; do not trust such a listing in later
+	 compilations.  */
+      if (st.st_mtime >= time (NULL) - 1)
+	listing->persist = false;
+      if (listing->persist)
+	pfile->include_cache_dirty = true;
+    }
+
+  listing->entries = htab_create_alloc (listing->count * 2 + 1,
+					filename_hash, filename_eq,
+					NULL, xcalloc, free);
+  for (i = 0; i < listing->count; i++)
+    {
+      char *name = listing->names[i];
+      *htab_find_slot_with_hash (listing->entries, name,
+				 filename_hash (name), INSERT) = name;
+    }
+
+  return listing;
+}
+
+/* Return false if the include cache shows that there is no file named
+   PATH, nor a PCH file for it.  */
+
+static bool
+include_cache_may_exist (cpp_reader *pfile, const char *path)
+{
+  struct include_dir_listing *listing;
+  const char *base = NULL, *p;
+  char *dir, *gch;
+
+  for (p = path; *p; p++)
+    if (IS_DIR_SEPARATOR (*p))
+      base = p + 1;
+  if (base == NULL || base == path + 1 || *base == '\0')
+    return true;
+
+  dir = (char *) alloca (base - path);
+  memcpy (dir, path, base - path - 1);
+  dir[base - path - 1] = '\0';
+  listing = include_cache_listing (pfile, dir);
+  if (listing == NULL)
+    return true;
+  if (listing->missing)
+    return false;
+
+  if (htab_find_with_hash (listing->entries, base, filename_hash (base)))
+    return true;
+  if (!pfile->cb.valid_pch)
+    return false;
+
+  gch = (char *) alloca (strlen (base) + sizeof (".gch"));
+  strcpy (gch, base);
+  strcat (gch, ".gch");
+  return htab_find_with_hash (listing->entries, gch,
+			      filename_hash (gch)) != NULL;
+}
+
+/* Traverse function for _cpp_save_include_cache.  Write out the
+   listing in *SLOT to the FILE in F.  */
+
+static int
+include_cache_write_listing (void **slot, void *f)
+{
+  struct include_dir_listing *listing
+    = (struct include_dir_listing *) *slot;
+  size_t i;
+
+  if (!listing->persist || listing->missing
+      || strchr (listing->name, '\n') != NULL)
+    return 1;
+
+  fprintf ((FILE *) f, "%ld %lu %s\n", (long) listing->mtime,
+	   (unsigned long) listing->count, listing->name);
+  for (i = 0; i < listing->count; i++)
+    fprintf ((FILE *) f, "%s\n", listing->names[i]);
+  return 1;
+}
+
+/* Write out the include cache, if this compilation has read any
+   directory the cache file did not have an up to date listing for.
+   The file is replaced atomically, so that concurrent compilations
+   always see a complete cache.  Failures are silently ignored: the
+   cache only makes header lookup faster.  */
+
+void
+_cpp_save_include_cache (cpp_reader *pfile)
+{
+  const char *cache_name = CPP_OPTION (pfile, include_cache);
+  char *tmp_name;
+  FILE *f;
+  bool ok;
+
+  if (cache_name == NULL || pfile->include_cache == NULL
+      || !pfile->include_cache_dirty)
+    return;
+
+  tmp_name = XNEWVEC (char, strlen (cache_name) + 32);
+  sprintf (tmp_name, "%s.%ld.tmp", cache_name, (long) getpid ());
+  f = fopen (tmp_name, "w");
+  if (f == NULL)
+    {
+      free (tmp_name);
+      return;
+    }
+
+  fprintf (f, "%s\n", include_cache_magic);
+  htab_traverse_noresize (pfile->include_cache, include_cache_write_listing,
+			  f);
+  ok = !ferror (f);
+  if (fclose (f) != 0)
+    ok = false;
+  if (!ok || rename (tmp_name, cache_name) != 0)
+    unlink (tmp_name);
+  else
+    pfile->include_cache_dirty = false;
+  free (tmp_name);
+}
+
+/* Traverse function for include_cache_free.  */
+
+static int
+include_cache_free_listing (void **slot, void *data ATTRIBUTE_UNUSED)
+{
+  struct include_dir_listing *listing
+    = (struct include_dir_listing *) *slot;
+
+  free (listing->names);
+  if (listing->entries)
+    htab_delete (listing->entries);
+  return 1;
+}
+
+/* Free the include cache of PFILE, if it has been created.  */
+
+static void
+include_cache_free (cpp_reader *pfile)
+{
+  if (pfile->include_cache == NULL)
+    return;
+
+  htab_traverse_noresize (pfile->include_cache, include_cache_free_listing,
+			  NULL);
+  htab_delete (pfile->include_cache);
+  obstack_free (&pfile->include_cache_ob, 0);
+  pfile->include_cache = NULL;
+}
+
 /* Returns true if PCHNAME is a valid PCH file for FILE.  */
 static bool
 validate_pch (cpp_reader *pfile, _cpp_file *file, const char *pchname)
@@ -535,6 +535,11 @@ struct cpp_options
 
   /* True enables canonicalization of system header file paths. */
   bool canonical_system_headers;
+
+  /* If non-NULL, the file holding the listings of the include
+     directories, used to avoid probing directories for headers they
+     do not contain.  */
+  const char *include_cache;
 };
 
 /* Callback for header lookup for HEADER, which is the name of a
@@ -651,11 +651,16 @@ struct GTY(()) maps_info_macro {
 };
 
 /* Data structure to associate a source_range together with an arbitrary
-   data pointer with a source location.  */
+   data pointer with a source location.  To keep the entries small, the
+   range is stored in the same packed form as a source_location when it
+   fits (see get_range_from_loc), and as an index into the WIDE_RANGES
+   array of the location_adhoc_data_map, with the ad-hoc bit set,
+   otherwise.  The data pointer is stored as an index into the
+   deduplicated DATA_PTRS array of the map, 0 standing for NULL.  */
 struct GTY(()) location_adhoc_data {
   source_location locus;
-  source_range src_range;
-  void * GTY((skip)) data;
+  source_location packed_range;
+  unsigned int data_index;
 };
 
 struct htab;
@@ -668,13 +673,28 @@ struct htab;
    highest bit is 1, then the number is adhoc_loc. Otherwise, it serves as
    the original location. Once identified as the adhoc_loc, the lower 31
    bits of the integer is used to index the location_adhoc_data array,
-   in which the locus and associated data is stored.  */
+   in which the locus and associated data is stored.
+
+   The ranges that cannot be packed and the data pointers are kept in
+   separate arrays, shared by all the entries that use them.  The data
+   pointers are not saved in precompiled headers.  */
 
 struct GTY(()) location_adhoc_data_map {
   struct htab * GTY((skip)) htab;
   source_location curr_loc;
   unsigned int allocated;
   struct location_adhoc_data GTY((length ("%h.allocated"))) *data;
+
+  struct htab * GTY((skip)) wide_ranges_htab;
+  unsigned int wide_ranges_used;
+  unsigned int wide_ranges_allocated;
+  /* The start and finish of each wide range, in turn.  */
+  source_location * GTY((atomic)) wide_ranges;
+
+  struct htab * GTY((skip)) data_ptrs_htab;
+  unsigned int data_ptrs_used;
+  unsigned int data_ptrs_allocated;
+  void ** GTY((skip)) data_ptrs;
 };
 
 /* A set of chronological line_map structures.  */
@@ -1592,6 +1612,8 @@ struct linemap_stats
   long duplicated_macro_maps_locations_size;
   long adhoc_table_size;
   long adhoc_table_entries_used;
+  long adhoc_wide_ranges_used;
+  long adhoc_data_ptrs_used;
 };
 
 /* Return the highest location emitted for a given file for which
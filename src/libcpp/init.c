@@ -753,6 +753,10 @@ cpp_finish (cpp_reader *pfile, FILE *deps_stream)
   /* Report on headers that could use multiple include guards.  */
   if (CPP_OPTION (pfile, print_include_names))
     _cpp_report_missing_guards (pfile);
+
+  /* Keep the listings of the include directories for the next
+     compilation.  */
+  _cpp_save_include_cache (pfile);
 }
 
 static void
@@ -453,6 +453,13 @@ struct cpp_reader
   struct htab *nonexistent_file_hash;
   struct obstack nonexistent_file_ob;
 
+  /* Listings of the directories searched for headers, kept across
+     compilations in the file named by the include_cache option.  NULL
+     until the first lookup.  */
+  struct htab *include_cache;
+  struct obstack include_cache_ob;
+  bool include_cache_dirty;
+
   /* Nonzero means don't look for #include "foo" the source-file
      directory.  */
   bool quote_ignores_source_dir;
@@ -653,6 +660,7 @@ extern void _cpp_init_files (cpp_reader *);
 extern void _cpp_cleanup_files (cpp_reader *);
 extern void _cpp_pop_file_buffer (cpp_reader *, struct _cpp_file *,
 				  const unsigned char *);
+extern void _cpp_save_include_cache (cpp_reader *);
 extern bool _cpp_save_file_entries (cpp_reader *pfile, FILE *f);
 extern bool _cpp_read_file_entries (cpp_reader *, FILE *);
 extern const char *_cpp_get_file_name (_cpp_file *);
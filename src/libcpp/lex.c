@@ -487,6 +487,108 @@ search_line_sse42 (const uchar *s, const uchar *end)
 #define search_line_sse42 search_line_sse2
 #endif
 
+#if defined(HAVE_AVX2) && GCC_VERSION >= 4009
+/* A version of the fast scanner using AVX2 vectorized byte compare
+   insns, processing 32 bytes at a time like search_line_sse2 does 16.
+   The aligned loads never cross a page boundary, so we can scan up to
+   the newline that ends the buffer without reading past it.  */
+
+static const uchar *
+#ifndef __AVX2__
+__attribute__((__target__("avx2")))
+#endif
+search_line_avx2 (const uchar *s, const uchar *end ATTRIBUTE_UNUSED)
+{
+  typedef char v32qi __attribute__ ((__vector_size__ (32)));
+
+  unsigned int misalign, found, mask;
+  const v32qi *p;
+  v32qi data, t;
+
+  /* Align the source pointer.  */
+  misalign = (uintptr_t)s & 31;
+  p = (const v32qi *)((uintptr_t)s & -32);
+  data = *p;
+
+  /* Create a mask for the bytes that are valid within the first
+     32-byte block.  */
+  mask = -1u << misalign;
+
+  /* Main loop processing 32 bytes at a time.  */
+  goto start;
+  do
+    {
+      data = *++p;
+      mask = -1;
+
+    start:
+      t = (v32qi) ((data == '\n') | (data == '\r')
+		   | (data == '\\') | (data == '?'));
+      found = __builtin_ia32_pmovmskb256 (t);
+      found &= mask;
+    }
+  while (!found);
+
+  /* FOUND contains 1 in bits for which we matched a relevant
+     character.  Conversion to the byte index is trivial.  */
+  found = __builtin_ctz (found);
+  return (const uchar *)p + found;
+}
+#endif
+
+#if defined(HAVE_AVX512BW) && GCC_VERSION >= 5000
+/* A version of the fast scanner using AVX-512BW byte compare insns,
+   processing 64 bytes at a time.  The compares write straight to mask
+   registers, so no separate movemask is needed.  */
+
+static const uchar *
+#ifndef __AVX512BW__
+__attribute__((__target__("avx512bw")))
+#endif
+search_line_avx512bw (const uchar *s, const uchar *end ATTRIBUTE_UNUSED)
+{
+  typedef char v64qi __attribute__ ((__vector_size__ (64)));
+
+  const v64qi zero = { 0 };
+  const v64qi repl_nl = zero + '\n';
+  const v64qi repl_cr = zero + '\r';
+  const v64qi repl_bs = zero + '\\';
+  const v64qi repl_qm = zero + '?';
+
+  unsigned long long found, mask;
+  unsigned int misalign;
+  const v64qi *p;
+  v64qi data;
+
+  /* Align the source pointer.  */
+  misalign = (uintptr_t)s & 63;
+  p = (const v64qi *)((uintptr_t)s & -64);
+  data = *p;
+
+  /* Create a mask for the bytes that are valid within the first
+     64-byte block.  */
+  mask = -1ull << misalign;
+
+  /* Main loop processing 64 bytes at a time.  */
+  goto start;
+  do
+    {
+      data = *++p;
+      mask = -1ull;
+
+    start:
+      found = (__builtin_ia32_pcmpeqb512_mask (data, repl_nl, mask)
+	       | __builtin_ia32_pcmpeqb512_mask (data, repl_cr, mask)
+	       | __builtin_ia32_pcmpeqb512_mask (data, repl_bs, mask)
+	       | __builtin_ia32_pcmpeqb512_mask (data, repl_qm, mask));
+    }
+  while (!found);
+
+  found = __builtin_ctzll (found);
+  return (const uchar *)p + found;
+}
+#endif
+
 /* Check the CPU capabilities.  */
 
 #include "../gcc/config/i386/cpuid.h"
@@ -528,6 +630,42 @@ init_vectorized_lexer (void)
 	impl = search_line_mmx;
     }
 
+#if (defined(HAVE_AVX2) && GCC_VERSION >= 4009) \
+    || (defined(HAVE_AVX512BW) && GCC_VERSION >= 5000)
+  /* The wider scanners need the OS to save the AVX (and AVX-512)
+     register state, as well as CPU support.  */
+#define XSTATE_SSE			0x2
+#define XSTATE_YMM			0x4
+#define XSTATE_OPMASK			0x20
+#define XSTATE_ZMM			0x40
+#define XSTATE_HI_ZMM			0x80
+  if (impl == search_line_sse42
+      && __get_cpuid (1, &dummy, &dummy, &ecx, &edx)
+      && (ecx & bit_OSXSAVE)
+      && __get_cpuid_max (0, NULL) >= 7)
+    {
+      unsigned ebx, xcr0, xcr0_hi;
+
+      __cpuid_count (7, 0, dummy, ebx, dummy, dummy);
+      asm (".byte 0x0f; .byte 0x01; .byte 0xd0"
+	   : "=a" (xcr0), "=d" (xcr0_hi)
+	   : "c" (0));
+#if defined(HAVE_AVX2) && GCC_VERSION >= 4009
+      if ((ebx & bit_AVX2)
+	  && (xcr0 & (XSTATE_SSE | XSTATE_YMM)) == (XSTATE_SSE | XSTATE_YMM))
+	impl = search_line_avx2;
+#endif
+#if defined(HAVE_AVX512BW) && GCC_VERSION >= 5000
+      if ((ebx & bit_AVX512BW)
+	  && ((xcr0 & (XSTATE_SSE | XSTATE_YMM | XSTATE_OPMASK | XSTATE_ZMM
+		       | XSTATE_HI_ZMM))
+	      == (XSTATE_SSE | XSTATE_YMM | XSTATE_OPMASK | XSTATE_ZMM
+		  | XSTATE_HI_ZMM)))
+	impl = search_line_avx512bw;
+#endif
+    }
+#endif
+
   search_line_fast = impl;
 }
 
@@ -76,10 +76,7 @@ location_adhoc_data_hash (const void *l)
 {
   const struct location_adhoc_data *lb =
       (const struct location_adhoc_data *) l;
-  return ((hashval_t) lb->locus
-	  + (hashval_t) lb->src_range.m_start
-	  + (hashval_t) lb->src_range.m_finish
-	  + (size_t) lb->data);
+  return iterative_hash_object (*lb, 0);
 }
 
 /* Compare function for location_adhoc_data hashtable.  */
@@ -92,9 +89,42 @@ location_adhoc_data_eq (const void *l1, const void *l2)
   const struct location_adhoc_data *lb2 =
       (const struct location_adhoc_data *) l2;
   return (lb1->locus == lb2->locus
-	  && lb1->src_range.m_start == lb2->src_range.m_start
-	  && lb1->src_range.m_finish == lb2->src_range.m_finish
-	  && lb1->data == lb2->data);
+	  && lb1->packed_range == lb2->packed_range
+	  && lb1->data_index == lb2->data_index);
+}
+
+/* Hash function for the hashtable of the wide ranges.  */
+
+static hashval_t
+adhoc_wide_range_hash (const void *r)
+{
+  return iterative_hash (r, 2 * sizeof (source_location), 0);
+}
+
+/* Compare function for the hashtable of the wide ranges.  */
+
+static int
+adhoc_wide_range_eq (const void *r1, const void *r2)
+{
+  const source_location *range1 = (const source_location *) r1;
+  const source_location *range2 = (const source_location *) r2;
+  return range1[0] == range2[0] && range1[1] == range2[1];
+}
+
+/* Hash function for the hashtable of the data pointers.  */
+
+static hashval_t
+adhoc_data_ptr_hash (const void *p)
+{
+  return htab_hash_pointer (*(void *const *) p);
+}
+
+/* Compare function for the hashtable of the data pointers.  */
+
+static int
+adhoc_data_ptr_eq (const void *p1, const void *p2)
+{
+  return *(void *const *) p1 == *(void *const *) p2;
 }
 
 /* Update the hashtable when location_adhoc_data is reallocated.  */
@@ -106,17 +136,55 @@ location_adhoc_data_update (void **slot, void *data)
   return 1;
 }
 
-/* Rebuild the hash table from the location adhoc data.  */
+/* Grow ARRAY, an array of *ALLOCATED elements of SIZE bytes belonging
+   to the ad-hoc data of SET, and update the pointers into it held by
+   HTAB.  Use xrealloc instead of the allocator of SET if HEAP.  Return
+   the new array.  */
+
+static void *
+grow_adhoc_array (struct line_maps *set, void *array,
+		  unsigned int *allocated, size_t size,
+		  struct htab *htab, bool heap)
+{
+  char *orig_data = (char *) array;
+  long long offset;
+  /* Cast away extern "C" from the type of xrealloc.  */
+  line_map_realloc reallocator = (set->reallocator && !heap
+				  ? set->reallocator
+				  : (line_map_realloc) xrealloc);
+
+  if (*allocated == 0)
+    *allocated = 128;
+  else
+    *allocated *= 2;
+  array = reallocator (array, *allocated * size);
+  offset = (char *) array - orig_data;
+  if (orig_data != NULL)
+    htab_traverse (htab, location_adhoc_data_update, &offset);
+  return array;
+}
+
+/* Rebuild the hash table from the location adhoc data.  The data
+   pointers do not survive precompiled headers, start them afresh.  */
 
 void
 rebuild_location_adhoc_htab (struct line_maps *set)
 {
+  struct location_adhoc_data_map *map = &set->location_adhoc_data_map;
   unsigned i;
-  set->location_adhoc_data_map.htab =
+  map->htab =
       htab_create (100, location_adhoc_data_hash, location_adhoc_data_eq, NULL);
-  for (i = 0; i < set->location_adhoc_data_map.curr_loc; i++)
-    htab_find_slot (set->location_adhoc_data_map.htab,
-		    set->location_adhoc_data_map.data + i, INSERT);
+  for (i = 0; i < map->curr_loc; i++)
+    htab_find_slot (map->htab, map->data + i, INSERT);
+  map->wide_ranges_htab =
+      htab_create (100, adhoc_wide_range_hash, adhoc_wide_range_eq, NULL);
+  for (i = 0; i < map->wide_ranges_used; i++)
+    htab_find_slot (map->wide_ranges_htab, map->wide_ranges + 2 * i, INSERT);
+  map->data_ptrs_htab =
+      htab_create (100, adhoc_data_ptr_hash, adhoc_data_ptr_eq, NULL);
+  map->data_ptrs = NULL;
+  map->data_ptrs_used = 0;
+  map->data_ptrs_allocated = 0;
 }
 
 /* Helper function for get_combined_adhoc_loc.
@@ -162,6 +230,95 @@ can_be_stored_compactly_p (struct line_maps *set,
   return true;
 }
 
+/* Return the index of SRC_RANGE in the wide ranges of SET, adding it
+   if it is not there yet.  */
+
+static unsigned int
+intern_adhoc_wide_range (struct line_maps *set, source_range src_range)
+{
+  struct location_adhoc_data_map *map = &set->location_adhoc_data_map;
+  source_location key[2] = { src_range.m_start, src_range.m_finish };
+  source_location **slot;
+
+  slot = (source_location **) htab_find_slot (map->wide_ranges_htab, key,
+					      INSERT);
+  if (*slot == NULL)
+    {
+      if (map->wide_ranges_used >= map->wide_ranges_allocated)
+	map->wide_ranges
+	  = (source_location *) grow_adhoc_array (set, map->wide_ranges,
+						  &map->wide_ranges_allocated,
+						  sizeof (key),
+						  map->wide_ranges_htab,
+						  false);
+      *slot = map->wide_ranges + 2 * map->wide_ranges_used++;
+      (*slot)[0] = key[0];
+      (*slot)[1] = key[1];
+    }
+  return (*slot - map->wide_ranges) / 2;
+}
+
+/* Return the index of DATA in the data pointers of SET plus one, adding
+   it if it is not there yet, or 0 if DATA is NULL.  */
+
+static unsigned int
+intern_adhoc_data_ptr (struct line_maps *set, void *data)
+{
+  struct location_adhoc_data_map *map = &set->location_adhoc_data_map;
+  void ***slot;
+
+  if (data == NULL)
+    return 0;
+
+  slot = (void ***) htab_find_slot (map->data_ptrs_htab, &data, INSERT);
+  if (*slot == NULL)
+    {
+      /* The data pointers are not walked by the garbage collector, keep
+	 them out of its memory.  */
+      if (map->data_ptrs_used >= map->data_ptrs_allocated)
+	map->data_ptrs
+	  = (void **) grow_adhoc_array (set, map->data_ptrs,
+					&map->data_ptrs_allocated,
+					sizeof (void *),
+					map->data_ptrs_htab, true);
+      map->data_ptrs[map->data_ptrs_used] = data;
+      *slot = map->data_ptrs + map->data_ptrs_used++;
+    }
+  return *slot - map->data_ptrs + 1;
+}
+
+/* Return SRC_RANGE encoded for an ad-hoc entry of SET: in the packed
+   form of an ordinary location when that represents it exactly, as the
+   index of a wide range with the ad-hoc bit set otherwise.  */
+
+static source_location
+pack_adhoc_range (struct line_maps *set, source_range src_range)
+{
+  source_location start = src_range.m_start;
+
+  if (can_be_stored_compactly_p (set, start, src_range, NULL))
+    {
+      if (pure_location_p (set, start))
+	{
+	  const line_map *map = linemap_lookup (set, start);
+	  const line_map_ordinary *ordmap = linemap_check_ordinary (map);
+	  unsigned int int_diff = src_range.m_finish - start;
+	  unsigned int col_diff = (int_diff >> ordmap->m_range_bits);
+	  if (col_diff < (1U << ordmap->m_range_bits)
+	      && (col_diff << ordmap->m_range_bits) == int_diff)
+	    return start | col_diff;
+	}
+    }
+  else if (start == src_range.m_finish
+	   && !IS_ADHOC_LOC (start)
+	   && (start < RESERVED_LOCATION_COUNT
+	       || start >= LINEMAPS_MACRO_LOWEST_LOCATION (set)
+	       || pure_location_p (set, start)))
+    return start;
+
+  return intern_adhoc_wide_range (set, src_range) | 0x80000000;
+}
+
 /* Combine LOCUS and DATA to a combined adhoc loc.  */
 
 source_location
@@ -214,35 +371,19 @@ get_combined_adhoc_loc (struct line_maps *set,
     set->num_unoptimized_ranges++;
 
   lb.locus = locus;
-  lb.src_range = src_range;
-  lb.data = data;
+  lb.packed_range = pack_adhoc_range (set, src_range);
+  lb.data_index = intern_adhoc_data_ptr (set, data);
   slot = (struct location_adhoc_data **)
       htab_find_slot (set->location_adhoc_data_map.htab, &lb, INSERT);
   if (*slot == NULL)
     {
       if (set->location_adhoc_data_map.curr_loc >=
 	  set->location_adhoc_data_map.allocated)
-	{
-	  char *orig_data = (char *) set->location_adhoc_data_map.data;
-	  long long offset;
-	  /* Cast away extern "C" from the type of xrealloc.  */
-	  line_map_realloc reallocator = (set->reallocator
-					  ? set->reallocator
-					  : (line_map_realloc) xrealloc);
-
-	  if (set->location_adhoc_data_map.allocated == 0)
-	    set->location_adhoc_data_map.allocated = 128;
-	  else
-	    set->location_adhoc_data_map.allocated *= 2;
-	  set->location_adhoc_data_map.data = (struct location_adhoc_data *)
-	      reallocator (set->location_adhoc_data_map.data,
-			   set->location_adhoc_data_map.allocated
-			   * sizeof (struct location_adhoc_data));
-	  offset = (char *) (set->location_adhoc_data_map.data) - orig_data;
-	  if (set->location_adhoc_data_map.allocated > 128)
-	    htab_traverse (set->location_adhoc_data_map.htab,
-			   location_adhoc_data_update, &offset);
-	}
+	set->location_adhoc_data_map.data = (struct location_adhoc_data *)
+	  grow_adhoc_array (set, set->location_adhoc_data_map.data,
+			    &set->location_adhoc_data_map.allocated,
+			    sizeof (struct location_adhoc_data),
+			    set->location_adhoc_data_map.htab, false);
       *slot = set->location_adhoc_data_map.data
 	      + set->location_adhoc_data_map.curr_loc;
       set->location_adhoc_data_map.data[set->location_adhoc_data_map.curr_loc++]
@@ -256,8 +397,15 @@ get_combined_adhoc_loc (struct line_maps *set,
 void *
 get_data_from_adhoc_loc (struct line_maps *set, source_location loc)
 {
+  struct location_adhoc_data_map *map = &set->location_adhoc_data_map;
+  unsigned int index;
+
   linemap_assert (IS_ADHOC_LOC (loc));
-  return set->location_adhoc_data_map.data[loc & MAX_SOURCE_LOCATION].data;
+  index = map->data[loc & MAX_SOURCE_LOCATION].data_index;
+  if (index == 0)
+    return NULL;
+  linemap_assert (index <= map->data_ptrs_used);
+  return map->data_ptrs[index - 1];
 }
 
 /* Return the location for the adhoc loc.  */
@@ -274,8 +422,21 @@ get_location_from_adhoc_loc (struct line_maps *set, source_location loc)
 static source_range
 get_range_from_adhoc_loc (struct line_maps *set, source_location loc)
 {
+  struct location_adhoc_data_map *map = &set->location_adhoc_data_map;
+  source_location packed_range;
+
   linemap_assert (IS_ADHOC_LOC (loc));
-  return set->location_adhoc_data_map.data[loc & MAX_SOURCE_LOCATION].src_range;
+  packed_range = map->data[loc & MAX_SOURCE_LOCATION].packed_range;
+  if (IS_ADHOC_LOC (packed_range))
+    {
+      source_location *range
+	= map->wide_ranges + 2 * (packed_range & MAX_SOURCE_LOCATION);
+      source_range result;
+      result.m_start = range[0];
+      result.m_finish = range[1];
+      return result;
+    }
+  return get_range_from_loc (set, packed_range);
 }
 
 /* Get the source_range of location LOC, either from the ad-hoc
@@ -328,6 +489,10 @@ void
 location_adhoc_data_fini (struct line_maps *set)
 {
   htab_delete (set->location_adhoc_data_map.htab);
+  htab_delete (set->location_adhoc_data_map.wide_ranges_htab);
+  htab_delete (set->location_adhoc_data_map.data_ptrs_htab);
+  free (set->location_adhoc_data_map.data_ptrs);
+  set->location_adhoc_data_map.data_ptrs = NULL;
 }
 
 /* Initialize a line map set.  */
@@ -341,6 +506,10 @@ linemap_init (struct line_maps *set,
   set->highest_line = RESERVED_LOCATION_COUNT - 1;
   set->location_adhoc_data_map.htab =
       htab_create (100, location_adhoc_data_hash, location_adhoc_data_eq, NULL);
+  set->location_adhoc_data_map.wide_ranges_htab =
+      htab_create (100, adhoc_wide_range_hash, adhoc_wide_range_eq, NULL);
+  set->location_adhoc_data_map.data_ptrs_htab =
+      htab_create (100, adhoc_data_ptr_hash, adhoc_data_ptr_eq, NULL);
   set->builtin_location = builtin_location;
 }
 
@@ -1667,8 +1836,7 @@ linemap_expand_location (struct line_maps *set,
   memset (&xloc, 0, sizeof (xloc));
   if (IS_ADHOC_LOC (loc))
     {
-      xloc.data
-	= set->location_adhoc_data_map.data[loc & MAX_SOURCE_LOCATION].data;
+      xloc.data = get_data_from_adhoc_loc (set, loc);
       loc = set->location_adhoc_data_map.data[loc & MAX_SOURCE_LOCATION].locus;
     }
 
@@ -1902,8 +2070,14 @@ linemap_get_statistics (struct line_maps *set,
   s->duplicated_macro_maps_locations_size =
     duplicated_macro_maps_locations_size;
   s->adhoc_table_size = (set->location_adhoc_data_map.allocated
-			 * sizeof (struct location_adhoc_data));
+			 * sizeof (struct location_adhoc_data)
+			 + set->location_adhoc_data_map.wide_ranges_allocated
+			 * 2 * sizeof (source_location)
+			 + set->location_adhoc_data_map.data_ptrs_allocated
+			 * sizeof (void *));
   s->adhoc_table_entries_used = set->location_adhoc_data_map.curr_loc;
+  s->adhoc_wide_ranges_used = set->location_adhoc_data_map.wide_ranges_used;
+  s->adhoc_data_ptrs_used = set->location_adhoc_data_map.data_ptrs_used;
 }
 
 